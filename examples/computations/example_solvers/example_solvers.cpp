@@ -0,0 +1,102 @@
+#include <iostream>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+
+#include <armlearn/basiccartesianconverter.h>
+#include <armlearn/analyticcartesianconverter.h>
+#include <armlearn/nowaitarmsimulator.h>
+#include <armlearn/widowxbuilder.h>
+
+
+int main(int argc, char *argv[]) {
+
+    /******************************************/
+    /****    Inverse kinematics solvers    ****/
+    /******************************************/
+
+    /*
+     * Compares the inverse kinematics solvers on the WidowX arm. Targets are computed from random positions within the servomotor limits, 
+     * each solver starts from the middle position of the arm and must reach the target within the given distance with valid positions.
+     * 
+     * Shape of the array:
+     * solver   |   success rate    |   valid rate  |   mean latency
+     * 
+     *  - success rate : percentage of computations returning a solution
+     *  - valid rate : percentage of computations returning positions within the servomotor limits and reaching the target
+     *  - mean latency : mean duration of a computation, in microseconds
+     * 
+     * The Newton-Raphson solver matches the full frame of the target, which rarely has the orientation kept by the servomotors, and ignores their limits.
+     * The Levenberg-Marquardt solver only matches the position and keeps the servomotors within their limits.
+     * The analytic solver is given as a reference for this geometry.
+     */
+
+    // Number of targets
+    int nbTargets = 1000;
+
+    // Distance under which a target is considered as reached
+    double reachDistance = 1;
+
+
+    armlearn::WidowXBuilder builder;
+    armlearn::communication::NoWaitArmSimulator sim(armlearn::communication::none);
+    builder.buildController(sim);
+
+    armlearn::kinematics::BasicCartesianConverter newtonRaphson;
+    armlearn::kinematics::BasicCartesianConverter levenbergMarquardt;
+    armlearn::kinematics::AnalyticCartesianConverter analytic;
+    armlearn::kinematics::BasicCartesianConverter reference; // Checks the results
+
+    std::vector<armlearn::kinematics::Converter*> converters = {&newtonRaphson, &levenbergMarquardt, &analytic, &reference};
+    for(auto conv : converters){
+        builder.buildConverter(*conv);
+        conv->setServoLimits(sim);
+    }
+    levenbergMarquardt.setSolver(armlearn::kinematics::levenbergMarquardtSolver);
+
+    std::vector<std::string> names = {"Newton-Raphson", "Levenberg-Marquardt", "Analytic"};
+    std::vector<int> nbSuccess(3, 0);
+    std::vector<int> nbValid(3, 0);
+    std::vector<double> durations(3, 0);
+
+
+    // Targets reached by random valid positions, wrist rotate and gripper do not move the end of the arm
+    std::mt19937 generator(42);
+    std::vector<std::uniform_int_distribution<int>> distributions = {
+        std::uniform_int_distribution<int>(BASE_MIN + 1, BASE_MAX - 1),
+        std::uniform_int_distribution<int>(SHOULDER_MIN + 1, SHOULDER_MAX - 1),
+        std::uniform_int_distribution<int>(ELBOW_MIN + 1, ELBOW_MAX - 1),
+        std::uniform_int_distribution<int>(WRISTANGLE_MIN + 1, WRISTANGLE_MAX - 1)
+    };
+
+    std::vector<double> target;
+    std::vector<double> reached;
+    for(int t = 0; t < nbTargets; t++){
+        std::vector<uint16_t> targetPositions = {2048, 2048, 2048, 2048, 512, 256};
+        for(int s = 0; s < distributions.size(); s++) targetPositions[s] = distributions[s](generator);
+        reference.tryServoToCoord(targetPositions, target);
+
+        for(int c = 0; c < 3; c++){
+            std::vector<uint16_t> positions = {2048, 2048, 2048, 2048, 512, 256};
+
+            std::chrono::time_point<std::chrono::steady_clock> startTime = std::chrono::steady_clock::now();
+            armlearn::kinematics::ComputationStatus status = converters[c]->tryCoordToServo(target, positions);
+            durations[c] += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - startTime).count();
+
+            if(status != armlearn::kinematics::computationSucceeded) continue;
+            nbSuccess[c]++;
+
+            reference.tryServoToCoord(positions, reached);
+            double distance = std::sqrt(std::pow(reached[0] - target[0], 2) + std::pow(reached[1] - target[1], 2) + std::pow(reached[2] - target[2], 2));
+            if(sim.validPosition(positions) && distance < reachDistance) nbValid[c]++;
+        }
+    }
+
+
+    std::cout << "Solver\t\t\tSuccess rate\tValid rate\tMean latency (us)" << std::endl;
+    for(int c = 0; c < 3; c++){
+        std::cout << names[c] << (names[c].size() < 16 ? "\t\t" : "\t") << 100.0 * nbSuccess[c] / nbTargets << " %\t\t" << 100.0 * nbValid[c] / nbTargets << " %\t\t" << durations[c] / nbTargets << std::endl;
+    }
+}
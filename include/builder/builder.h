@@ -15,6 +15,7 @@
 
 #include "abstractcontroller.h"
 #include "converter.h"
+#include "collisionchecker.h"
 #include "learner.h"
 
 namespace armlearn {
@@ -47,6 +48,15 @@ class Builder{
          */
         virtual void buildConverter(kinematics::Converter& converter) = 0;
 
+        /**
+         * @brief Adds to a collision checker all the parts of the specific device linked to the builder, with the size of their envelope
+         * 
+         * @param checker the collision checker to build
+         * 
+         * Abstract method, implemented in inherited classes 
+         */
+        virtual void buildCollisionChecker(kinematics::CollisionChecker& checker) = 0;
+
 };
 
 }
@@ -14,9 +14,34 @@
 #define WIDOWXBUILDER_H
 
 #include "builder.h"
+#include "staticchain.h"
 
 namespace armlearn {
 
+    namespace kinematics {
+
+STATIC_SEGMENT(WidowXBase, "base", armlearn::kinematics::rotZ, 0, 0, 125, 0, 0, M_PI);
+STATIC_SEGMENT(WidowXShoulder, "shoulder", armlearn::kinematics::rotX, 0, -49, 142, M_PI/2, 0, M_PI); // Add 90° because of the orientation of the elbow servomotor
+STATIC_SEGMENT(WidowXElbow, "elbow", armlearn::kinematics::rotX, 0, 0, 142, 0, 0, 0);
+STATIC_SEGMENT(WidowXWristAngle, "wristAngle", armlearn::kinematics::rotX, 0, 0, 74, 0, 0, 0);
+STATIC_SEGMENT(WidowXWristRotate, "wristRotate", armlearn::kinematics::rotZ, 0, 0, 41, 0, 0, 0);
+STATIC_SEGMENT(WidowXGripper, "gripper", armlearn::kinematics::rotZ, 0, 0, 40, 0, 0, 0);
+
+/**
+ * @brief Geometry of the WidowX arm known at compile time, the one added by WidowXBuilder::buildConverter()
+ * 
+ */
+typedef StaticChain<WidowXBase, WidowXShoulder, WidowXElbow, WidowXWristAngle, WidowXWristRotate, WidowXGripper> WidowXChain;
+
+/**
+ * @brief Cartesian converter of the WidowX arm with its unrolled forward kinematics, limits of the servomotors being set with setServoLimits()
+ * 
+ */
+typedef StaticCartesianConverter<WidowXChain> WidowXConverter;
+
+    }
+
+
 /**
  * @class WidowXBuilder
  * @brief Class for building the main classes of the library (Controller, Converter, ...) for he the WidowX arm device
@@ -46,12 +71,19 @@ class WidowXBuilder : public Builder{
         virtual void buildController(communication::AbstractController& controller) override;
 
         /**
-         * @brief Adds to a converter all the elements relative to the WidowX arm device
+         * @brief Adds to a converter all the elements relative to the WidowX arm device (see kinematics::WidowXChain)
          * 
          * @param converter the converter to build
          */
         virtual void buildConverter(kinematics::Converter& converter) override;
 
+        /**
+         * @brief Adds to a collision checker all the parts of the WidowX arm device (see kinematics::WidowXChain), with the size of their envelope
+         * 
+         * @param checker the collision checker to build
+         */
+        virtual void buildCollisionChecker(kinematics::CollisionChecker& checker) override;
+
 };
 
 }
@@ -134,7 +134,7 @@ class AbstractController{
          * @return true if it was correctly added
          * @return false otherwise, if the id was already present
          */
-        bool addMotor(uint8_t id, const std::string& name, Type type);
+        virtual bool addMotor(uint8_t id, const std::string& name, Type type);
 
         /**
          * @brief Removes a servomotor fro mthe controller's list
@@ -143,7 +143,14 @@ class AbstractController{
          * @return true if it was correctly removed
          * @return false otherwise, if it was not in the list
          */
-        bool removeMotor(uint8_t id);
+        virtual bool removeMotor(uint8_t id);
+
+        /**
+         * @brief Gets the ids of all servomotors of the controller's list, in increasing order
+         * 
+         * @return std::vector<uint8_t> the ids
+         */
+        std::vector<uint8_t> getMotorIds() const;
 
         /**
          * @brief Change the id of a servomotor
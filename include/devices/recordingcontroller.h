@@ -0,0 +1,260 @@
+/**
+ * @file recordingcontroller.h
+ * @author Gaël Gendron (gael.gendron@insa-rennes.fr)
+ * @brief File containing the RecordingController class, inherited from AbstractController, used to record the session of another controller
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+
+#ifndef RECORDINGCONTROLLER_H
+#define RECORDINGCONTROLLER_H
+
+#include <vector>
+#include <map>
+#include <iostream>
+#include <functional>
+
+#include "abstractcontroller.h"
+#include "sessionlog.h"
+
+namespace armlearn {
+    namespace communication{
+
+
+/**
+ * @class RecordingController
+ * @brief Wraps any controller, forwards it every command and appends the commands, their results and the state updates to a session log
+ *
+ * The servomotors of the recording controller mirror the ones of the wrapped controller after each command.
+ * Exceptions thrown by the wrapped controller are recorded then thrown again.
+ * The log can be served back by a ReplayController.
+ *
+ */
+class RecordingController : public AbstractController{
+
+    protected:
+        AbstractController* device;
+        SessionLogWriter log;
+
+
+        /**
+         * @brief Calls a command of the wrapped controller and records it with its outcome
+         *
+         * @param type the type of the command
+         * @param id the id of the servomotor concerned
+         * @param value the argument of the command
+         * @param command the call to the wrapped controller
+         * @param text the text to record with the command
+         * @return true if the command returned true
+         * @return false otherwise
+         */
+        bool record(RecordType type, uint8_t id, int32_t value, const std::function<bool()>& command, const std::string& text = "");
+
+        /**
+         * @brief Writes a record to the log
+         *
+         */
+        void write(RecordType type, uint8_t id, int32_t value, RecordOutcome outcome = returnedTrue, const std::string& text = "");
+
+        /**
+         * @brief Copies the state of a servomotor of the wrapped controller in the mirroring servomotor, records a status update if its status changed
+         *
+         * @param id the id of the servomotor
+         */
+        void synchronize(uint8_t id);
+
+        /**
+         * @brief Synchronizes all servomotors (see synchronize(uint8_t id))
+         *
+         */
+        void synchronize();
+
+
+    public:
+
+        /**
+         * @brief Construct a new RecordingController object, the servomotors already present in the wrapped controller are declared in the log
+         *
+         * @param controller the controller to record, not owned by the recording controller
+         * @param fileName the name of the log file
+         * @param displayMode mode of display (see DisplayMode enum for more details)
+         * @param out the output stream to display the results, standard std output by default
+         * @throw FileError if the log file cannot be opened
+         */
+        RecordingController(AbstractController* controller, const std::string& fileName, DisplayMode displayMode = except, std::ostream& out = std::cout);
+
+        /**
+         * @brief Destroys the RecordingController object, flushes the log
+         *
+         */
+        ~RecordingController();
+
+
+        /**
+         * @brief Connects the wrapped controller to the devices
+         *
+         * Inherited method from AbstractController
+         */
+        virtual void connect() override;
+
+        /**
+         * @brief Sends a ping to a device through the wrapped controller
+         *
+         * @param id the id of the device to send the ping to
+         *
+         * Inherited method from AbstractController
+         */
+        virtual void ping(uint8_t id) override;
+
+
+        /**
+         * @brief Adds a servomotor to the wrapped controller and to the mirror list
+         *
+         * @param id the id of the servo
+         * @param name the name of the servo
+         * @param type the type of the servo
+         * @return true if it was correctly added
+         * @return false otherwise
+         *
+         * Inherited method from AbstractController
+         */
+        virtual bool addMotor(uint8_t id, const std::string& name, Type type) override;
+
+        /**
+         * @brief Removes a servomotor from the wrapped controller and from the mirror list
+         *
+         * @param id the id of the servo
+         * @return true if it was correctly removed
+         * @return false otherwise
+         *
+         * Inherited method from AbstractController
+         */
+        virtual bool removeMotor(uint8_t id) override;
+
+        /**
+         * @brief Changes the id of a servomotor
+         *
+         * @param oldId the current id of the servomotor to change
+         * @param newId the new id of the servomotor
+         * @return true if the change succeeded
+         * @return false otherwise
+         *
+         * Inherited method from AbstractController
+         */
+        virtual bool changeId(uint8_t oldId, uint8_t newId) override;
+
+        /**
+         * @brief Turns the LED of the servomotor ON / OFF
+         *
+         * @param id the id of the servomotor the LED must be changed
+         * @param on if true, will turn LED on, if false will turn off
+         * @return true if successfully changed
+         * @return false otherwise
+         *
+         * Inherited method from AbstractController
+         */
+        virtual bool turnLED(uint8_t id, bool on) override;
+
+        /**
+         * @brief Turns the LED of the servomotor ON if it is currently OFF and OFF if it is currently ON
+         *
+         * @param id the id of the servomotor the LED must be changed
+         * @return true if successfully changed
+         * @return false otherwise
+         *
+         * Inherited method from AbstractController
+         */
+        virtual bool turnLED(uint8_t id) override;
+
+
+        /**
+         * @brief Changes speed of the specified servomotor
+         *
+         * @param id the id of the servomotor whose speed has to change
+         * @param newSpeed the value of the new speed
+         * @return true if successfully changed
+         * @return false otherwise
+         *
+         * Inherited method from AbstractController
+         */
+        using AbstractController::changeSpeed;
+        virtual bool changeSpeed(uint8_t id, uint16_t newSpeed) override;
+
+        /**
+         * @brief Sets the position of the servomotor
+         *
+         * @param id the id of the servomotor whose position has to be changed
+         * @param newPosition the new position of the servo
+         * @return true if successfully changed
+         * @return false otherwise
+         *
+         * Inherited method from AbstractController
+         */
+        using AbstractController::setPosition;
+        virtual bool setPosition(uint8_t id, uint16_t newPosition) override;
+
+        /**
+         * @brief Adds to the current target position
+         *
+         * @param id the id of the servomotor whose position has to be changed
+         * @param dx the number to add to the current goal position
+         * @return true if successfully changed
+         * @return false otherwise
+         *
+         * Inherited method from AbstractController
+         */
+        using AbstractController::addPosition;
+        virtual bool addPosition(uint8_t id, int dx) override;
+
+
+        /**
+         * @brief Enables or disables a servomotor's ability to move or hold a position (torque)
+         *
+         * @param enable if true, enables the torque, otherwise, disables it
+         * @return true if successfully changed
+         * @return false otherwise
+         *
+         * Inherited method from AbstractController
+         */
+        virtual bool enableTorque(int id, bool enable = true) override;
+
+        /**
+         * @brief Checks if torque is enabled for the given servomotor (see enableTorque() method)
+         *
+         * @param id the id of the torque to check
+         * @return true if enabled
+         * @return false otherwise
+         *
+         * Inherited method from AbstractController
+         */
+        virtual bool torqueEnabled(int id) override;
+
+
+        /**
+         * @brief Asks information from the wrapped controller, records and mirrors them
+         *
+         * @param id the id of the servomotor to update
+         * @return true if information has successfully been updated
+         * @return false otherwise
+         *
+         * Inherited method from AbstractController
+         */
+        using AbstractController::updateInfos;
+        virtual bool updateInfos(uint8_t id) override;
+
+
+        /**
+         * @brief Writes the records buffered so far to the log file
+         *
+         */
+        void flush();
+
+};
+
+    }
+}
+
+#endif
@@ -0,0 +1,283 @@
+/**
+ * @file replaycontroller.h
+ * @author Gaël Gendron (gael.gendron@insa-rennes.fr)
+ * @brief File containing the ReplayController class, inherited from AbstractController, used to serve back a recorded session
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+
+#ifndef REPLAYCONTROLLER_H
+#define REPLAYCONTROLLER_H
+
+#include <vector>
+#include <map>
+#include <iostream>
+#include <chrono>
+
+#include "abstractcontroller.h"
+#include "sessionlog.h"
+
+namespace armlearn {
+    namespace communication{
+
+
+/**
+ * @class ReplayController
+ * @brief Provides an interface serving back the session log written by a RecordingController, without any device
+ *
+ * Each command must match the next command of the log: its recorded result is returned or its recorded exception is thrown, and the state updates following it are applied to the servomotors.
+ * A command differing from the log is handled according to the display mode, a ConnectionError being thrown in except mode.
+ *
+ */
+class ReplayController : public AbstractController{
+
+    protected:
+        SessionLogReader log;
+        SessionRecord nextRecord;
+        bool recordsLeft;
+
+        bool realTime;
+        std::chrono::time_point<std::chrono::steady_clock> startTime;
+
+
+        /**
+         * @brief Reads the next record of the log
+         *
+         */
+        void advance();
+
+        /**
+         * @brief Checks that the next record of the log is the given command and consumes it
+         *
+         * @param type the type of the command
+         * @param id the id of the servomotor concerned
+         * @param value the argument of the command
+         * @param outcome output result of the command
+         * @param text output text recorded with the command
+         * @return true if the command matched the log
+         * @return false otherwise
+         * @throw ConnectionError if the command does not match the log in except mode
+         */
+        bool expect(RecordType type, uint8_t id, int32_t value, RecordOutcome& outcome, std::string& text);
+
+        /**
+         * @brief Applies to the servomotors the status and state updates following the last command
+         *
+         */
+        void applyUpdates();
+
+        /**
+         * @brief Throws the exception recorded for the last command, if any
+         *
+         * @param outcome the outcome of the command
+         * @param text the message of the exception
+         */
+        void rethrow(RecordOutcome outcome, const std::string& text) const;
+
+        /**
+         * @brief Replays a command which does not change the servomotors
+         *
+         * @return true if the recorded command returned true
+         * @return false otherwise
+         */
+        bool replay(RecordType type, uint8_t id, int32_t value);
+
+        /**
+         * @brief Gets a pointer to the wanted servomotor, without any display
+         *
+         * @param id the ID of the servomotor to look for
+         * @return Servomotor* pointer to the servomotor, nullptr if not found
+         */
+        Servomotor* findMotor(uint8_t id) const;
+
+
+    public:
+
+        /**
+         * @brief Construct a new ReplayController object, the servomotors declared at the beginning of the log are added
+         *
+         * @param fileName the name of the log file
+         * @param replayInRealTime if true, each command waits for the time elapsed when it was recorded, otherwise commands are served as fast as possible
+         * @param displayMode mode of display (see DisplayMode enum for more details)
+         * @param out the output stream to display the results, standard std output by default
+         * @throw FileError if the log file cannot be opened or read
+         */
+        ReplayController(const std::string& fileName, bool replayInRealTime = false, DisplayMode displayMode = except, std::ostream& out = std::cout);
+
+        /**
+         * @brief Destroys the ReplayController object
+         *
+         */
+        ~ReplayController();
+
+
+        /**
+         * @brief Checks if the whole log has been replayed
+         *
+         * @return true if no record is left
+         * @return false otherwise
+         */
+        bool finished() const;
+
+
+        /**
+         * @brief Replays the connection to the devices
+         *
+         * Inherited method from AbstractController
+         */
+        virtual void connect() override;
+
+        /**
+         * @brief Replays a ping
+         *
+         * @param id the id of the device to send the ping to
+         *
+         * Inherited method from AbstractController
+         */
+        virtual void ping(uint8_t id) override;
+
+
+        /**
+         * @brief Replays the addition of a servomotor
+         *
+         * @param id the id of the servo
+         * @param name the name of the servo
+         * @param type the type of the servo
+         * @return true if it was correctly added
+         * @return false otherwise
+         *
+         * Inherited method from AbstractController
+         */
+        virtual bool addMotor(uint8_t id, const std::string& name, Type type) override;
+
+        /**
+         * @brief Replays the removal of a servomotor
+         *
+         * @param id the id of the servo
+         * @return true if it was correctly removed
+         * @return false otherwise
+         *
+         * Inherited method from AbstractController
+         */
+        virtual bool removeMotor(uint8_t id) override;
+
+        /**
+         * @brief Replays the change of id of a servomotor
+         *
+         * @param oldId the current id of the servomotor to change
+         * @param newId the new id of the servomotor
+         * @return true if the change succeeded
+         * @return false otherwise
+         *
+         * Inherited method from AbstractController
+         */
+        virtual bool changeId(uint8_t oldId, uint8_t newId) override;
+
+        /**
+         * @brief Replays turning the LED of the servomotor ON / OFF
+         *
+         * @param id the id of the servomotor the LED must be changed
+         * @param on if true, will turn LED on, if false will turn off
+         * @return true if successfully changed
+         * @return false otherwise
+         *
+         * Inherited method from AbstractController
+         */
+        virtual bool turnLED(uint8_t id, bool on) override;
+
+        /**
+         * @brief Replays toggling the LED of the servomotor
+         *
+         * @param id the id of the servomotor the LED must be changed
+         * @return true if successfully changed
+         * @return false otherwise
+         *
+         * Inherited method from AbstractController
+         */
+        virtual bool turnLED(uint8_t id) override;
+
+
+        /**
+         * @brief Replays a change of speed of the specified servomotor
+         *
+         * @param id the id of the servomotor whose speed has to change
+         * @param newSpeed the value of the new speed
+         * @return true if successfully changed
+         * @return false otherwise
+         *
+         * Inherited method from AbstractController
+         */
+        using AbstractController::changeSpeed;
+        virtual bool changeSpeed(uint8_t id, uint16_t newSpeed) override;
+
+        /**
+         * @brief Replays a change of position of the servomotor
+         *
+         * @param id the id of the servomotor whose position has to be changed
+         * @param newPosition the new position of the servo
+         * @return true if successfully changed
+         * @return false otherwise
+         *
+         * Inherited method from AbstractController
+         */
+        using AbstractController::setPosition;
+        virtual bool setPosition(uint8_t id, uint16_t newPosition) override;
+
+        /**
+         * @brief Replays an addition to the current target position
+         *
+         * @param id the id of the servomotor whose position has to be changed
+         * @param dx the number to add to the current goal position
+         * @return true if successfully changed
+         * @return false otherwise
+         *
+         * Inherited method from AbstractController
+         */
+        using AbstractController::addPosition;
+        virtual bool addPosition(uint8_t id, int dx) override;
+
+
+        /**
+         * @brief Replays the activation or deactivation of the torque
+         *
+         * @param enable if true, enables the torque, otherwise, disables it
+         * @return true if successfully changed
+         * @return false otherwise
+         *
+         * Inherited method from AbstractController
+         */
+        virtual bool enableTorque(int id, bool enable = true) override;
+
+        /**
+         * @brief Replays the check of the torque (see enableTorque() method)
+         *
+         * @param id the id of the torque to check
+         * @return true if enabled
+         * @return false otherwise
+         *
+         * Inherited method from AbstractController
+         */
+        virtual bool torqueEnabled(int id) override;
+
+
+        /**
+         * @brief Replays an update of the servomotor with the informations recorded
+         *
+         * @param id the id of the servomotor to update
+         * @return true if information has successfully been updated
+         * @return false otherwise
+         *
+         * Inherited method from AbstractController
+         */
+        using AbstractController::updateInfos;
+        virtual bool updateInfos(uint8_t id) override;
+
+};
+
+    }
+}
+
+#endif
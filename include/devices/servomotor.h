@@ -201,6 +201,20 @@ class Servomotor{
          */
         uint16_t getTargetPosition() const;
 
+        /**
+         * @brief Returns the lower bound of the positions of the servomotor, depending on its type
+         * 
+         * @return uint16_t the min position, excluded (see validPosition())
+         */
+        uint16_t getMinPosition() const;
+
+        /**
+         * @brief Returns the upper bound of the positions of the servomotor, depending on its type
+         * 
+         * @return uint16_t the max position, excluded (see validPosition())
+         */
+        uint16_t getMaxPosition() const;
+
 
         /**
          * @brief Get the Current real position
@@ -216,6 +230,13 @@ class Servomotor{
          */
         double getTimeSinceUpdate() const; // TODO: add a parameter to change unit used
 
+        /**
+         * @brief Gets read-only informations of the servomotor, in the same format as the one used by setInfos()
+         * 
+         * @return std::vector<uint8_t> the READ_LENGTH bytes of informations
+         */
+        std::vector<uint8_t> getInfos() const;
+
 
         /**
          * @brief Returns a string containing informations about the servomotor (id, name, status, position, ...)
@@ -0,0 +1,205 @@
+/**
+ * @file sessionlog.h
+ * @author Gaël Gendron (gael.gendron@insa-rennes.fr)
+ * @brief File containing the classes reading and writing the binary logs of controller sessions
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+
+#ifndef SESSIONLOG_H
+#define SESSIONLOG_H
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+
+#include "servomotor.h"
+#include "fileerror.h"
+
+namespace armlearn {
+    namespace communication{
+
+
+// Characters written at the beginning of a session log file
+#define SESSION_LOG_MAGIC "ARMLOG"
+// Version of the session log format
+#define SESSION_LOG_VERSION 1
+
+
+/**
+ * @brief Type of a record of a session log
+ *
+ *  - motorDeclaration : servomotor already present in the controller when the recording started
+ *  - xxxCommand : call of the corresponding method of the controller
+ *  - statusUpdate : change of status of a servomotor caused by the previous command
+ *  - stateUpdate : informations read from the device by updateInfos()
+ */
+enum RecordType{
+    motorDeclaration,
+    connectCommand,
+    pingCommand,
+    addMotorCommand,
+    removeMotorCommand,
+    changeIdCommand,
+    turnLEDCommand,
+    toggleLEDCommand,
+    changeSpeedCommand,
+    setPositionCommand,
+    addPositionCommand,
+    enableTorqueCommand,
+    torqueEnabledCommand,
+    updateInfosCommand,
+    statusUpdate,
+    stateUpdate
+};
+
+
+/**
+ * @brief Outcome of a recorded command: value returned or type of exception thrown
+ *
+ */
+enum RecordOutcome{
+    returnedFalse,
+    returnedTrue,
+    idErrorThrown,
+    outOfRangeErrorThrown,
+    connectionErrorThrown,
+    otherErrorThrown
+};
+
+
+/**
+ * @brief Record of a session log
+ *
+ *  - time : microseconds since the beginning of the session
+ *  - id : id of the servomotor concerned
+ *  - value : argument of the command (position, speed, new id, type of servomotor, status, ...)
+ *  - outcome : result of the command
+ *  - infos : READ_LENGTH bytes of informations for state updates (see Servomotor::setInfos())
+ *  - text : name of the servomotor for declarations and additions, message of the exception if one was thrown
+ */
+struct SessionRecord{
+    RecordType type;
+    uint64_t time;
+    uint8_t id;
+    int32_t value;
+    RecordOutcome outcome;
+    std::vector<uint8_t> infos;
+    std::string text;
+};
+
+
+/**
+ * @class SessionLogWriter
+ * @brief Appends timestamped records to a compact binary session log
+ *
+ * Each record is written as its type, the time elapsed since the previous record and the value, encoded as variable length integers, followed by its other fields.
+ *
+ */
+class SessionLogWriter{
+
+    private:
+        std::ofstream file;
+
+        std::chrono::time_point<std::chrono::steady_clock> startTime;
+        uint64_t lastTime;
+
+        /**
+         * @brief Writes an unsigned integer using 7 bits per byte, the highest bit telling if another byte follows
+         *
+         * @param value the value to write
+         */
+        void writeVarint(uint64_t value);
+
+    public:
+
+        /**
+         * @brief Constructs a new SessionLogWriter object and writes the header of the log
+         *
+         * @param fileName the name of the log file, overwritten if it exists
+         * @throw FileError if the file cannot be opened
+         */
+        SessionLogWriter(const std::string& fileName);
+
+        /**
+         * @brief Destroys the SessionLogWriter object, flushes and closes the file
+         *
+         */
+        ~SessionLogWriter();
+
+
+        /**
+         * @brief Timestamps and appends a record to the log
+         *
+         * @param record the record to write, its time is set to the current time
+         * @throw FileError if the record is a state update whose infos are not READ_LENGTH bytes long
+         */
+        void write(SessionRecord& record);
+
+        /**
+         * @brief Writes buffered records to the file
+         *
+         */
+        void flush();
+
+};
+
+
+/**
+ * @class SessionLogReader
+ * @brief Reads the records of a binary session log one after the other
+ *
+ */
+class SessionLogReader{
+
+    private:
+        std::ifstream file;
+        uint64_t lastTime;
+
+        /**
+         * @brief Reads an unsigned integer written by SessionLogWriter::writeVarint()
+         *
+         * @param value the value read
+         * @return true if the value could be read
+         * @return false if the end of the file was reached
+         */
+        bool readVarint(uint64_t& value);
+
+    public:
+
+        /**
+         * @brief Constructs a new SessionLogReader object and checks the header of the log
+         *
+         * @param fileName the name of the log file
+         * @throw FileError if the file cannot be opened or is not a session log
+         */
+        SessionLogReader(const std::string& fileName);
+
+        /**
+         * @brief Destroys the SessionLogReader object
+         *
+         */
+        ~SessionLogReader();
+
+
+        /**
+         * @brief Reads the next record of the log
+         *
+         * @param record the record read
+         * @return true if a record has been read
+         * @return false if the end of the log was reached
+         * @throw FileError if the log is truncated
+         */
+        bool next(SessionRecord& record);
+
+};
+
+    }
+}
+
+#endif
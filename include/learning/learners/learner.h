@@ -57,14 +57,23 @@ template<class U, class V> class Learner{
          * 
          * Template method, defined for uint16_t and double
          */
-        template<class R, class T> double computeSquaredError(const std::vector<R> target, const std::vector<T> real) const{
-            double sse = 0;
+        template<class R, class T> double computeSquaredError(const std::vector<R>& target, const std::vector<T>& real) const{
+            return computeSquaredError(target.data(), real.data(), target.size());
+        }
 
-            auto ptrR = real.cbegin();
-            for(auto ptrT=target.cbegin(); ptrT != target.cend(); ptrT++){
-                sse += std::pow(*ptrT - *ptrR, 2);
-                ptrR++;
-            }
+        /**
+         * @brief Template method, computes the sum of squared errors (SSE) between two arrays, without any allocation
+         * 
+         * @tparam R type of the values contained in the first array
+         * @tparam T type of the values contained in the second array
+         * @param target values of the first array
+         * @param real values of the second array
+         * @param size the number of values of each array
+         * @return double the computed SSE
+         */
+        template<class R, class T> double computeSquaredError(const R* target, const T* real, int size) const{
+            double sse = 0;
+            for(int i = 0; i < size; i++) sse += std::pow(target[i] - real[i], 2);
 
             return std::sqrt(sse);
         }
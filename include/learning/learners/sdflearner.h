@@ -39,7 +39,7 @@ class SdfLearner : public DeviceLearner{
         std::vector<float> rewards;
         int nbMoves;
 
-        double computeReward(const std::vector<float> target, const std::vector<int> action) const;
+        double computeReward(const std::vector<float>& target, const std::vector<int>& action) const;
 
     
     public:
@@ -0,0 +1,226 @@
+/**
+ * @file analyticcartesianconverter.h
+ * @author Gaël Gendron (gael.gendron@insa-rennes.fr)
+ * @brief File containing the AnalyticCartesianConverter class, inherited from CartesianConverter class
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+
+
+#ifndef ANALYTICCARTESIANCONVERTER_H
+#define ANALYTICCARTESIANCONVERTER_H
+
+#include <math.h>
+
+#include "cartesianconverter.h"
+#include "convertererror.h"
+
+namespace armlearn {
+    namespace kinematics {
+
+
+// Maximum number of servomotors moving the arm within its vertical plane
+#define ANALYTIC_MAX_PLANAR 3
+
+// Step of the search over the orientation of the last arm part when the planar chain is redundant, in radian
+#define ANALYTIC_PITCH_STEP (M_PI / 180)
+
+// Distance under which two geometric elements are considered as aligned or merged
+#define ANALYTIC_TOLERANCE 1e-6
+
+// Largest component of a unit approach vector out of the vertical plane of the arm, the device being unable to orient its end out of this plane
+#define ANALYTIC_APPROACH_TOLERANCE 1e-3
+
+
+/**
+ * @class AnalyticCartesianConverter
+ * @brief Class computing servomotor positions into cartesian coordinate system and reciprocally, using a closed-form inverse kinematics
+ *
+ * The device must be composed of a base rotating along the vertical axis followed by up to 3 servomotors rotating along parallel horizontal axes (as the shoulder, elbow and wrist angle of the WidowX arm).
+ * Servomotors placed after them must not move the end of the arm (as the wrist rotate and gripper of the WidowX arm), they keep their last position.
+ *
+ * Every branch (base facing or opposite to the target, elbow up or down) is computed and checked against the servomotor limits, the valid solution closest to the starting position is returned.
+ * With 3 planar servomotors, the orientation of the last part is searched from its last value, by steps of ANALYTIC_PITCH_STEP.
+ *
+ * With 3 planar servomotors, poses made of a position and an approach vector can also be reached (see tryPoseToServo()): the orientation of the last part is given by the approach vector, decoupling the wrist from the positioning servomotors.
+ *
+ * In singlePrecisionComputation mode, the planar inverse kinematics is solved in single precision.
+ * Angle errors stay far below one servomotor unit, the rounded positions only differing from the double precision ones at rounding boundaries, by one unit.
+ *
+ */
+class AnalyticCartesianConverter : public CartesianConverter{
+
+    protected:
+        bool modelComputed;
+
+        double baseSign;
+        int nbPlanar;
+        double planarSign[ANALYTIC_MAX_PLANAR];
+        double links[ANALYTIC_MAX_PLANAR][2];
+        double linkLength[ANALYTIC_MAX_PLANAR];
+        double linkAngle[ANALYTIC_MAX_PLANAR];
+        double shoulder[2];
+
+        double lateral;
+        double planeAxis[2];
+        double radialAxis[2];
+        int wristSegment;
+
+
+        /**
+         * @brief Computes the planar model of the device from its parts, with all servomotors in their middle position
+         *
+         * @throw ConverterError if the device does not have the required structure
+         */
+        void computeModel();
+
+        /**
+         * @brief Solves the planar inverse kinematics for a given target and branch, in double or single precision
+         *
+         * @param targetR distance to the first planar servomotor along the radial axis
+         * @param targetZ distance to the first planar servomotor along the vertical axis
+         * @param pitch orientation of the last planar part, used if there are 3 planar servomotors
+         * @param elbowUp branch of the solution
+         * @param angles output angles of the planar servomotors, in radian
+         * @return true if the target can be reached
+         * @return false otherwise
+         */
+        template<typename Scalar>
+        bool solvePlanar(Scalar targetR, Scalar targetZ, Scalar pitch, bool elbowUp, Scalar* angles) const;
+
+        /**
+         * @brief Computes the positions of the servomotors of one branch of the solution and checks them against the servomotor limits
+         *
+         * @param radial distance of the target along the radial axis of the arm, negative if the base is opposite to the target
+         * @param height height of the target
+         * @param base angle of the base, in radian
+         * @param pitch orientation of the last planar part, used if there are 3 planar servomotors
+         * @param elbowUp branch of the solution
+         * @param reference the position the solution is compared to, in servomotor unit
+         * @param candidate output positions of the servomotors, servomotors after the planar ones keeping their reference position
+         * @return double the squared distance between the solution and the reference, infinite if there is no solution within the limits
+         */
+        double solveBranch(double radial, double height, double base, double pitch, bool elbowUp, const std::vector<double>& reference, std::vector<double>& candidate) const;
+
+
+    public:
+
+        /**
+         * @brief Constructs a new Analytic Cartesian Converter object
+         *
+         */
+        AnalyticCartesianConverter();
+
+        /**
+         * @brief Destroys the Analytic Cartesian Converter object
+         *
+         */
+        virtual ~AnalyticCartesianConverter();
+
+        /**
+         * @brief Makes a copy of the converter (see Converter::clone())
+         * 
+         * Redefinition of Converter method
+         */
+        virtual AnalyticCartesianConverter* clone() const override;
+
+
+        /**
+         * @brief Adds an arm part to the robotic device (see Converter::addServo())
+         *
+         * @return Converter* pointor to itself, to be able to chain computations (as in functional programming)
+         * @throw ConverterError if the first servomotor does not rotate along the Z axis
+         *
+         * Redefinition of Converter method
+         */
+        virtual Converter* addServo(const std::string& name, Axis axis = fixed, double lengthX = 0.0, double lengthY = 0.0, double lengthZ = 0.0, double rotationX = 0.0, double rotationY = 0.0, double rotationZ = 0.0) override;
+
+        /**
+         * @brief Resets device system
+         *
+         * @return Converter* pointor to itself, to be able to chain computations (as in functional programming)
+         *
+         * Redefinition of Converter method
+         */
+        virtual Converter* removeAllServos() override;
+
+
+        /**
+         * @brief Computes cartesian coordinates from servomotor positions, without throwing any exception
+         *
+         * @param positions the positions of the servomotors
+         * @param coordinates output coordinates under cartesian coordinate system [X, Y, Z]
+         * @return ComputationStatus the result of the computation (see converter.h)
+         *
+         * Redefinition of Converter method
+         */
+        virtual ComputationStatus tryServoToCoord(const std::vector<uint16_t>& positions, std::vector<double>& coordinates) override;
+
+        /**
+         * @brief Computes servomotor positions from cartesian coordinates, without throwing any exception
+         *
+         * @param coordinates under cartesian coordinate system [X, Y, Z]
+         * @param positions input positions the solution must be the closest to, output positions of the servomotors
+         * @return ComputationStatus the result of the computation, noSolutionFound if the coordinates cannot be reached within the servomotor limits (see converter.h)
+         *
+         * Redefinition of Converter method
+         */
+        virtual ComputationStatus tryCoordToServo(const std::vector<double>& coordinates, std::vector<uint16_t>& positions) override;
+
+        /**
+         * @brief Computes servomotor positions from cartesian coordinates close to the ones of a previous solution, without throwing any exception
+         *
+         * The closed form solution being of constant cost, the inverse kinematics is fully solved instead of iterated, the branch closest to the previous solution being kept.
+         *
+         * @param coordinates under cartesian coordinate system [X, Y, Z]
+         * @param positions input previous solution, output positions of the servomotors
+         * @param report output quality of the result, without any iteration (see TrackingReport)
+         * @return ComputationStatus the result of the computation (see converter.h)
+         *
+         * Redefinition of CartesianConverter method
+         */
+        virtual ComputationStatus tryTrackCoord(const std::vector<double>& coordinates, std::vector<uint16_t>& positions, TrackingReport& report) override;
+
+
+        /**
+         * @brief Computes the pose of the end of the device from servomotor positions, without throwing any exception
+         *
+         * @param positions the positions of the servomotors
+         * @param pose output pose [X, Y, Z, aX, aY, aZ], the coordinates of the end of the device followed by its approach vector, the unit vector from the axis of the last planar servomotor to the end of the device
+         * @return ComputationStatus the result of the computation, undefinedDevice if the structure of the device is not supported (see converter.h)
+         */
+        ComputationStatus tryServoToPose(const std::vector<uint16_t>& positions, std::vector<double>& pose);
+
+        /**
+         * @brief Computes all the servomotor positions reaching a pose, without throwing any exception
+         *
+         * The approach vector sets the orientation of the last planar part, the wrist is placed analytically behind it and the positioning servomotors solve the remaining planar problem.
+         * Every branch (base facing or opposite to the target, elbow up or down) within the servomotor limits is returned.
+         * The approach vector must lie in the vertical plane of the arm (see ANALYTIC_APPROACH_TOLERANCE), servomotors after the planar ones (as the wrist rotate setting the roll of the gripper) keep their reference position.
+         *
+         * @param pose the pose [X, Y, Z, aX, aY, aZ] (see tryServoToPose()), the approach vector not needing to be normalized
+         * @param reference the reference positions of the servomotors
+         * @param solutions output positions of the servomotors of every branch, sorted by distance to the reference
+         * @return ComputationStatus the result of the computation, undefinedDevice if the device does not have 3 planar servomotors, noSolutionFound if the pose cannot be reached within the servomotor limits (see converter.h)
+         */
+        ComputationStatus tryPoseToServo(const std::vector<double>& pose, const std::vector<uint16_t>& reference, std::vector<std::vector<uint16_t>>& solutions);
+
+        /**
+         * @brief Computes the servomotor positions reaching a pose, closest to the last known position of the device (see tryPoseToServo())
+         *
+         * @param pose the pose [X, Y, Z, aX, aY, aZ]
+         * @return Converter* pointor to itself, to be able to chain computations (as in functional programming)
+         * @throw ComputationError if the size of the pose is invalid or the pose cannot be reached
+         * @throw ConverterError if the structure of the device is not supported
+         */
+        Converter* computePoseToServo(const std::vector<double>& pose);
+
+};
+
+    }
+}
+
+#endif
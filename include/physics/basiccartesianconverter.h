@@ -18,16 +18,46 @@
 #include <kdl/chainiksolverpos_nr.hpp>
 
 #include "cartesianconverter.h"
+#include "workspaceindex.h"
 
 namespace armlearn {
     namespace kinematics {
 
 
+// Default maximum number of iterations of the inverse kinematics solvers
+#define IK_MAX_ITERATIONS 100
+
+// Default tolerance of the inverse kinematics solvers, in the unit of the coordinates
+#define IK_TOLERANCE 1e-6
+
+// Initial damping of the Levenberg-Marquardt solver, in the unit of the coordinates per radian
+#define LM_INITIAL_DAMPING 1.0
+
+// Damping of the Levenberg-Marquardt solver above which it is considered as stuck
+#define LM_MAX_DAMPING 1e6
+
+
+/**
+ * @brief Algorithms available to compute the inverse kinematics
+ * 
+ *  - newtonRaphsonSolver : KDL Newton-Raphson solver on the full frame, ignoring the servomotor limits
+ *  - levenbergMarquardtSolver : damped least squares on the position only, with adaptive damping, keeping each servomotor within its limits
+ * 
+ */
+enum IKSolver{
+    newtonRaphsonSolver,
+    levenbergMarquardtSolver
+};
+
+
 /**
  * @class BasicCartesianConverter
  * @brief Class computing servomotor positions into cartesian coordinate system and reciprocally
  * 
  * Note that computations are more likely to succeed if the device only moves within a plane 
+ * 
+ * The inverse kinematics starts from the last known positions, or from the closest sample of a workspace index if one is set (see setWorkspaceIndex())
+ * Its algorithm and budget are chosen with setSolver(), the Levenberg-Marquardt solver being more robust when the target orientation is not reachable and always returning positions within the servomotor limits
  *  
  */
 class BasicCartesianConverter : public CartesianConverter{
@@ -38,6 +68,43 @@ class BasicCartesianConverter : public CartesianConverter{
         KDL::ChainIkSolverVel* intermediaryVelocitySolver;
         KDL::ChainIkSolverPos* positionConverter;
 
+        KDL::JntArray jointPositions;
+        KDL::JntArray initialValues;
+        KDL::Frame cartPos;
+
+        const WorkspaceIndex* workspaceIndex;
+        std::vector<uint16_t> seed;
+
+        IKSolver solver;
+        int maxIterations;
+        double tolerance;
+        std::vector<double> candidate;
+        std::vector<double> weights;
+        std::vector<double> motion;
+
+
+        /**
+         * @brief Rebuilds the internal data of the solvers and resizes the joint arrays, called each time the device changes
+         * 
+         */
+        void updateSolvers();
+
+        /**
+         * @brief Solves the inverse kinematics with the Levenberg-Marquardt solver, from initialValues to jointPositions
+         * 
+         * @param coordinates the 3 target coordinates
+         * @return true if the target has been reached within the tolerance
+         * @return false otherwise
+         */
+        bool solveLevenbergMarquardt(const double* coordinates);
+
+        /**
+         * @brief Constructs a new Cartesian Converter object with the same device and settings as another one, with its own solvers
+         * 
+         * @param other the converter to copy
+         */
+        BasicCartesianConverter(const BasicCartesianConverter& other);
+
 
     public:
 
@@ -53,22 +120,80 @@ class BasicCartesianConverter : public CartesianConverter{
          */
         virtual ~BasicCartesianConverter();
 
+        /**
+         * @brief Makes a copy of the converter, sharing the workspace index (see Converter::clone())
+         * 
+         * Redefinition of Converter method
+         */
+        virtual BasicCartesianConverter* clone() const override;
+
 
         /**
-         * @brief Computes cartesian coordinates from servomotor positions
+         * @brief Adds an arm part to the robotic device (see Converter::addServo())
+         * 
+         * @return Converter* pointor to itself, to be able to chain computations (as in functional programming)
+         * 
+         * Redefinition of Converter method
+         */
+        virtual Converter* addServo(const std::string& name, Axis axis = fixed, double lengthX = 0.0, double lengthY = 0.0, double lengthZ = 0.0, double rotationX = 0.0, double rotationY = 0.0, double rotationZ = 0.0) override;
+
+        /**
+         * @brief Resets device system
+         * 
+         * @return Converter* pointor to itself, to be able to chain computations (as in functional programming)
+         * 
+         * Redefinition of Converter method
+         */
+        virtual Converter* removeAllServos() override;
+
+        /**
+         * @brief Sets the index giving the starting point of the inverse kinematics, the index must have been built from the same device
+         * 
+         * @param index the workspace index, not owned by the converter, nullptr to start from the last known positions
+         * @return Converter* pointor to itself, to be able to chain computations (as in functional programming)
+         */
+        Converter* setWorkspaceIndex(const WorkspaceIndex* index);
+
+        /**
+         * @brief Sets the algorithm computing the inverse kinematics and its budget
+         * 
+         * @param type the solver used
+         * @param iterations the maximum number of iterations
+         * @param eps the tolerance, the Newton-Raphson solver applying it to each component of the remaining frame error and the Levenberg-Marquardt solver to the distance to the target
+         * @return Converter* pointor to itself, to be able to chain computations (as in functional programming)
+         * @throw ConverterError if the budget is not positive
+         */
+        Converter* setSolver(IKSolver type, int iterations = IK_MAX_ITERATIONS, double eps = IK_TOLERANCE);
+
+        /**
+         * @brief Gets the algorithm computing the inverse kinematics
+         * 
+         * @return IKSolver the solver used
+         */
+        IKSolver getSolver() const;
+
+
+        /**
+         * @brief Computes cartesian coordinates from servomotor positions, without throwing any exception
          * 
          * @param positions the positions of the servomotors
-         * @return Converter* itself (see converter.h)
+         * @param coordinates output coordinates under cartesian coordinate system [X, Y, Z]
+         * @return ComputationStatus the result of the computation (see converter.h)
+         * 
+         * Redefinition of Converter method
          */
-        virtual Converter* computeServoToCoord(const std::vector<uint16_t>& positions) override;
+        virtual ComputationStatus tryServoToCoord(const std::vector<uint16_t>& positions, std::vector<double>& coordinates) override;
 
         /**
-         * @brief Computes servomotor positions from cartesian coordinates
+         * @brief Computes servomotor positions from cartesian coordinates, without throwing any exception
          * 
          * @param coordinates under cartesian coordinate system [X, Y, Z] 
-         * @return Converter* itself (see converter.h)
+         * @param positions input starting point of the solver, replaced by the closest sample of the workspace index if one is set, output positions of the servomotors
+         * @return ComputationStatus the result of the computation (see converter.h)
+         * 
+         * Redefinition of Converter method
          */
-        virtual Converter* computeCoordToServo(const std::vector<double>& coordinates) override;
+        virtual ComputationStatus tryCoordToServo(const std::vector<double>& coordinates, std::vector<uint16_t>& positions) override;
 
 };
 
@@ -19,13 +19,91 @@
 namespace armlearn {
     namespace kinematics {
 
+
+class ReachabilityMap;
+
+
+// Default damping of the velocity inverse kinematics, in the unit of the coordinates per radian
+#define VELOCITY_DAMPING 1.0
+
+
 /**
  * @class CartesianConverter
  * @brief Abstract class for cartesian converters
+ * 
+ * Provides the jacobian of the device and a velocity inverse kinematics computing small motions around a configuration, faster than a full inverse kinematics to follow a path
+ * The tracking inverse kinematics (see tryTrackCoord()) iterates these motions from the previous solution, for a bounded cost per target
+ * Unreachable coordinates can be rejected before the inverse kinematics with a reachability map (see setReachabilityMap())
  *  
  */
 class CartesianConverter : public Converter{
 
+    protected:
+        std::vector<double> jacobianBuffer;
+        std::vector<double> trackingBuffer;
+        const ReachabilityMap* reachability;
+
+
+        /**
+         * @brief Computes the frame at the tip of the device from joint values in radian, with the kinematic chain of the converter
+         * 
+         * @param jointValues the values of the joints, getNbServos() values
+         * @param tip output frame of the end of the device
+         */
+        virtual void computeChainTip(const double* jointValues, Frame& tip) const;
+
+        /**
+         * @brief Computes the jacobian of the device from joint values in radian, with the kinematic chain of the converter (see KinematicChain::computeJacobian())
+         * 
+         * @param jointValues the values of the joints, getNbServos() values
+         * @param jacobian output 6 x getNbServos() matrix stored row by row
+         */
+        virtual void computeChainJacobian(const double* jointValues, double* jacobian) const;
+
+        /**
+         * @brief Computes the position of the tip of the device and its gradient from joint values in radian, with the kinematic chain of the converter (see KinematicChain::computePositionGradient())
+         * 
+         * @param jointValues the values of the joints, getNbServos() values
+         * @param position output position [X, Y, Z] of the end of the device
+         * @param gradient output 3 x getNbServos() matrix stored row by row
+         */
+        virtual void computeChainGradient(const double* jointValues, double* position, double* gradient) const;
+
+        /**
+         * @brief Checks whether coordinates are rejected by the reachability map, if one is set (see setReachabilityMap())
+         * 
+         * @param coordinates the 3 coordinates
+         * @return true if the coordinates cannot be reached
+         * @return false if they may be reached or no map is set
+         */
+        bool outOfReach(const double* coordinates) const;
+
+        /**
+         * @brief Computes the inverse of the weight of a servomotor in the damped least squares, from the gradient of the joint limit criterion H = sum (max - min)^2 / (4 (max - q) (q - min))
+         * 
+         * The weight only applies when the servomotor moves toward its closest limit, so that a servomotor at a limit can still move away from it.
+         * 
+         * @param servo the index of the servomotor
+         * @param position the position of the servomotor, in servomotor unit
+         * @param direction the motion of the servomotor in the unweighted solution, only its sign is used
+         * @return double the inverse of the weight, 1 if the servomotor moves away from its closest limit, 0 if it is at this limit and moves toward it
+         */
+        double limitWeight(int servo, double position, double direction) const;
+
+        /**
+         * @brief Solves the damped least squares dq = W^-1 J^T (J W^-1 J^T + damping^2 I)^-1 dx over the linear velocity rows of a jacobian
+         * 
+         * @param jacobian the jacobian, 6 rows of nbJoints values, only the first 3 rows being used
+         * @param nbJoints the number of joints
+         * @param damping the damping, in the unit of the coordinates per unit of the joints
+         * @param displacement the 3 coordinates of the displacement dx
+         * @param motion input inverse of the weight of each joint (W^-1, 0 to lock a joint), output motion dq of each joint
+         * @return true if the system has been solved
+         * @return false if it is singular, which is only possible without damping
+         */
+        bool solveDamped(const double* jacobian, int nbJoints, double damping, const double* displacement, double* motion) const;
+
+
     public:
 
         /**
@@ -40,6 +118,102 @@ class CartesianConverter : public Converter{
          */
         virtual ~CartesianConverter();
 
+
+        /**
+         * @brief Computes the cartesian coordinates of several servomotor configurations at once, without changing the results of the last computation
+         * 
+         * @param positions nbConfigs configurations of getNbServos() positions, stored one configuration after the other
+         * @param nbConfigs the number of configurations
+         * @param coordinates output array of nbConfigs results, each made of 3 coordinates followed by the orientation quaternion [X, Y, Z, W] if withOrientation is set
+         * @param withOrientation if true, outputs 7 values per configuration instead of 3
+         * 
+         * Uses the vectorized forward kinematics of KinematicChain instead of one solver call per configuration
+         * Redefinition of Converter method
+         */
+        virtual void computeServoToCoordBatch(const uint16_t* positions, int nbConfigs, double* coordinates, bool withOrientation = false) override;
+
+        /**
+         * @brief Computes the cartesian coordinates of several servomotor configurations at once, in single precision
+         * 
+         * @param positions nbConfigs configurations of getNbServos() positions, stored one configuration after the other
+         * @param nbConfigs the number of configurations
+         * @param coordinates output array of nbConfigs results of 3 coordinates
+         * 
+         * Computes directly in single precision if the forward mode is singlePrecisionComputation, converts the double precision results otherwise
+         * Redefinition of Converter method
+         */
+        virtual void computeServoToCoordBatch(const uint16_t* positions, int nbConfigs, float* coordinates) override;
+
+
+        /**
+         * @brief Sets the map rejecting unreachable coordinates before the inverse kinematics, which then returns unreachableTarget
+         * 
+         * @param map the map, not owned by the converter and shared with its clones, nullptr to remove it
+         * @return Converter* pointor to itself, to be able to chain computations (as in functional programming)
+         */
+        Converter* setReachabilityMap(const ReachabilityMap* map);
+
+
+        /**
+         * @brief Computes the jacobian of the device, without throwing any exception
+         * 
+         * @param positions the positions of the servomotors
+         * @param jacobian output 6 x getNbServos() matrix stored row by row, derivative of the linear velocity [X, Y, Z] then angular velocity [X, Y, Z] of the end of the device with respect to the positions, in servomotor unit
+         * @return ComputationStatus the result of the computation (see converter.h)
+         */
+        ComputationStatus tryJacobian(const std::vector<uint16_t>& positions, std::vector<double>& jacobian) const;
+
+        /**
+         * @brief Computes cartesian coordinates from servomotor positions along with their gradient, without throwing any exception
+         * 
+         * The gradient is computed analytically from the axes of the servomotors, for the cost of about two forward kinematics.
+         * 
+         * @param positions getNbServos() positions of the servomotors
+         * @param coordinates output coordinates under cartesian coordinate system [X, Y, Z]
+         * @param gradient output 3 x getNbServos() matrix stored row by row, derivative of [X, Y, Z] with respect to the positions, in servomotor unit
+         * @return ComputationStatus the result of the computation (see converter.h)
+         */
+        ComputationStatus tryServoToCoordGradient(const uint16_t* positions, double* coordinates, double* gradient) const;
+
+        /**
+         * @brief Computes the cartesian coordinates of several servomotor configurations at once, along with their gradient (see tryServoToCoordGradient())
+         * 
+         * @param positions nbConfigs configurations of getNbServos() positions, stored one configuration after the other
+         * @param nbConfigs the number of configurations
+         * @param coordinates output array of nbConfigs results of 3 coordinates
+         * @param gradients output array of nbConfigs gradients of 3 x getNbServos() values
+         */
+        void computeServoToCoordGradientBatch(const uint16_t* positions, int nbConfigs, double* coordinates, double* gradients) const;
+
+        /**
+         * @brief Computes the motion of the servomotors moving the end of the device by a small cartesian displacement, without throwing any exception
+         * 
+         * Damped least squares solution dq = W^-1 J^T (J W^-1 J^T + damping^2 I)^-1 dx, where J is the positional jacobian.
+         * The weight W of each servomotor moving toward a limit grows as it gets closer to it (see setServoLimits()), a servomotor at a limit does not move further into it but can move away from it.
+         * 
+         * @param positions the current positions of the servomotors
+         * @param displacement the cartesian displacement [dX, dY, dZ] to apply to the end of the device
+         * @param motion output motion of each servomotor, in servomotor unit
+         * @param damping the damping of the solution, trading accuracy for stability near singular configurations, in the unit of the coordinates per radian
+         * @return ComputationStatus the result of the computation (see converter.h)
+         */
+        ComputationStatus tryVelocityStep(const std::vector<uint16_t>& positions, const std::vector<double>& displacement, std::vector<double>& motion, double damping = VELOCITY_DAMPING);
+
+        /**
+         * @brief Computes servomotor positions from cartesian coordinates close to the ones of a previous solution, in a bounded number of iterations and without throwing any exception
+         * 
+         * Each iteration is a damped least squares step toward the target from the gradient of the coordinates (see tryVelocityStep()), the servomotors being kept within their limits.
+         * The cost is at most setTrackingLimits() iterations, each one about two forward kinematics, and the branch of the previous solution is kept.
+         * 
+         * @param coordinates the cartesian coordinates [X, Y, Z] to reach
+         * @param positions input previous solution, fully solved with tryCoordToServo() if it does not contain getNbServos() values, output positions of the servomotors
+         * @param report output quality of the result (see TrackingReport)
+         * @return ComputationStatus the result of the computation, computationSucceeded even if the tolerance is not reached (see converter.h)
+         * 
+         * Redefinition of Converter method
+         */
+        virtual ComputationStatus tryTrackCoord(const std::vector<double>& coordinates, std::vector<uint16_t>& positions, TrackingReport& report) override;
+
 };
 
     }
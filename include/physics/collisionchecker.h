@@ -0,0 +1,218 @@
+/**
+ * @file collisionchecker.h
+ * @author Gaël Gendron (gael.gendron@insa-rennes.fr)
+ * @brief File containing the CollisionChecker class, used to detect self-collisions of the arm and collisions with its workspace
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+
+
+
+#ifndef COLLISIONCHECKER_H
+#define COLLISIONCHECKER_H
+
+#include <vector>
+#include <sstream>
+
+#include "range.h"
+#include "kinematicchain.h"
+#include "computationerror.h"
+
+namespace armlearn {
+    namespace kinematics {
+
+
+// Default radius of the capsule surrounding an arm part (in the same unit as the lengths of the parts)
+#define DEFAULT_LINK_RADIUS 20
+
+// Default height of the table the arm is set on, in the base frame
+#define DEFAULT_TABLE_HEIGHT 0
+
+
+/**
+ * @class CollisionChecker
+ * @brief Class modelling each arm part as a capsule (segment swept by a sphere) and detecting collisions between them or with the workspace
+ *
+ * The frames of all parts are computed once per position and reused by every check.
+ * Pairs of parts in contact when all joints are at their zero value (adjacent parts, parts aligned along the same axis, ...) are never reported as colliding.
+ * The first part is considered as standing on the table.
+ *
+ */
+class CollisionChecker{
+
+    protected:
+        KinematicChain chain;
+        std::vector<double> radius;
+        std::vector<double> boundRadius;
+
+        std::vector<bool> ignoredPairs;
+        bool referenceComputed;
+
+        double tableHeight;
+        bool workspaceDefined;
+        double workspaceMin[3];
+        double workspaceMax[3];
+
+        std::vector<double> jointValues;
+        std::vector<Frame> frames;
+
+
+        /**
+         * @brief Gets the extremities of the capsule of a part from the last computed frames
+         *
+         * @param segment the index of the part
+         * @param start output start point of the capsule
+         * @param end output end point of the capsule
+         */
+        void getCapsule(int segment, const double*& start, const double*& end) const;
+
+        /**
+         * @brief Checks whether the capsules of two parts intersect with the last computed frames
+         *
+         * @param first index of the first part
+         * @param second index of the second part
+         * @return true if they intersect
+         * @return false otherwise
+         */
+        bool capsulesIntersect(int first, int second) const;
+
+        /**
+         * @brief Checks whether the capsule of a part goes under the table with the last computed frames
+         *
+         * @param segment index of the part
+         * @return true if it does
+         * @return false otherwise
+         */
+        bool underTable(int segment) const;
+
+        /**
+         * @brief Computes the pairs of parts in contact in the reference position (all joints at zero), that will be ignored
+         *
+         */
+        void computeReference();
+
+
+    public:
+
+        /**
+         * @brief Constructs a new CollisionChecker object
+         *
+         */
+        CollisionChecker();
+
+        /**
+         * @brief Destroys the CollisionChecker object
+         *
+         */
+        virtual ~CollisionChecker();
+
+
+        /**
+         * @brief Adds an arm part to the robotic device (see Converter::addServo() for the meaning of the geometric parameters)
+         *
+         * @param name the name of the servomotor
+         * @param axis along which axis does the servomotor rotate
+         * @param lengthX length of the rigid part along the X axis
+         * @param lengthY length of the rigid part along the Y axis
+         * @param lengthZ length of the rigid part along the Z axis
+         * @param rotationX rotation of the inner frame along the X axis, in radian
+         * @param rotationY rotation of the inner frame along the Y axis, in radian
+         * @param rotationZ rotation of the inner frame along the Z axis, in radian
+         * @param linkRadius radius of the capsule surrounding the rigid part
+         * @return CollisionChecker* pointer to itself, to be able to chain computations
+         */
+        CollisionChecker* addServo(const std::string& name, Axis axis = fixed, double lengthX = 0.0, double lengthY = 0.0, double lengthZ = 0.0, double rotationX = 0.0, double rotationY = 0.0, double rotationZ = 0.0, double linkRadius = DEFAULT_LINK_RADIUS);
+
+        /**
+         * @brief Resets device system
+         *
+         * @return CollisionChecker* pointer to itself, to be able to chain computations
+         */
+        CollisionChecker* removeAllServos();
+
+
+        /**
+         * @brief Sets the height of the table the arm is set on, no part can go under it
+         *
+         * @param height the height of the table in the base frame
+         * @return CollisionChecker* pointer to itself, to be able to chain computations
+         */
+        CollisionChecker* setTableHeight(double height);
+
+        /**
+         * @brief Sets a box the arm must stay in
+         *
+         * @param minCorner the corner of the box with the lowest coordinates [X, Y, Z]
+         * @param maxCorner the corner of the box with the highest coordinates [X, Y, Z]
+         * @return CollisionChecker* pointer to itself, to be able to chain computations
+         * @throw ComputationError if the corners do not have 3 coordinates
+         */
+        CollisionChecker* setWorkspace(const std::vector<double>& minCorner, const std::vector<double>& maxCorner);
+
+        /**
+         * @brief Removes the workspace box, only the table is kept
+         *
+         * @return CollisionChecker* pointer to itself, to be able to chain computations
+         */
+        CollisionChecker* removeWorkspace();
+
+
+        /**
+         * @brief Computes the frames of all parts for the given servomotor positions, used by the next checks
+         *
+         * @param positions the positions of the servomotors
+         * @return CollisionChecker* pointer to itself, to be able to chain computations
+         * @throw ComputationError if the number of positions does not match the number of servomotors
+         */
+        CollisionChecker* computeFrames(const std::vector<uint16_t>& positions);
+
+        /**
+         * @brief Checks whether two parts of the arm collide at the last computed position
+         *
+         * @return true if a self-collision is detected
+         * @return false otherwise
+         */
+        bool selfCollision() const;
+
+        /**
+         * @brief Checks whether a part of the arm goes under the table or out of the workspace box at the last computed position
+         *
+         * @return true if a collision with the workspace is detected
+         * @return false otherwise
+         */
+        bool workspaceCollision() const;
+
+        /**
+         * @brief Computes the frames for the given positions and checks all collisions
+         *
+         * @param positions the positions of the servomotors
+         * @return true if the position makes the arm collide with itself or its workspace
+         * @return false otherwise
+         */
+        bool collides(const std::vector<uint16_t>& positions);
+
+
+        /**
+         * @brief Gets the frame at the end of an arm part at the last computed position
+         *
+         * @param segment the index of the part
+         * @return const Frame& the frame, expressed in the base frame
+         */
+        const Frame& getFrame(int segment) const;
+
+        /**
+         * @brief Gets the number of moveable servomotors of the device
+         *
+         * @return int the number of servomotors
+         */
+        int getNbServos() const;
+
+};
+
+    }
+}
+
+#endif
@@ -18,28 +18,73 @@
 #include <kdl/segment.hpp>
 #include <vector>
 #include <iostream>
+#include <sstream>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 
 #include "range.h"
+#include "abstractcontroller.h"
+#include "kinematicchain.h"
 #include "computationerror.h"
+#include "convertererror.h"
 
 namespace armlearn {
     namespace kinematics {
 
 
 /**
- * @brief Enumeration listing the axis possibilities of each servomotor
- *  - rotation along X, Y or Z axis
- *  - translation along X, Y or Z axis
- *  - if fixed, does not count as a servomotor
+ * @brief Method used to compute servomotor positions into coordinates
+ * 
+ *  - solverComputation : computation specific to each converter (KDL solvers for cartesian converters)
+ *  - tableComputation : computation over the parts of the device, using sines and cosines precomputed for every servomotor position (see KinematicChain::computeTipFromServo())
+ *  - singlePrecisionComputation : same as tableComputation in single precision, on twice as many configurations at once (see KinematicChain::computePositionsFromServo()), the analytic inverse kinematics also running in single precision
+ */
+enum ForwardMode{
+    solverComputation,
+    tableComputation,
+    singlePrecisionComputation
+};
+
+
+/**
+ * @brief Result of a computation of the non-throwing API of the converters
+ * 
+ *  - computationSucceeded : the output is valid
+ *  - invalidInputSize : the size of the input does not match the device or the coordinate system
+ *  - undefinedDevice : the device does not have the structure required by the converter
+ *  - noSolutionFound : the computation did not succeed (e.g: the solver did not converge, the coordinates cannot be reached)
+ *  - unreachableTarget : the coordinates are out of the workspace of the device, detected before any computation (see ReachabilityMap)
  */
-enum Axis{
-    rotX,
-    rotY,
-    rotZ,
-    transX,
-    transY,
-    transZ,
-    fixed
+enum ComputationStatus{
+    computationSucceeded,
+    invalidInputSize,
+    undefinedDevice,
+    noSolutionFound,
+    unreachableTarget
+};
+
+
+// Default number of iterations of the tracking inverse kinematics (see Converter::setTrackingLimits())
+#define TRACKING_MAX_ITERATIONS 4
+
+// Default distance to the target under which the tracking inverse kinematics stops, in the unit of the coordinates
+#define TRACKING_TOLERANCE 1.0
+
+
+/**
+ * @brief Quality of the result of a tracking inverse kinematics (see Converter::tryTrackCoord())
+ * 
+ *  - iterations : the number of iterations run, 0 if the inverse kinematics has been fully solved (closed form or no previous solution)
+ *  - error : the distance between the target and the coordinates of the output positions, measured in cartesian coordinates by the cylindrical converter
+ *  - converged : whether the error is within the tolerance
+ */
+struct TrackingReport{
+    int iterations;
+    double error;
+    bool converged;
 };
 
 
@@ -47,16 +92,92 @@ enum Axis{
  * @class Converter
  * @brief Abstract class computing servomotor positions into a coordinate system and reciprocally
  * 
+ * Inherited classes implement the non-throwing API (tryServoToCoord() and tryCoordToServo()), the throwing API (computeServoToCoord() and computeCoordToServo()) is built on top of it
+ * 
+ * The const queries (servoToCoord() and coordToServo()) are reentrant: each calling thread works on its own clone of the converter (see clone()), made on its first query and after each modification of the converter.
+ * One configured converter can thus be shared by parallel code, as long as it is not modified during the queries.
+ * 
  */
 class Converter{
 
     protected:
+
+        /**
+         * @brief Clone of the converter made by a thread for the const queries, with the configuration it was made from
+         * 
+         */
+        struct Scratch{
+            uint64_t configuration;
+            std::unique_ptr<Converter> clone;
+        };
+
         std::vector<uint16_t> lastServo;
         std::vector<double> lastCoord;
 
+        std::vector<uint16_t> servoBuffer;
+        std::vector<double> coordBuffer;
+
         KDL::Chain* device;
         int nbServos;
 
+        KinematicChain chain;
+        ForwardMode forwardMode;
+        std::vector<uint16_t> servoMin;
+        std::vector<uint16_t> servoMax;
+
+        std::atomic<uint64_t> configuration;
+
+        mutable std::mutex scratchLock;
+        mutable std::unordered_map<std::thread::id, Scratch> clones; // Released with the converter
+
+        int trackingIterations;
+        double trackingTolerance;
+        TrackingReport lastTracking;
+
+
+        /**
+         * @brief Checks whether a position is within the limits of a servomotor (see setServoLimits())
+         * 
+         * @param servo the index of the servomotor
+         * @param position the position to check, in servomotor unit
+         * @return true if the position is strictly within the limits
+         * @return false otherwise
+         */
+        bool withinLimits(int servo, double position) const;
+
+        /**
+         * @brief Throws the exception corresponding to the status of a failed computation
+         * 
+         * @param status the status returned by the non-throwing API
+         * @param computation the name of the computation, for the message of the exception
+         * @param inputSize the size of the input of the computation
+         * @throw ConverterError if the device is not defined
+         * @throw ComputationError otherwise
+         */
+        void raise(ComputationStatus status, const std::string& computation, int inputSize) const;
+
+        /**
+         * @brief Gives a new identifier to the configuration of the converter, to be called by every method modifying it so that the clones used by the const queries are made again
+         * 
+         */
+        void touch();
+
+        /**
+         * @brief Gets the clone of the converter used by the calling thread for the const queries, made if it does not match the current configuration
+         * 
+         * The clones are owned by the converter, one per thread having made a const query, and destroyed with it
+         * 
+         * @return Converter& the clone owned by the calling thread
+         */
+        Converter& scratch() const;
+
+        /**
+         * @brief Constructs a new Converter object with the same device as another one, the KDL chain being copied
+         * 
+         * @param other the converter to copy
+         */
+        Converter(const Converter& other);
+
     public:
 
         /**
@@ -71,6 +192,17 @@ class Converter{
          */
         virtual ~Converter();
 
+        Converter& operator=(const Converter&) = delete;
+
+
+        /**
+         * @brief Makes a copy of the converter with the same device and settings, not sharing any internal computation data
+         * 
+         * @return Converter* the copy, to be deleted by the caller
+         * 
+         * virtual method, inherited classes will copy their own solvers
+         */
+        virtual Converter* clone() const = 0;
 
         /**
          * @brief Adds an arm part to the robotic device, composed of a servomotor rotating along an axis linked to a rigid part of a given length
@@ -93,26 +225,186 @@ class Converter{
          */
         virtual Converter* removeAllServos();
 
+        /**
+         * @brief Sets the range of positions each servomotor can reach, the full range of a servomotor is used by default
+         * 
+         * @param minPositions the lower bounds of the positions, in servomotor unit
+         * @param maxPositions the upper bounds of the positions, in servomotor unit
+         * @return Converter* pointor to itself, to be able to chain computations (as in functional programming)
+         * @throw ComputationError if the sizes of the bounds do not match the number of servomotors
+         */
+        virtual Converter* setServoLimits(const std::vector<uint16_t>& minPositions, const std::vector<uint16_t>& maxPositions);
+
+        /**
+         * @brief Sets the range of positions of each servomotor from the servomotors of a controller, taken by increasing IDs
+         * 
+         * @param controller the controller of the device
+         * @return Converter* pointor to itself, to be able to chain computations (as in functional programming)
+         * @throw ComputationError if the number of servomotors of the controller does not match the converter
+         */
+        Converter* setServoLimits(const communication::AbstractController& controller);
+
+
+        /**
+         * @brief Sets the method used to compute servomotor positions into coordinates
+         * 
+         * @param mode the method to use (see ForwardMode enum for more details)
+         * @return Converter* pointor to itself, to be able to chain computations (as in functional programming)
+         */
+        virtual Converter* setForwardMode(ForwardMode mode);
+
+        /**
+         * @brief Gets the method used to compute servomotor positions into coordinates
+         * 
+         * @return ForwardMode the current method
+         */
+        ForwardMode getForwardMode() const;
+
+
+        /**
+         * @brief Computes coordinates from positions of servomotors, without throwing any exception nor changing the results of the last computation
+         * 
+         * @param positions the input of the calculation, positions of the servomotors
+         * @param coordinates output coordinates, resized if needed, unspecified if the computation fails
+         * @return ComputationStatus the result of the computation (see ComputationStatus enum for more details)
+         * 
+         * virtual method, inherited classes will implement calculations for specific coordinates systems
+         */
+        virtual ComputationStatus tryServoToCoord(const std::vector<uint16_t>& positions, std::vector<double>& coordinates) = 0;
+
+        /**
+         * @brief Computes positions of servomotors from coordinates, without throwing any exception nor changing the results of the last computation
+         * 
+         * @param coordinates the input of the calculation, coordinates of the arm
+         * @param positions input starting point of the computation if it contains getNbServos() values (e.g: the current positions), output positions of the servomotors, unspecified if the computation fails
+         * @return ComputationStatus the result of the computation (see ComputationStatus enum for more details)
+         * 
+         * virtual method, inherited classes will implement calculations for specific coordinates systems
+         */
+        virtual ComputationStatus tryCoordToServo(const std::vector<double>& coordinates, std::vector<uint16_t>& positions) = 0;
+
+
+        /**
+         * @brief Computes positions of servomotors from coordinates close to the ones of a previous solution, in a bounded number of iterations and without throwing any exception
+         * 
+         * Meant to follow a stream of nearby targets with a predictable cost: starting from the previous solution keeps its branch, and at most the number of iterations set by setTrackingLimits() is run.
+         * The positions are given even if the tolerance is not reached, the quality of the result being reported.
+         * 
+         * @param coordinates the input of the calculation, coordinates of the arm
+         * @param positions input previous solution, fully solved if it does not contain getNbServos() values, output positions of the servomotors
+         * @param report output quality of the result, unspecified if the computation fails
+         * @return ComputationStatus the result of the computation (see ComputationStatus enum for more details)
+         * 
+         * virtual method, calls tryCoordToServo() by default, inherited classes will implement an incremental computation
+         */
+        virtual ComputationStatus tryTrackCoord(const std::vector<double>& coordinates, std::vector<uint16_t>& positions, TrackingReport& report);
+
 
         /**
          * @brief Computes coordinates from positions of widowx arm servomotors
          * 
          * @param positions the input of the calculation, positions of the servomotors
          * @return Converter* pointor to itself, to be able to chain computations (as in functional programming)
+         * @throw ComputationError if the computation fails
+         * @throw ConverterError if the device is not defined
          * 
-         * virtual method, inherited classes will implement calculations for specific coordinates systems
+         * Calls tryServoToCoord() and saves its results
          */
-        virtual Converter* computeServoToCoord(const std::vector<uint16_t>& positions) = 0;
+        Converter* computeServoToCoord(const std::vector<uint16_t>& positions);
 
         /**
          * @brief Computes positions of widowx arm servomotors from coordinates (according to the coordinate system implemented)
          * 
          * @param coordinates the input of the calculation, coordinates of the arm
          * @return Converter* pointor to itself, to be able to chain computations (as in functional programming)
+         * @throw ComputationError if the computation fails
+         * @throw ConverterError if the device is not defined
          * 
-         * virtual method, inherited classes will implement calculations for specific coordinates systems
+         * Calls tryCoordToServo(), starting from the positions of the last computation, and saves its results
          */
-        virtual Converter* computeCoordToServo(const std::vector<double>& coordinates) = 0;
+        Converter* computeCoordToServo(const std::vector<double>& coordinates);
+
+
+        /**
+         * @brief Computes positions of servomotors from coordinates close to the last computation, in a bounded number of iterations (see tryTrackCoord())
+         * 
+         * @param coordinates the input of the calculation, coordinates of the arm
+         * @return Converter* pointor to itself, to be able to chain computations (as in functional programming)
+         * @throw ComputationError if the computation fails
+         * @throw ConverterError if the device is not defined
+         * 
+         * Calls tryTrackCoord(), starting from the positions of the last computation, and saves its results even if the tolerance is not reached (see getTrackingReport())
+         */
+        Converter* computeTrackCoord(const std::vector<double>& coordinates);
+
+        /**
+         * @brief Sets the bounds of the tracking inverse kinematics (see tryTrackCoord())
+         * 
+         * @param maxIterations the largest number of iterations run for one target
+         * @param tolerance the distance to the target under which the computation stops (see TrackingReport)
+         * @return Converter* pointor to itself, to be able to chain computations (as in functional programming)
+         * @throw ComputationError if no iteration is allowed or the tolerance is negative
+         */
+        virtual Converter* setTrackingLimits(int maxIterations = TRACKING_MAX_ITERATIONS, double tolerance = TRACKING_TOLERANCE);
+
+        /**
+         * @brief Gets the quality of the last tracking inverse kinematics (see computeTrackCoord())
+         * 
+         * @return TrackingReport the quality of the result
+         */
+        TrackingReport getTrackingReport() const;
+
+
+        /**
+         * @brief Computes coordinates from positions of servomotors into a buffer of the caller, without throwing any exception nor changing the results of the last computation
+         * 
+         * Reentrant, no allocation is made once the calling thread has made its clone of the converter.
+         * 
+         * @param positions the input of the calculation, getNbServos() positions
+         * @param coordinates output array of 3 coordinates, unchanged if the computation fails
+         * @return ComputationStatus the result of the computation (see ComputationStatus enum for more details)
+         * 
+         * Calls tryServoToCoord() of the clone of the calling thread
+         */
+        ComputationStatus servoToCoord(const uint16_t* positions, double* coordinates) const;
+
+        /**
+         * @brief Computes positions of servomotors from coordinates into a buffer of the caller, without throwing any exception nor changing the results of the last computation
+         * 
+         * Reentrant, no allocation is made once the calling thread has made its clone of the converter.
+         * 
+         * @param coordinates the input of the calculation, 3 coordinates
+         * @param positions input starting point of the computation, output array of getNbServos() positions, unchanged if the computation fails
+         * @return ComputationStatus the result of the computation (see ComputationStatus enum for more details)
+         * 
+         * Calls tryCoordToServo() of the clone of the calling thread
+         */
+        ComputationStatus coordToServo(const double* coordinates, uint16_t* positions) const;
+
+
+        /**
+         * @brief Computes the coordinates of several servomotor configurations at once, without changing the results of the last computation
+         * 
+         * @param positions nbConfigs configurations of getNbServos() positions, stored one configuration after the other
+         * @param nbConfigs the number of configurations
+         * @param coordinates output array of nbConfigs results, each made of 3 coordinates followed by the orientation quaternion [X, Y, Z, W] if withOrientation is set
+         * @param withOrientation if true, outputs 7 values per configuration instead of 3
+         * @throw ComputationError if the converter cannot compute the orientation
+         * 
+         * Calls tryServoToCoord() for each configuration, inherited classes can implement faster computations
+         */
+        virtual void computeServoToCoordBatch(const uint16_t* positions, int nbConfigs, double* coordinates, bool withOrientation = false);
+
+        /**
+         * @brief Computes the coordinates of several servomotor configurations at once, in single precision
+         * 
+         * @param positions nbConfigs configurations of getNbServos() positions, stored one configuration after the other
+         * @param nbConfigs the number of configurations
+         * @param coordinates output array of nbConfigs results of 3 coordinates
+         * 
+         * Converts the results of the double precision computation, inherited classes can compute directly in single precision (see singlePrecisionComputation)
+         */
+        virtual void computeServoToCoordBatch(const uint16_t* positions, int nbConfigs, float* coordinates);
 
 
         /**
@@ -129,6 +421,15 @@ class Converter{
          */
         std::vector<uint16_t> getServo() const;
 
+        /**
+         * @brief Checks whether servomotor positions are strictly within the limits of the servomotors (see setServoLimits())
+         * 
+         * @param positions getNbServos() positions
+         * @return true if every position is within its limits, or if no limits are known
+         * @return false otherwise
+         */
+        bool validPosition(const uint16_t* positions) const;
+
         /**
          * @brief Gets the number of moveable servomotors used in the computation (i.e: size of the getServo() output)
          * 
@@ -14,6 +14,7 @@
 #define CYLINDRICALCONVERTER_H
 
 #include <math.h>
+#include <functional>
 
 #include "basiccartesianconverter.h"
 #include "convertererror.h"
@@ -21,21 +22,60 @@
 namespace armlearn {
     namespace kinematics {
 
+
+// Number of orientations of the base tried when computing inverse kinematics, evenly spread over a full turn
+#define CYLINDRICAL_NB_SEEDS 12
+
+
 /**
  * @class CylindricalConverter
  * @brief Class computing servomotor positions into cylindrical coordinate system and reciprocally
  * 
  * Note that the first servo must have a rotation axis in order to set the cylindrical coordinate system
  * 
+ * Inverse kinematics is computed in parallel for CYLINDRICAL_NB_SEEDS orientations of the base, each one with its own solver, the solution of lowest cost being kept (see setSeedCost())
+ * The orientations are spread from the one of the current positions, so that the current branch is always among the solutions
+ * Tracking inverse kinematics (see tryTrackCoord()) only turns the base toward the target and iterates on the moving part, without any sweep
+ * 
  */
 class CylindricalConverter : public Converter{
 
+    public:
+
+        /**
+         * @brief Cost of an inverse kinematics solution, the solution of lowest cost is kept
+         * 
+         * Called with the candidate servomotor positions and the current ones (empty if unknown)
+         */
+        typedef std::function<double(const std::vector<uint16_t>&, const std::vector<uint16_t>&)> SeedCost;
+
     protected:
         BasicCartesianConverter* movingPart;
+        BasicCartesianConverter* seedSolvers[CYLINDRICAL_NB_SEEDS];
+        SeedCost seedCost;
 
         Axis baseAxis;
         bool baseDefined;
 
+        std::vector<uint16_t> movingServo;
+        std::vector<double> movingCoord;
+
+
+        /**
+         * @brief Constructs a new Cylindrical Converter object with the same device and settings as another one, its inner converters being cloned
+         * 
+         * @param other the converter to copy
+         */
+        CylindricalConverter(const CylindricalConverter& other);
+
+        /**
+         * @brief Computes the orientation of the end of the device in the frame of the moving part, i.e. without the rotation of the base, the cartesian coordinates of the moving part being kept in movingCoord
+         * 
+         * @param positions the positions of all the servomotors, base included
+         * @return double the angle of the end of the device around the axis of the base, in radian, 0 if it cannot be computed
+         */
+        double movingOrientation(const std::vector<uint16_t>& positions);
+
 
     public:
 
@@ -51,6 +91,13 @@ class CylindricalConverter : public Converter{
          */
         virtual ~CylindricalConverter();
 
+        /**
+         * @brief Makes a copy of the converter (see Converter::clone())
+         * 
+         * Redefinition of Converter method
+         */
+        virtual CylindricalConverter* clone() const override;
+
 
         /**
          * @brief Adds an arm part to the robotic device, composed of a servomotor rotating along an axis linked to a rigid part of a given length
@@ -78,22 +125,81 @@ class CylindricalConverter : public Converter{
          */
         virtual Converter* removeAllServos() override;
 
+        /**
+         * @brief Sets the method used to compute servomotor positions into coordinates, applied to the computation of the moving part
+         * 
+         * @param mode the method to use (see ForwardMode enum for more details)
+         * @return Converter* pointor to itself, to be able to chain computations (as in functional programming)
+         * 
+         * Redefinition of Converter method
+         */
+        virtual Converter* setForwardMode(ForwardMode mode) override;
+
+        /**
+         * @brief Sets the bounds of the tracking inverse kinematics, applied to the moving part
+         * 
+         * @param maxIterations the largest number of iterations run for one target
+         * @param tolerance the distance to the target under which the computation stops, in cartesian unit
+         * @return Converter* pointor to itself, to be able to chain computations (as in functional programming)
+         * @throw ComputationError if no iteration is allowed or the tolerance is negative
+         * 
+         * Redefinition of Converter method
+         */
+        virtual Converter* setTrackingLimits(int maxIterations = TRACKING_MAX_ITERATIONS, double tolerance = TRACKING_TOLERANCE) override;
+
+        /**
+         * @brief Sets the cost used to choose between the inverse kinematics solutions, jointDistance() by default
+         * 
+         * @param cost the cost function, called sequentially once all the solutions are computed
+         * @return Converter* pointor to itself, to be able to chain computations (as in functional programming)
+         */
+        Converter* setSeedCost(const SeedCost& cost);
+
+        /**
+         * @brief Computes the squared distance between two servomotor configurations, in servomotor unit
+         * 
+         * @param candidate the positions of a solution
+         * @param current the current positions, empty if unknown
+         * @return double the sum of the squared differences of the positions, 0 if the current positions are unknown
+         */
+        static double jointDistance(const std::vector<uint16_t>& candidate, const std::vector<uint16_t>& current);
+
 
         /**
-         * @brief Computes cylindrical coordinates from servomotor positions using Inverse Kinematics
+         * @brief Computes cylindrical coordinates from servomotor positions, without throwing any exception
          * 
          * @param positions the positions of the servomotors
-         * @return Converter* itself (see converter.h)
+         * @param coordinates output coordinates under cylindrical coordinate system [R, Têta, Z] 
+         * @return ComputationStatus the result of the computation, undefinedDevice if there is no rotational base (see converter.h)
+         * 
+         * Redefinition of Converter method
          */
-        virtual Converter* computeServoToCoord(const std::vector<uint16_t>& positions) override;
+        virtual ComputationStatus tryServoToCoord(const std::vector<uint16_t>& positions, std::vector<double>& coordinates) override;
 
         /**
-         * @brief Computes servomotor positions from cylindrical coordinates using Forward Kinematics
+         * @brief Computes servomotor positions from cylindrical coordinates, without throwing any exception
          * 
          * @param coordinates under cylindrical coordinate system [R, Têta, Z] 
-         * @return Converter* itself (see converter.h)
+         * @param positions input current positions, starting point of the solvers and reference of the cost, output positions of the servomotors
+         * @return ComputationStatus the result of the computation, noSolutionFound if no orientation of the base leads to a solution (see converter.h)
+         * 
+         * Redefinition of Converter method
+         */
+        virtual ComputationStatus tryCoordToServo(const std::vector<double>& coordinates, std::vector<uint16_t>& positions) override;
+
+        /**
+         * @brief Computes servomotor positions from cylindrical coordinates close to the ones of a previous solution, in a bounded number of iterations and without throwing any exception
+         * 
+         * The orientation of the moving part of the previous solution is kept, the base turning to face the target, and the moving part runs its own tracking inverse kinematics (see CartesianConverter::tryTrackCoord())
+         * 
+         * @param coordinates under cylindrical coordinate system [R, Têta, Z] 
+         * @param positions input previous solution, fully solved with tryCoordToServo() if it does not contain getNbServos() values, output positions of the servomotors
+         * @param report output quality of the result, the error being measured in cartesian coordinates (see TrackingReport)
+         * @return ComputationStatus the result of the computation, undefinedDevice if there is no rotational base or no servomotor after it (see converter.h)
+         * 
+         * Redefinition of Converter method
          */
-        virtual Converter* computeCoordToServo(const std::vector<double>& coordinates) override;
+        virtual ComputationStatus tryTrackCoord(const std::vector<double>& coordinates, std::vector<uint16_t>& positions, TrackingReport& report) override;
 
 };
 
@@ -0,0 +1,171 @@
+/**
+ * @file ikcache.h
+ * @author Gaël Gendron (gael.gendron@insa-rennes.fr)
+ * @brief File containing the IKCache class, storing the last results of inverse kinematics computations
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+
+
+#ifndef IKCACHE_H
+#define IKCACHE_H
+
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+
+namespace armlearn {
+    namespace kinematics {
+
+
+// Default maximal number of results kept by the cache
+#define IK_CACHE_CAPACITY 4096
+
+// Default size of the cells in which coordinates are considered identical, in the unit of the converter coordinates
+#define IK_CACHE_RESOLUTION 0.1
+
+
+/**
+ * @class IKCache
+ * @brief Bounded cache of inverse kinematics results, keyed on coordinates rounded to a given resolution
+ *
+ * Coordinates falling into the same cell of size resolution share the same result, the least recently used result being dropped when the cache is full.
+ * All methods can be called concurrently, a single cache can be shared by the converters of several threads.
+ *
+ */
+class IKCache{
+
+    protected:
+
+        /**
+         * @brief Coordinates rounded to the resolution of the cache
+         *
+         */
+        struct Key{
+            int64_t cell[3];
+
+            bool operator==(const Key& other) const;
+        };
+
+        /**
+         * @brief Hash function of the keys
+         *
+         */
+        struct KeyHash{
+            size_t operator()(const Key& key) const;
+        };
+
+        typedef std::list<std::pair<Key, std::vector<uint16_t>>> Entries;
+
+        Entries entries; // Most recently used first
+        std::unordered_map<Key, Entries::iterator, KeyHash> lookup;
+
+        size_t capacity;
+        double resolution;
+
+        uint64_t hits;
+        uint64_t misses;
+
+        mutable std::mutex lock;
+
+
+        /**
+         * @brief Rounds coordinates to the resolution of the cache
+         *
+         * @param coordinates the coordinates, only the first 3 values are used
+         * @param key output rounded coordinates
+         * @return true if the coordinates can be used as a key
+         * @return false otherwise
+         */
+        bool toKey(const std::vector<double>& coordinates, Key& key) const;
+
+
+    public:
+
+        /**
+         * @brief Constructs a new empty IKCache object
+         *
+         * @param maxSize the maximal number of results kept, at least 1
+         * @param cellSize the size of the cells in which coordinates are considered identical
+         */
+        IKCache(size_t maxSize = IK_CACHE_CAPACITY, double cellSize = IK_CACHE_RESOLUTION);
+
+        /**
+         * @brief Destroys the IKCache object
+         *
+         */
+        virtual ~IKCache();
+
+
+        /**
+         * @brief Looks for the result computed for coordinates, counted as a hit or a miss
+         *
+         * @param coordinates the target coordinates
+         * @param positions output servomotor positions, unchanged if not found
+         * @return true if a result was found
+         * @return false otherwise
+         */
+        bool find(const std::vector<double>& coordinates, std::vector<uint16_t>& positions);
+
+        /**
+         * @brief Stores the result computed for coordinates, replacing the one of the same cell if any
+         *
+         * @param coordinates the target coordinates
+         * @param positions the servomotor positions computed
+         */
+        void insert(const std::vector<double>& coordinates, const std::vector<uint16_t>& positions);
+
+        /**
+         * @brief Removes all the results, called when they are no longer valid (e.g: the device changed)
+         *
+         */
+        void clear();
+
+
+        /**
+         * @brief Gets the number of results stored
+         *
+         * @return size_t the number of results
+         */
+        size_t size() const;
+
+        /**
+         * @brief Gets the maximal number of results kept
+         *
+         * @return size_t the capacity of the cache
+         */
+        size_t getCapacity() const;
+
+        /**
+         * @brief Gets the size of the cells in which coordinates are considered identical
+         *
+         * @return double the resolution of the cache
+         */
+        double getResolution() const;
+
+        /**
+         * @brief Gets the number of successful calls to find() since the creation of the cache
+         *
+         * @return uint64_t the number of hits
+         */
+        uint64_t getHits() const;
+
+        /**
+         * @brief Gets the number of unsuccessful calls to find() since the creation of the cache
+         *
+         * @return uint64_t the number of misses
+         */
+        uint64_t getMisses() const;
+
+};
+
+    }
+}
+
+#endif
@@ -0,0 +1,240 @@
+/**
+ * @file kinematicchain.h
+ * @author Gaël Gendron (gael.gendron@insa-rennes.fr)
+ * @brief File containing the KinematicChain class, a lightweight representation of a serial chain computing the frames of all its parts
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+
+
+
+#ifndef KINEMATICCHAIN_H
+#define KINEMATICCHAIN_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+namespace armlearn {
+    namespace kinematics {
+
+
+/**
+ * @brief Enumeration listing the axis possibilities of each servomotor
+ *  - rotation along X, Y or Z axis
+ *  - translation along X, Y or Z axis
+ *  - if fixed, does not count as a servomotor
+ */
+enum Axis{
+    rotX,
+    rotY,
+    rotZ,
+    transX,
+    transY,
+    transZ,
+    fixed
+};
+
+
+// Number of distinct positions of a servomotor, size of the trigonometric tables
+#define SERVO_RESOLUTION 4096
+
+// Number of configurations computed together by KinematicChain::computeTips(), width of its vectorized loops
+#define CHAIN_BATCH_LANES 8
+
+// Number of configurations computed together by KinematicChain::computePositionsFromServo(), twice as many single precision values fitting in the same registers
+#define CHAIN_BATCH_LANES_SINGLE (2 * CHAIN_BATCH_LANES)
+
+
+/**
+ * @brief Rigid transformation, rotation matrix stored row by row followed by the translation
+ *
+ */
+struct Frame{
+    double rot[9];
+    double pos[3];
+};
+
+
+/**
+ * @class KinematicChain
+ * @brief Serial chain of arm parts, each one composed of a joint followed by a rigid transformation
+ *
+ * Follows the same conventions as the KDL chains built by the converters, without any allocation during computations.
+ * Computation methods are const and can be called concurrently.
+ *
+ */
+class KinematicChain{
+
+    protected:
+
+        /**
+         * @brief Part of the chain: a joint followed by a rigid transformation
+         *
+         */
+        struct Segment{
+            std::string name;
+            Axis axis;
+            double rot[9];
+            double trans[3];
+            float rotSingle[9];
+            float transSingle[3];
+        };
+
+        std::vector<Segment> segments;
+        int nbJoints;
+
+
+        /**
+         * @brief Writes the columns of the jacobian of the chain, shared by computeJacobian() and computePositionGradient()
+         *
+         * @param jointValues the values of the moveable joints, in radian for rotations, getNbJoints() values
+         * @param tip the position of the end of the chain
+         * @param jacobian output matrix of getNbJoints() columns stored row by row
+         * @param angular if true, the 3 rows of angular velocity are written after the 3 rows of linear velocity
+         */
+        void computeJacobianColumns(const double* jointValues, const double* tip, double* jacobian, bool angular) const;
+
+
+    public:
+
+        /**
+         * @brief Constructs a new empty KinematicChain object
+         *
+         */
+        KinematicChain();
+
+        /**
+         * @brief Destroys the KinematicChain object
+         *
+         */
+        virtual ~KinematicChain();
+
+
+        /**
+         * @brief Adds an arm part at the end of the chain (see Converter::addServo() for the meaning of the parameters)
+         *
+         * @param name the name of the part
+         * @param axis along which axis does the joint move
+         * @param lengthX length of the rigid part along the X axis
+         * @param lengthY length of the rigid part along the Y axis
+         * @param lengthZ length of the rigid part along the Z axis
+         * @param rotationX rotation of the inner frame along the X axis, in radian
+         * @param rotationY rotation of the inner frame along the Y axis, in radian
+         * @param rotationZ rotation of the inner frame along the Z axis, in radian
+         */
+        void addSegment(const std::string& name, Axis axis = fixed, double lengthX = 0.0, double lengthY = 0.0, double lengthZ = 0.0, double rotationX = 0.0, double rotationY = 0.0, double rotationZ = 0.0);
+
+        /**
+         * @brief Removes all the parts of the chain
+         *
+         */
+        void clear();
+
+
+        /**
+         * @brief Gets the number of parts of the chain
+         *
+         * @return int the number of segments
+         */
+        int getNbSegments() const;
+
+        /**
+         * @brief Gets the number of moveable joints of the chain
+         *
+         * @return int the number of joints
+         */
+        int getNbJoints() const;
+
+        /**
+         * @brief Gets the axis of the joint of a part
+         *
+         * @param segment the index of the part
+         * @return Axis the axis of its joint
+         */
+        Axis getAxis(int segment) const;
+
+        /**
+         * @brief Gets the name of a part
+         *
+         * @param segment the index of the part
+         * @return const std::string& the name given when added
+         */
+        const std::string& getName(int segment) const;
+
+
+        /**
+         * @brief Computes the frames at the tip of every part of the chain in a single pass
+         *
+         * @param jointValues the values of the moveable joints, in radian for rotations, getNbJoints() values
+         * @param frames output array of getNbSegments() frames, frames[i] is the frame at the end of part i expressed in the base frame
+         */
+        void computeFrames(const double* jointValues, Frame* frames) const;
+
+        /**
+         * @brief Computes the frame at the tip of the chain
+         *
+         * @param jointValues the values of the moveable joints, in radian for rotations, getNbJoints() values
+         * @param tip output frame of the end of the chain expressed in the base frame
+         */
+        void computeTip(const double* jointValues, Frame& tip) const;
+
+        /**
+         * @brief Computes the jacobian of the chain, derivative of the velocity of its tip with respect to the values of the joints
+         *
+         * @param jointValues the values of the moveable joints, in radian for rotations, getNbJoints() values
+         * @param jacobian output 6 x getNbJoints() matrix stored row by row, linear velocity [X, Y, Z] followed by angular velocity [X, Y, Z], expressed in the base frame
+         */
+        void computeJacobian(const double* jointValues, double* jacobian) const;
+
+        /**
+         * @brief Computes the position of the tip of the chain and its derivative with respect to the values of the joints, the positional rows of computeJacobian()
+         *
+         * @param jointValues the values of the moveable joints, in radian for rotations, getNbJoints() values
+         * @param position output position [X, Y, Z] of the end of the chain
+         * @param gradient output 3 x getNbJoints() matrix stored row by row, derivative of [X, Y, Z] with respect to each joint value
+         */
+        void computePositionGradient(const double* jointValues, double* position, double* gradient) const;
+
+        /**
+         * @brief Computes the frames at the tip of the chain for several configurations at once
+         *
+         * Configurations are processed by blocks of CHAIN_BATCH_LANES, each operation being applied to the whole block in a vectorizable loop.
+         *
+         * @param jointValues the values of the moveable joints, getNbJoints() values per configuration stored one configuration after the other
+         * @param nbConfigs the number of configurations
+         * @param tips output array of nbConfigs frames
+         */
+        void computeTips(const double* jointValues, int nbConfigs, Frame* tips) const;
+
+        /**
+         * @brief Computes the frame at the tip of the chain directly from servomotor positions
+         *
+         * Sines and cosines are read from tables precomputed for the SERVO_RESOLUTION possible positions of a servomotor instead of being evaluated.
+         *
+         * @param positions the positions of the moveable joints, in servomotor unit, getNbJoints() values
+         * @param tip output frame of the end of the chain expressed in the base frame
+         */
+        void computeTipFromServo(const uint16_t* positions, Frame& tip) const;
+
+        /**
+         * @brief Computes the positions of the tip of the chain for several configurations at once, in single precision
+         *
+         * Sines and cosines are read from single precision tables, configurations are processed by blocks of CHAIN_BATCH_LANES_SINGLE in vectorizable loops.
+         * Rounding errors stay around 1e-6 relative to the length of the chain (below 2e-4 mm for the WidowX arm), far below the displacement of one servomotor unit (about 0.6 mm at full reach).
+         *
+         * @param positions the positions of the moveable joints, in servomotor unit, getNbJoints() values per configuration stored one configuration after the other
+         * @param nbConfigs the number of configurations
+         * @param coordinates output array of nbConfigs positions [X, Y, Z]
+         */
+        void computePositionsFromServo(const uint16_t* positions, int nbConfigs, float* coordinates) const;
+
+};
+
+    }
+}
+
+#endif
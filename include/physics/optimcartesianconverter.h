@@ -14,6 +14,7 @@
 
 #include "cartesianconverter.h"
 #include "cylindricalconverter.h"
+#include "ikcache.h"
 
 namespace armlearn {
     namespace kinematics {
@@ -22,6 +23,8 @@ namespace armlearn {
  * @class OptimCartesianConverter
  * @brief Class computing servomotor positions into cartesian coordinate system and reciprocally, can optimize computations if basis is cylindrical
  * 
+ * Inverse kinematics results can be stored in a cache (see setCache()), emptied at the first computation following any change of the converter
+ * 
  */
 class OptimCartesianConverter : public CartesianConverter{
 
@@ -31,21 +34,33 @@ class OptimCartesianConverter : public CartesianConverter{
         bool rotatingBase;
         bool baseDefined;
 
+        IKCache* cache;
+        mutable std::atomic<uint64_t> cacheConfiguration; // Updated by the copies made for the const queries
+
+        std::vector<double> cylindricalBuffer;
+
         /**
          * @brief Converts coordinates in cartesian system into coordinates in cylindrical system
          * 
          * @param cartCoord input coordinates in cartesian system
-         * @return std::vector<double> output coordinates in cylindrical system
+         * @param cylCoord output coordinates in cylindrical system, can be the same vector as the input
          */
-        std::vector<double> convertCoordToCylindricalSystem(std::vector<double> cartCoord);
+        void convertCoordToCylindricalSystem(const std::vector<double>& cartCoord, std::vector<double>& cylCoord) const;
 
         /**
          * @brief Converts coordinates in cylindrical system into coordinates in cartesian system
          * 
          * @param cylCoord input coordinates in cylindrical system
-         * @return std::vector<double> output coordinates in cartesian system
+         * @param cartCoord output coordinates in cartesian system, can be the same vector as the input
+         */
+        void convertCoordFromCylindricalSystem(const std::vector<double>& cylCoord, std::vector<double>& cartCoord) const;
+
+        /**
+         * @brief Constructs a new Optimized Cartesian Converter object with the same device and settings as another one, its inner converters being cloned
+         * 
+         * @param other the converter to copy
          */
-        std::vector<double> convertCoordFromCylindricalSystem(std::vector<double> cylCoord);
+        OptimCartesianConverter(const OptimCartesianConverter& other);
 
 
     public:
@@ -62,6 +77,13 @@ class OptimCartesianConverter : public CartesianConverter{
          */
         virtual ~OptimCartesianConverter();
 
+        /**
+         * @brief Makes a copy of the converter, sharing the cache (see Converter::clone())
+         * 
+         * Redefinition of Converter method
+         */
+        virtual OptimCartesianConverter* clone() const override;
+
 
         /**
          * @brief Adds an arm part to the robotic device, composed of a servomotor rotating along an axis linked to a rigid part of a given length
@@ -89,22 +111,44 @@ class OptimCartesianConverter : public CartesianConverter{
          */
         virtual Converter* removeAllServos() override;
 
+        /**
+         * @brief Sets the cache storing inverse kinematics results, the cache is emptied
+         * 
+         * @param ikCache the cache, not owned by the converter and possibly shared with other converters of the same device, nullptr to disable caching
+         * @return Converter* pointor to itself, to be able to chain computations (as in functional programming)
+         */
+        Converter* setCache(IKCache* ikCache);
+
+        /**
+         * @brief Gets the cache storing inverse kinematics results
+         * 
+         * @return IKCache* the cache, nullptr if disabled
+         */
+        IKCache* getCache() const;
+
 
         /**
-         * @brief Computes cylindrical coordinates from servomotor positions using Inverse Kinematics
+         * @brief Computes cartesian coordinates from servomotor positions, without throwing any exception
          * 
          * @param positions the positions of the servomotors
-         * @return Converter* itself (see converter.h)
+         * @param coordinates output coordinates under cartesian coordinate system [X, Y, Z]
+         * @return ComputationStatus the result of the computation (see converter.h)
+         * 
+         * Redefinition of Converter method
          */
-        virtual Converter* computeServoToCoord(const std::vector<uint16_t>& positions) override;
+        virtual ComputationStatus tryServoToCoord(const std::vector<uint16_t>& positions, std::vector<double>& coordinates) override;
 
         /**
-         * @brief Computes servomotor positions from cylindrical coordinates using Forward Kinematics
+         * @brief Computes servomotor positions from cartesian coordinates, without throwing any exception
+         * 
+         * @param coordinates under cartesian coordinate system [X, Y, Z]
+         * @param positions input starting point of the computation, output positions of the servomotors
+         * @return ComputationStatus the result of the computation (see converter.h)
          * 
-         * @param coordinates under cylindrical coordinate system [R, Têta, Z] 
-         * @return Converter* itself (see converter.h)
+         * If a cache is set, a result stored for coordinates within the same cell of the cache is returned without computation
+         * Redefinition of Converter method
          */
-        virtual Converter* computeCoordToServo(const std::vector<double>& coordinates) override;
+        virtual ComputationStatus tryCoordToServo(const std::vector<double>& coordinates, std::vector<uint16_t>& positions) override;
 
         /**
          * @brief Gets the number of moveable servomotors used in the computation (i.e: size of the getServo() output)
@@ -0,0 +1,144 @@
+/**
+ * @file reachabilitymap.h
+ * @author Gaël Gendron (gael.gendron@insa-rennes.fr)
+ * @brief File containing the ReachabilityMap class, a conservative bound of the coordinates a device can reach
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+
+
+#ifndef REACHABILITYMAP_H
+#define REACHABILITYMAP_H
+
+#include <vector>
+#include <cstdint>
+
+#include "cartesianconverter.h"
+
+namespace armlearn {
+    namespace kinematics {
+
+
+// Factor applied to the first order bound of the displacement between two samples, covering the curvature of the workspace
+#define REACHABILITY_MARGIN_FACTOR 1.5
+
+// Number of configurations sent at once to the converter when building the map
+#define REACHABILITY_BUILD_BATCH 1024
+
+
+/**
+ * @class ReachabilityMap
+ * @brief Conservative bound of the workspace of a device, rejecting coordinates that cannot be reached in a few operations
+ *
+ * The map is made of a spherical shell around a center (as the shoulder of the device) and an optional occupancy bitmap over a regular grid of cubic cells.
+ * Both are computed from a regular sampling of the servomotor positions, enlarged by a margin bounding the displacement of the end of the device between two samples (from the gradient of the coordinates, see CartesianConverter::computeServoToCoordGradientBatch()).
+ * Coordinates rejected by reachable() cannot be reached within the sampled bounds (the curvature of the workspace between two samples being covered by REACHABILITY_MARGIN_FACTOR), coordinates accepted may still be out of reach.
+ *
+ * Set on a cartesian converter (see CartesianConverter::setReachabilityMap()), the inverse kinematics returns unreachableTarget before running any solver.
+ *
+ */
+class ReachabilityMap{
+
+    protected:
+        double center[3];
+        double minRadius;
+        double maxRadius;
+        double margin;
+
+        double origin[3];
+        double voxelSize;
+        int64_t dims[3];
+        std::vector<uint64_t> bitmap;
+
+
+        /**
+         * @brief Marks the cells within the margin of a sample as reachable
+         *
+         * @param coordinates the coordinates of the sample
+         */
+        void markVoxels(const double* coordinates);
+
+
+    public:
+
+        /**
+         * @brief Constructs a new empty ReachabilityMap object, rejecting nothing
+         *
+         */
+        ReachabilityMap();
+
+        /**
+         * @brief Destroys the ReachabilityMap object
+         *
+         */
+        virtual ~ReachabilityMap();
+
+
+        /**
+         * @brief Builds the map from the coordinates computed by a converter over a regular sampling of the servomotor positions
+         *
+         * @param converter the converter computing the coordinates, its last computation results are not modified
+         * @param minPositions the lower bound of the sampling of each servomotor
+         * @param maxPositions the upper bound of the sampling of each servomotor
+         * @param nbSamples the number of positions sampled for each servomotor, a single sample being placed in the middle of the bounds
+         * @param shellCenter the center of the spherical shell [X, Y, Z], the tightest shell being obtained around the first servomotor moving the end of the device in all directions
+         * @param voxelSize edge length of the cells of the bitmap, no bitmap being built if null
+         * @throw ComputationError if the parameters do not match the converter or the bitmap is too large
+         */
+        void build(const CartesianConverter& converter, const std::vector<uint16_t>& minPositions, const std::vector<uint16_t>& maxPositions, const std::vector<int>& nbSamples, const std::vector<double>& shellCenter = {0, 0, 0}, double voxelSize = 0);
+
+        /**
+         * @brief Resets the map, rejecting nothing
+         *
+         */
+        void clear();
+
+
+        /**
+         * @brief Checks if coordinates may be reached
+         *
+         * @param coordinates the 3 coordinates
+         * @return true if the coordinates are within the shell and in a reachable cell of the bitmap
+         * @return false if they cannot be reached
+         */
+        bool reachable(const double* coordinates) const;
+
+
+        /**
+         * @brief Gets the inner radius of the shell
+         *
+         * @return double the radius, 0 if the map is empty
+         */
+        double getMinRadius() const;
+
+        /**
+         * @brief Gets the outer radius of the shell
+         *
+         * @return double the radius, infinite if the map is empty
+         */
+        double getMaxRadius() const;
+
+        /**
+         * @brief Gets the margin added to the sampled coordinates
+         *
+         * @return double the bound of the displacement between two samples
+         */
+        double getMargin() const;
+
+        /**
+         * @brief Checks whether the map contains an occupancy bitmap
+         *
+         * @return true if a bitmap has been built
+         * @return false otherwise
+         */
+        bool hasBitmap() const;
+
+};
+
+    }
+}
+
+#endif
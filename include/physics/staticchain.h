@@ -0,0 +1,422 @@
+/**
+ * @file staticchain.h
+ * @author Gaël Gendron (gael.gendron@insa-rennes.fr)
+ * @brief File containing the StaticChain and StaticCartesianConverter templates, kinematic chains whose geometry is known at compile time
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+
+
+#ifndef STATICCHAIN_H
+#define STATICCHAIN_H
+
+#include <cmath>
+#include <string>
+#include <algorithm>
+
+#include "basiccartesianconverter.h"
+#include "collisionchecker.h"
+#include "convertererror.h"
+
+namespace armlearn {
+    namespace kinematics {
+
+
+/**
+ * @brief Declares an arm part usable by StaticChain, with the same parameters as Converter::addServo()
+ *
+ * Lengths and rotations must be constant expressions, the axis must be qualified (armlearn::kinematics::rotX, ...).
+ * Example: STATIC_SEGMENT(MyElbow, "elbow", armlearn::kinematics::rotX, 0, 0, 142, 0, 0, 0)
+ */
+#define STATIC_SEGMENT(type, segmentName, segmentAxis, lx, ly, lz, rx, ry, rz) \
+    struct type{ \
+        static constexpr armlearn::kinematics::Axis axis = segmentAxis; \
+        static constexpr double lengthX = lx; \
+        static constexpr double lengthY = ly; \
+        static constexpr double lengthZ = lz; \
+        static constexpr double rotationX = rx; \
+        static constexpr double rotationY = ry; \
+        static constexpr double rotationZ = rz; \
+        static const char* name(){ return segmentName; } \
+    }
+
+
+/**
+ * @brief Operations on the frame moving through one arm part, the axis being a constant so that only the code of this axis remains
+ *
+ */
+template<typename Segment>
+struct StaticPart{
+
+    enum{ nbJoints = Segment::axis != fixed ? 1 : 0 };
+
+    /**
+     * @brief Rotates the rotation matrix along one of its own axis, given the cosine and sine of the angle (rot = rot * R(axis, angle))
+     *
+     */
+    template<Axis A>
+    static inline void rotateAlong(double* rot, double c, double s){
+        const int a = A == rotX ? 1 : (A == rotY ? 2 : 0); // Columns modified by the rotation, as in KinematicChain
+        const int b = A == rotX ? 2 : (A == rotY ? 0 : 1);
+
+        for(int i = 0; i < 3; i++){
+            double ca = rot[3*i + a];
+            double cb = rot[3*i + b];
+            rot[3*i + a] = c * ca + s * cb;
+            rot[3*i + b] = c * cb - s * ca;
+        }
+    }
+
+    /**
+     * @brief Moves a frame through the part (frame = frame * joint(value) * part)
+     *
+     */
+    static inline void move(const double* jointValues, double* rot, double* pos){
+        switch(Segment::axis){
+            case rotX:
+                rotateAlong<rotX>(rot, std::cos(*jointValues), std::sin(*jointValues));
+                break;
+
+            case rotY:
+                rotateAlong<rotY>(rot, std::cos(*jointValues), std::sin(*jointValues));
+                break;
+
+            case rotZ:
+                rotateAlong<rotZ>(rot, std::cos(*jointValues), std::sin(*jointValues));
+                break;
+
+            case transX:
+            case transY:
+            case transZ:
+                for(int i = 0; i < 3; i++) pos[i] += rot[3*i + (Segment::axis - transX)] * *jointValues;
+                break;
+
+            case fixed:
+            default:
+                break;
+        }
+
+        // Translation expressed in the moved frame, then fixed rotation of the part, composed as KDL::Rotation::DoRotX, DoRotY then DoRotZ
+        for(int i = 0; i < 3; i++) pos[i] += rot[3*i] * Segment::lengthX + rot[3*i + 1] * Segment::lengthY + rot[3*i + 2] * Segment::lengthZ;
+        if(Segment::rotationX != 0) rotateAlong<rotX>(rot, std::cos(Segment::rotationX), std::sin(Segment::rotationX));
+        if(Segment::rotationY != 0) rotateAlong<rotY>(rot, std::cos(Segment::rotationY), std::sin(Segment::rotationY));
+        if(Segment::rotationZ != 0) rotateAlong<rotZ>(rot, std::cos(Segment::rotationZ), std::sin(Segment::rotationZ));
+    }
+
+    /**
+     * @brief Writes the column of the jacobian of the joint of the part, from the frame before the part, its angular rows only if angular is true
+     *
+     */
+    static inline void jacobianColumn(const double* tip, const double* rot, const double* pos, double* column, int stride, bool angular){
+        if(Segment::axis == fixed) return;
+
+        const int index = (Segment::axis - rotX) % 3;
+        double axis[3] = {rot[index], rot[3 + index], rot[6 + index]}; // Axis of the joint in the base frame
+
+        if(Segment::axis == rotX || Segment::axis == rotY || Segment::axis == rotZ){
+            double arm[3] = {tip[0] - pos[0], tip[1] - pos[1], tip[2] - pos[2]};
+
+            column[0] = axis[1] * arm[2] - axis[2] * arm[1];
+            column[stride] = axis[2] * arm[0] - axis[0] * arm[2];
+            column[2 * stride] = axis[0] * arm[1] - axis[1] * arm[0];
+            if(angular) for(int i = 0; i < 3; i++) column[(3 + i) * stride] = axis[i];
+        }else{
+            for(int i = 0; i < 3; i++) column[i * stride] = axis[i];
+            if(angular) for(int i = 0; i < 3; i++) column[(3 + i) * stride] = 0;
+        }
+    }
+
+};
+
+
+/**
+ * @class StaticChain
+ * @brief Serial chain of arm parts given as template parameters (see STATIC_SEGMENT()), following the same conventions as KinematicChain
+ *
+ * The loops over the parts are unrolled at compile time, the forward kinematics and the jacobian being straight-line code without any branch on the geometry.
+ * All methods are static and can be called concurrently.
+ *
+ */
+template<typename... Segments>
+struct StaticChain;
+
+template<>
+struct StaticChain<>{
+
+    enum{ nbSegments = 0, nbJoints = 0 };
+
+    static inline void move(const double* jointValues, double* rot, double* pos){}
+
+    static inline void jacobianColumns(const double* jointValues, const double* tip, double* rot, double* pos, double* jacobian, int stride, bool angular){}
+
+    static inline void build(Converter& converter){}
+
+    static inline void build(CollisionChecker& checker, const double* linkRadii){}
+
+};
+
+template<typename Segment, typename... Others>
+struct StaticChain<Segment, Others...>{
+
+    // Enumerators rather than static members, so that they can be used anywhere without a definition
+    enum{
+        nbSegments = 1 + StaticChain<Others...>::nbSegments,
+        nbJoints = StaticPart<Segment>::nbJoints + StaticChain<Others...>::nbJoints
+    };
+
+
+    /**
+     * @brief Moves a frame through all the parts of the chain
+     *
+     * @param jointValues the values of the moveable joints, in radian for rotations
+     * @param rot input/output rotation matrix stored row by row
+     * @param pos input/output position
+     */
+    static inline void move(const double* jointValues, double* rot, double* pos){
+        StaticPart<Segment>::move(jointValues, rot, pos);
+        StaticChain<Others...>::move(jointValues + StaticPart<Segment>::nbJoints, rot, pos);
+    }
+
+    /**
+     * @brief Writes the columns of the jacobian of the joints of the chain, moving the frame through the parts
+     *
+     * @param jointValues the values of the moveable joints, in radian for rotations
+     * @param tip the position of the end of the chain
+     * @param rot input/output rotation matrix stored row by row
+     * @param pos input/output position
+     * @param jacobian output first column of the joints of the chain
+     * @param stride number of values of a row of the jacobian
+     * @param angular if true, the 3 rows of angular velocity are written after the 3 rows of linear velocity
+     */
+    static inline void jacobianColumns(const double* jointValues, const double* tip, double* rot, double* pos, double* jacobian, int stride, bool angular){
+        StaticPart<Segment>::jacobianColumn(tip, rot, pos, jacobian, stride, angular);
+        StaticPart<Segment>::move(jointValues, rot, pos);
+        StaticChain<Others...>::jacobianColumns(jointValues + StaticPart<Segment>::nbJoints, tip, rot, pos, jacobian + StaticPart<Segment>::nbJoints, stride, angular);
+    }
+
+    /**
+     * @brief Adds the parts of the chain to a converter, with Converter::addServo()
+     *
+     * @param converter the converter to build
+     */
+    static inline void build(Converter& converter){
+        converter.addServo(Segment::name(), Segment::axis, Segment::lengthX, Segment::lengthY, Segment::lengthZ, Segment::rotationX, Segment::rotationY, Segment::rotationZ);
+        StaticChain<Others...>::build(converter);
+    }
+
+    /**
+     * @brief Adds the parts of the chain to a collision checker, with CollisionChecker::addServo()
+     *
+     * @param checker the collision checker to build
+     * @param linkRadii the radius of the envelope of each part, nbSegments values
+     */
+    static inline void build(CollisionChecker& checker, const double* linkRadii){
+        checker.addServo(Segment::name(), Segment::axis, Segment::lengthX, Segment::lengthY, Segment::lengthZ, Segment::rotationX, Segment::rotationY, Segment::rotationZ, linkRadii[0]);
+        StaticChain<Others...>::build(checker, linkRadii + 1);
+    }
+
+
+    /**
+     * @brief Computes the frame at the tip of the chain
+     *
+     * @param jointValues the values of the moveable joints, in radian for rotations, nbJoints values
+     * @param tip output frame of the end of the chain expressed in the base frame
+     */
+    static inline void computeTip(const double* jointValues, Frame& tip){
+        double rot[9] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+        double pos[3] = {0, 0, 0};
+        move(jointValues, rot, pos);
+
+        std::copy(rot, rot + 9, tip.rot);
+        std::copy(pos, pos + 3, tip.pos);
+    }
+
+    /**
+     * @brief Computes the jacobian of the chain (see KinematicChain::computeJacobian())
+     *
+     * @param jointValues the values of the moveable joints, in radian for rotations, nbJoints values
+     * @param jacobian output 6 x nbJoints matrix stored row by row, linear velocity [X, Y, Z] followed by angular velocity [X, Y, Z], expressed in the base frame
+     */
+    static inline void computeJacobian(const double* jointValues, double* jacobian){
+        Frame tip;
+        computeTip(jointValues, tip);
+
+        double rot[9] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+        double pos[3] = {0, 0, 0};
+        jacobianColumns(jointValues, tip.pos, rot, pos, jacobian, nbJoints, true);
+    }
+
+    /**
+     * @brief Computes the position of the tip of the chain and its gradient (see KinematicChain::computePositionGradient())
+     *
+     * @param jointValues the values of the moveable joints, in radian for rotations, nbJoints values
+     * @param position output position [X, Y, Z] of the end of the chain
+     * @param gradient output 3 x nbJoints matrix stored row by row
+     */
+    static inline void computePositionGradient(const double* jointValues, double* position, double* gradient){
+        Frame tip;
+        computeTip(jointValues, tip);
+        std::copy(tip.pos, tip.pos + 3, position);
+
+        double rot[9] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+        double pos[3] = {0, 0, 0};
+        jacobianColumns(jointValues, tip.pos, rot, pos, gradient, nbJoints, false);
+    }
+
+};
+
+
+/**
+ * @class StaticCartesianConverter
+ * @brief Cartesian converter of a device whose geometry is a StaticChain, built at construction
+ *
+ * The forward kinematics, the batch forward kinematics without orientation, the jacobian and the gradient use the unrolled code of the chain instead of the generic chain traversal.
+ * In singlePrecisionComputation mode, the forward kinematics use the single precision tables of the generic chain.
+ * The inverse kinematics uses the solvers of BasicCartesianConverter (see setSolver()), the Levenberg-Marquardt solver also running on the unrolled chain.
+ * The device cannot be modified, servomotor limits still have to be set (see setServoLimits()).
+ *
+ */
+template<typename Chain>
+class StaticCartesianConverter : public BasicCartesianConverter{
+
+    protected:
+        bool deviceBuilt;
+
+
+        /**
+         * @brief Computes the frame at the tip of the device from joint values in radian
+         *
+         * Redefinition of CartesianConverter method
+         */
+        virtual void computeChainTip(const double* jointValues, Frame& tip) const override{
+            Chain::computeTip(jointValues, tip);
+        }
+
+        /**
+         * @brief Computes the jacobian of the device from joint values in radian
+         *
+         * Redefinition of CartesianConverter method
+         */
+        virtual void computeChainJacobian(const double* jointValues, double* jacobian) const override{
+            Chain::computeJacobian(jointValues, jacobian);
+        }
+
+        /**
+         * @brief Computes the position of the tip of the device and its gradient from joint values in radian
+         *
+         * Redefinition of CartesianConverter method
+         */
+        virtual void computeChainGradient(const double* jointValues, double* position, double* gradient) const override{
+            Chain::computePositionGradient(jointValues, position, gradient);
+        }
+
+
+    public:
+
+        /**
+         * @brief Constructs a new Static Cartesian Converter object, with all the parts of the chain
+         *
+         */
+        StaticCartesianConverter():BasicCartesianConverter(), deviceBuilt(false){
+            Chain::build(*this);
+            deviceBuilt = true;
+        }
+
+        /**
+         * @brief Destroys the Static Cartesian Converter object
+         *
+         */
+        virtual ~StaticCartesianConverter(){
+
+        }
+
+        /**
+         * @brief Makes a copy of the converter (see Converter::clone())
+         *
+         * Redefinition of Converter method
+         */
+        virtual StaticCartesianConverter* clone() const override{
+            return new StaticCartesianConverter(*this);
+        }
+
+
+        /**
+         * @brief Adding a part is not possible once constructed, the device is fixed at compile time
+         *
+         * @throw ConverterError if called after the construction
+         *
+         * Redefinition of Converter method
+         */
+        virtual Converter* addServo(const std::string& name, Axis axis = fixed, double lengthX = 0.0, double lengthY = 0.0, double lengthZ = 0.0, double rotationX = 0.0, double rotationY = 0.0, double rotationZ = 0.0) override{
+            if(!deviceBuilt) return BasicCartesianConverter::addServo(name, axis, lengthX, lengthY, lengthZ, rotationX, rotationY, rotationZ);
+
+            throw ConverterError("Error : the device of a static converter is fixed at compile time, servomotors cannot be added");
+        }
+
+        /**
+         * @brief Removing the parts is not possible, the device is fixed at compile time
+         *
+         * @throw ConverterError in any case
+         *
+         * Redefinition of Converter method
+         */
+        virtual Converter* removeAllServos() override{
+            throw ConverterError("Error : the device of a static converter is fixed at compile time, servomotors cannot be removed");
+        }
+
+
+        /**
+         * @brief Computes cartesian coordinates from servomotor positions, without throwing any exception
+         *
+         * @param positions the positions of the servomotors
+         * @param coordinates output coordinates under cartesian coordinate system [X, Y, Z]
+         * @return ComputationStatus the result of the computation (see converter.h)
+         *
+         * Redefinition of Converter method
+         */
+        virtual ComputationStatus tryServoToCoord(const std::vector<uint16_t>& positions, std::vector<double>& coordinates) override{
+            if(positions.size() != Chain::nbJoints) return invalidInputSize;
+            if(forwardMode == singlePrecisionComputation) return BasicCartesianConverter::tryServoToCoord(positions, coordinates);
+
+            double jointValues[Chain::nbJoints];
+            for(int j = 0; j < Chain::nbJoints; j++) jointValues[j] = TO_RADIAN((double) positions[j]); // Conversion from servomotor unit to radian
+
+            Frame tip;
+            Chain::computeTip(jointValues, tip);
+            coordinates.assign(tip.pos, tip.pos + 3);
+
+            return computationSucceeded;
+        }
+
+        using BasicCartesianConverter::computeServoToCoordBatch;
+
+        /**
+         * @brief Computes the cartesian coordinates of several servomotor configurations at once (see Converter::computeServoToCoordBatch())
+         *
+         * Redefinition of Converter method
+         */
+        virtual void computeServoToCoordBatch(const uint16_t* positions, int nbConfigs, double* coordinates, bool withOrientation = false) override{
+            if(withOrientation || forwardMode == singlePrecisionComputation){
+                BasicCartesianConverter::computeServoToCoordBatch(positions, nbConfigs, coordinates, withOrientation);
+                return;
+            }
+
+            double jointValues[Chain::nbJoints];
+            Frame tip;
+            for(int c = 0; c < nbConfigs; c++){
+                for(int j = 0; j < Chain::nbJoints; j++) jointValues[j] = TO_RADIAN((double) positions[(size_t) c * Chain::nbJoints + j]); // Conversion from servomotor unit to radian
+
+                Chain::computeTip(jointValues, tip);
+                std::copy(tip.pos, tip.pos + 3, coordinates + (size_t) c * 3);
+            }
+        }
+
+};
+
+    }
+}
+
+#endif
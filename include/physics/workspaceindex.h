@@ -0,0 +1,207 @@
+/**
+ * @file workspaceindex.h
+ * @author Gaël Gendron (gael.gendron@insa-rennes.fr)
+ * @brief File containing the WorkspaceIndex class, a spatial index of the coordinates reached by sampled servomotor positions
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+
+
+#ifndef WORKSPACEINDEX_H
+#define WORKSPACEINDEX_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#include "converter.h"
+#include "mappedfile.h"
+
+namespace armlearn {
+    namespace kinematics {
+
+
+// Default edge length of the cells of the index, in the unit of the converter coordinates
+#define WORKSPACE_VOXEL_SIZE 10.0
+
+// Number of configurations sent at once to the converter when building the index
+#define WORKSPACE_BUILD_BATCH 1024
+
+// Identifier written at the beginning of the index files
+#define WORKSPACE_INDEX_MAGIC "ARMWSI\0"
+
+// Version of the index file format
+#define WORKSPACE_INDEX_VERSION 1
+
+
+/**
+ * @class WorkspaceIndex
+ * @brief Index of servomotor configurations sorted by the coordinates they reach, used to find the sampled configuration closest to a target
+ *
+ * The coordinates are spread over a regular grid of cubic cells, the samples of each cell being stored contiguously (compressed sparse rows).
+ * A saved index is mapped in memory when loaded, so that it is available immediately whatever its size.
+ * The file is written in the byte order of the machine building it.
+ *
+ * The configuration returned by nearest() is an approximate inverse kinematics, whose error is bounded by the sampling step, or a starting point for an iterative solver (see BasicCartesianConverter::setWorkspaceIndex()).
+ *
+ */
+class WorkspaceIndex{
+
+    protected:
+
+        /**
+         * @brief Description of the index, written at the beginning of the index files
+         *
+         */
+        struct Header{
+            char magic[8];
+            uint32_t version;
+            uint32_t nbServos;
+            uint32_t dims[3];
+            uint32_t nbEntries;
+            double origin[3];
+            double voxelSize;
+        };
+
+        Header header;
+
+        std::vector<uint32_t> offsetData;
+        std::vector<float> coordData;
+        std::vector<uint16_t> servoData;
+        MappedFile* mapped;
+
+        const uint32_t* offsets;
+        const float* coords;
+        const uint16_t* servos;
+
+
+        /**
+         * @brief Releases the current content of the index
+         *
+         */
+        void clear();
+
+        /**
+         * @brief Gets the number of cells of the grid
+         *
+         * @return uint64_t the number of cells
+         */
+        uint64_t getNbVoxels() const;
+
+        /**
+         * @brief Searches the closest sample among the samples of a cell
+         *
+         * @param voxel the index of the cell
+         * @param coordinates the target coordinates
+         * @param best input/output index of the closest sample found
+         * @param bestDistance input/output squared distance to the closest sample found
+         */
+        void searchVoxel(uint64_t voxel, const double* coordinates, int64_t& best, double& bestDistance) const;
+
+
+    public:
+
+        /**
+         * @brief Constructs a new empty WorkspaceIndex object
+         *
+         */
+        WorkspaceIndex();
+
+        /**
+         * @brief Constructs a new WorkspaceIndex object from an index file (see load())
+         *
+         * @param fileName the name of the index file
+         * @throw FileError if the file cannot be mapped or is not a valid index
+         */
+        WorkspaceIndex(const std::string& fileName);
+
+        /**
+         * @brief Destroys the WorkspaceIndex object
+         *
+         */
+        virtual ~WorkspaceIndex();
+
+        WorkspaceIndex(const WorkspaceIndex&) = delete;
+        WorkspaceIndex& operator=(const WorkspaceIndex&) = delete;
+
+
+        /**
+         * @brief Builds the index from the coordinates computed by a converter over a regular sampling of the servomotor positions
+         *
+         * @param converter the converter computing the coordinates, its last computation results are not modified
+         * @param minPositions the lower bound of the sampling of each servomotor
+         * @param maxPositions the upper bound of the sampling of each servomotor
+         * @param nbSamples the number of positions sampled for each servomotor, a single sample being placed in the middle of the bounds
+         * @param voxelSize edge length of the cells of the index
+         * @throw ComputationError if the parameters do not match the converter or the number of samples is too large
+         */
+        void build(Converter& converter, const std::vector<uint16_t>& minPositions, const std::vector<uint16_t>& maxPositions, const std::vector<int>& nbSamples, double voxelSize = WORKSPACE_VOXEL_SIZE);
+
+        /**
+         * @brief Saves the index in a file
+         *
+         * @param fileName the name of the index file
+         * @throw FileError if the file cannot be written
+         */
+        void save(const std::string& fileName) const;
+
+        /**
+         * @brief Replaces the index by the content of a file, mapped in memory
+         *
+         * @param fileName the name of the index file
+         * @throw FileError if the file cannot be mapped or is not a valid index
+         */
+        void load(const std::string& fileName);
+
+
+        /**
+         * @brief Checks if the index contains samples
+         *
+         * @return true if there is no sample
+         * @return false otherwise
+         */
+        bool empty() const;
+
+        /**
+         * @brief Gets the number of servomotors of the configurations
+         *
+         * @return int the number of servomotors
+         */
+        int getNbServos() const;
+
+        /**
+         * @brief Gets the number of samples
+         *
+         * @return int the number of configurations stored
+         */
+        int getNbEntries() const;
+
+
+        /**
+         * @brief Finds the sample closest to a target, without any allocation
+         *
+         * @param coordinates the 3 target coordinates
+         * @param positions output array of getNbServos() positions of the closest sample
+         * @return double the distance between the target and the closest sample
+         * @throw ComputationError if the index is empty
+         */
+        double nearest(const double* coordinates, uint16_t* positions) const;
+
+        /**
+         * @brief Finds the sample closest to a target
+         *
+         * @param coordinates the 3 target coordinates
+         * @return std::vector<uint16_t> the positions of the closest sample
+         * @throw ComputationError if the index is empty or the coordinates are not 3
+         */
+        std::vector<uint16_t> nearest(const std::vector<double>& coordinates) const;
+
+};
+
+    }
+}
+
+#endif
@@ -0,0 +1,158 @@
+/**
+ * @file workspacesampler.h
+ * @author Gaël Gendron (gael.gendron@insa-rennes.fr)
+ * @brief File containing the WorkspaceSampler class, computing the kinematics of a regular grid of servomotor positions in parallel
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+
+
+#ifndef WORKSPACESAMPLER_H
+#define WORKSPACESAMPLER_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#include "converter.h"
+#include "fileerror.h"
+
+namespace armlearn {
+    namespace kinematics {
+
+
+// Number of samples computed in parallel before being written to the file
+#define WORKSPACE_SAMPLER_BLOCK 16384
+
+// Identifier written at the beginning of the sample files
+#define WORKSPACE_SAMPLES_MAGIC "ARMWSS\0"
+
+// Version of the sample file format
+#define WORKSPACE_SAMPLES_VERSION 1
+
+
+/**
+ * @brief Flags of a sample telling which computations succeeded
+ *
+ *  - forwardSucceeded : the coordinates of the sample have been computed
+ *  - inverseSucceeded : positions reaching the coordinates have been computed back
+ *  - inverseValid : the positions computed back are within the limits of the servomotors
+ */
+enum SampleFlags{
+    forwardSucceeded = 1,
+    inverseSucceeded = 2,
+    inverseValid = 4
+};
+
+
+/**
+ * @brief Result of the computations on one sampled configuration
+ *
+ */
+struct WorkspaceSample{
+    std::vector<uint16_t> positions;
+    float coordinates[3];
+    std::vector<uint16_t> inversePositions;
+    float error;
+    uint8_t flags;
+};
+
+/**
+ * @brief Statistics over all the samples of a grid
+ *
+ */
+struct SamplingSummary{
+    uint64_t nbSamples;
+    uint64_t nbForward;
+    uint64_t nbInverse;
+    uint64_t nbValid;
+    double meanError;
+    double maxError;
+};
+
+
+/**
+ * @class WorkspaceSampler
+ * @brief Class sampling the servomotor positions of a device over a regular grid, computing for each configuration its coordinates, the positions computed back from them and the error of this round trip
+ *
+ * The grid is split in blocks whose samples are computed by all the OpenMP threads, each one using its own clone of the converter (see Converter::servoToCoord()).
+ * Blocks are written to the file as soon as they are computed, in the order of the grid, the last servomotor changing first.
+ *
+ * The file starts with a header (identifier, version, number of servomotors, number of samples) followed by one record per sample:
+ * positions (uint16), coordinates (float x 3), positions computed back (uint16), distance between the coordinates and the ones of the positions computed back (float, -1 if not computed) and flags (uint8, see SampleFlags).
+ * The file is written in the byte order of the machine.
+ *
+ */
+class WorkspaceSampler{
+
+    protected:
+        const Converter& converter;
+        std::vector<uint16_t> seed;
+
+
+        /**
+         * @brief Gets the size of the record of a sample in the file
+         *
+         * @param nbServos the number of servomotors
+         * @return int the size in bytes
+         */
+        static int getRecordSize(int nbServos);
+
+
+    public:
+
+        /**
+         * @brief Constructs a new WorkspaceSampler object
+         *
+         * @param conv the converter computing the kinematics, must not be modified while sampling
+         */
+        WorkspaceSampler(const Converter& conv);
+
+        /**
+         * @brief Destroys the WorkspaceSampler object
+         *
+         */
+        virtual ~WorkspaceSampler();
+
+
+        /**
+         * @brief Sets the starting point of the inverse kinematics of every sample, the middle of the sampled ranges by default
+         *
+         * @param positions the starting positions, empty to use the middle of the sampled ranges
+         * @throw ComputationError if the size does not match the converter
+         */
+        void setSeed(const std::vector<uint16_t>& positions);
+
+
+        /**
+         * @brief Samples the grid and writes the results to a file
+         *
+         * @param minPositions the first position sampled for each servomotor
+         * @param maxPositions the last position that can be sampled for each servomotor
+         * @param strides the step between two sampled positions of each servomotor
+         * @param fileName the name of the output file
+         * @return SamplingSummary the statistics over all the samples
+         * @throw ComputationError if the parameters do not match the converter
+         * @throw FileError if the file cannot be written
+         */
+        SamplingSummary sample(const std::vector<uint16_t>& minPositions, const std::vector<uint16_t>& maxPositions, const std::vector<uint16_t>& strides, const std::string& fileName) const;
+
+
+        /**
+         * @brief Reads all the samples of a file
+         *
+         * @param fileName the name of the file
+         * @return std::vector<WorkspaceSample> the samples, in the order of the grid
+         * @throw FileError if the file cannot be read or is not a sample file
+         */
+        static std::vector<WorkspaceSample> load(const std::string& fileName);
+
+};
+
+    }
+}
+
+#endif
@@ -14,30 +14,239 @@
 
 #include <iterator>
 #include <thread>
+#include <mutex>
+#include <string>
+#include <cstdint>
 
 #include "abstractcontroller.h"
+#include "collisionchecker.h"
+#include "mappedfile.h"
 #include "trajectoryerror.h"
+#include "fileerror.h"
 
 namespace armlearn {
 
+
+// Identifier written at the beginning of the trajectory files
+#define TRAJECTORY_FILE_MAGIC "ARMTRJ\0"
+
+// Version of the trajectory file format
+#define TRAJECTORY_FILE_VERSION 2
+
+// Suffix of the temporary file written by Trajectory::save() before replacing the saved file
+#define TRAJECTORY_TEMP_SUFFIX ".tmp"
+
+// Largest number of backward and forward passes of the planner over the corners, every point being a stop if their speeds are still not found
+#define BLEND_MAX_PASSES 100
+
+// Largest number of segments merged into one by the planner, the points in between being passed within their tolerance
+#define BLEND_LOOKAHEAD 32
+
+
+/**
+ * @brief Velocity profile followed by the servomotors between two points of a timed trajectory
+ * 
+ *  - trapezoidalProfile : constant acceleration up to the cruise speed, then constant deceleration, the acceleration being discontinuous
+ *  - sCurveProfile : acceleration rising and falling as a squared sine, continuous but twice as long for the same peak acceleration
+ */
+enum VelocityProfile{
+    trapezoidalProfile,
+    sCurveProfile
+};
+
+
+/**
+ * @brief Timing of a segment of a trajectory, the progress along the segment going from 0 to 1
+ * 
+ * The segment goes through a blend at its first point, an acceleration, a constant speed phase, a deceleration and a blend at its last point, the blends overlapping the previous and next segments.
+ * 
+ *  - duration : the time taken by the segment, in seconds
+ *  - blendIn : the time taken by the blend at the first point, in seconds, 0 if the segment starts at rest
+ *  - speedIn : the speed of the progress at the end of the first blend, per second
+ *  - rampIn : the time taken by the acceleration, in seconds
+ *  - speed : the cruise speed of the progress, per second
+ *  - rampOut : the time taken by the deceleration, in seconds
+ *  - speedOut : the speed of the progress at the beginning of the last blend, per second
+ *  - blendOut : the time taken by the blend at the last point, in seconds, 0 if the segment ends at rest
+ */
+struct SegmentTiming{
+    double duration;
+    double blendIn;
+    double speedIn;
+    double rampIn;
+    double speed;
+    double rampOut;
+    double speedOut;
+    double blendOut;
+};
+
+
 /**
  * @class Trajectory
  * @brief class Trajectory
  * 
+ * Once the speed and acceleration limits of the servomotors are set (see setTimeLimits()), the trajectory is timed: each segment between two points lasts as long as its slowest servomotor needs, all the servomotors starting and stopping together, and setpoints can be sampled at any time (see sample())
+ * Points given a blend tolerance (see setBlendTolerance()) are not stopped at: the velocity changes from one segment to the next around the point, the corner being rounded within the tolerance.
+ * Consecutive points close enough to a straight line are merged into a single segment, and the speeds of the segments are planned over the whole trajectory so that every tolerance is respected.
+ * Recorded trajectories can instead be timed by the time of each point (see addTimedPoint()), the servomotors moving at constant speed between two points.
+ * A timed trajectory can be executed without stopping at each point by a TrajectoryExecutor, executeTrajectory() waiting for the device to reach each point
+ * 
+ * The points are stored contiguously, one after the other. A saved trajectory is mapped in memory when loaded, so that it is available immediately whatever its size, and is copied only when modified.
+ * The file is written in the byte order of the machine saving it.
+ * 
  */
 class Trajectory{
 
     private:
+
+        /**
+         * @brief Description of the trajectory, written at the beginning of the trajectory files
+         * 
+         * Followed by the speed then acceleration limits of each servomotor if the trajectory is timed by limits, the time of each point if it is timed, the blend tolerance of each point if stored and the positions of each point
+         */
+        struct Header{
+            char magic[8];
+            uint32_t version;
+            uint32_t nbServos;
+            uint64_t nbPoints;
+            uint32_t timing; // 0 if not timed, 1 if timed by limits, 2 if timed by the time of each point
+            uint32_t profile;
+            uint32_t blended; // 1 if the blend tolerance of each point is stored
+            uint32_t reserved;
+        };
+
         communication::AbstractController* device;
-        std::vector<std::vector<uint16_t>*>* trajectories;
-        // TODO: add time management (pauses during execution, varying speed of servomotors, ...)
+        kinematics::CollisionChecker* checker;
+
+        uint32_t nbServos;
+        uint64_t nbPoints;
+        std::vector<uint16_t> pointData;
+        mutable std::vector<double> timeData;
+        MappedFile* mapped;
+
+        const uint16_t* points;
+        mutable const double* times;
+
+        std::vector<double> maxSpeeds;
+        std::vector<double> maxAccelerations;
+        VelocityProfile profile;
+        mutable std::vector<SegmentTiming> timings;
+        std::vector<double> tolerances;
+        mutable std::vector<uint64_t> corners;
+
+        mutable bool planPending;
+        mutable std::mutex planLock;
         
 
+        /**
+         * @brief Copies the points and times of a mapped trajectory so that they can be modified, nothing being done if the trajectory is not mapped
+         * 
+         */
+        void own();
+
+        /**
+         * @brief Points the views of the trajectory to its stored points and times, after a modification
+         * 
+         */
+        void updateViews();
+
+        /**
+         * @brief Checks that a point can be added to the trajectory
+         * 
+         * @param point the point to add
+         * @throw TrajectoryError if the point does not match the number of servomotors of the trajectory or of its limits
+         */
+        void checkPoint(const std::vector<uint16_t>& point) const;
+
+        /**
+         * @brief Gets a point as a vector
+         * 
+         * @param pos the position of the point in the trajectory
+         * @return std::vector<uint16_t> a copy of the point
+         */
+        std::vector<uint16_t> pointAt(uint64_t pos) const;
+
+        /**
+         * @brief Computes the timing of a segment from the limits of the servomotors
+         * 
+         * @param segment the index of the segment, between the points segment and segment + 1
+         * @return SegmentTiming the fastest timing respecting the limits of every servomotor
+         */
+        SegmentTiming timeSegment(int segment) const;
+
+        /**
+         * @brief Computes again the timing of the segments in a range and the time of every following point, after a modification of the trajectory timed by limits
+         * 
+         * If a point has a blend tolerance, the whole trajectory is instead planned again at the next query of its timing (see update()), so that successive modifications are planned once.
+         * 
+         * @param first the first segment to compute again
+         * @param last the last segment to compute again, included
+         */
+        void retime(int first, int last);
+
+        /**
+         * @brief Computes the timing of the segments in a range, stopping at every point, and the time of every following point
+         * 
+         * @param first the first segment to compute again
+         * @param last the last segment to compute again, included, every segment being computed again if the previous timing was planned with blends
+         */
+        void timeSegments(int first, int last) const;
+
+        /**
+         * @brief Plans the trajectory if it was modified since its last plan (see retime()), called by the queries of its timing
+         * 
+         * The trajectory stops at every point if the tolerances cannot be respected.
+         * 
+         */
+        void update() const;
+
+        /**
+         * @brief Computes the distance between a point and the straight segment joining two other points
+         * 
+         * @param first the position of the first point of the segment in the trajectory
+         * @param last the position of the last point of the segment in the trajectory
+         * @param pos the position of the point in the trajectory
+         * @param ratio output progress along the segment of the projection of the point, from 0 to 1
+         * @return double the largest distance of the servomotors between the point and its projection, in servomotor unit
+         */
+        double chordDistance(uint64_t first, uint64_t last, uint64_t pos, double& ratio) const;
+
+        /**
+         * @brief Plans the timing of the whole trajectory timed by limits, blending the points with a tolerance
+         * 
+         * The points within half their tolerance of the segment joining the points around them are merged into this segment, up to BLEND_LOOKAHEAD segments, the other points being the corners of the trajectory.
+         * Each corner is passed at the highest speed keeping its blend within the tolerance left by the corner and the merged points, then the speeds at the corners are lowered by backward and forward passes until each segment can change from one to the other between its blends.
+         * 
+         * @return true if the speeds at the corners are found
+         * @return false if they are still not found after BLEND_MAX_PASSES passes, the timing being unchanged
+         */
+        bool plan() const;
+
+        /**
+         * @brief Computes the progress along a segment at a given time
+         * 
+         * @param timing the timing of the segment
+         * @param time the time elapsed since the beginning of the segment, in seconds
+         * @return double the progress, 0 before the segment and 1 after it
+         */
+        double progress(const SegmentTiming& timing, double time) const;
+
+        /**
+         * @brief Computes the progress made while the speed changes following the velocity profile
+         * 
+         * @param from the speed of the progress at the beginning of the change, per second
+         * @param to the speed of the progress at the end of the change, per second
+         * @param duration the time taken by the change, in seconds
+         * @param time the time elapsed since the beginning of the change, in seconds
+         * @return double the progress made since the beginning of the change
+         */
+        double transition(double from, double to, double duration, double time) const;
+
         /**
          * @brief Move to designed point
          * 
          * @param point the point to go to
-         * @throw TrajectoryError if no feedback comes from the device after execution
+         * @throw TrajectoryError if no feedback comes from the device after execution or if the point makes the arm collide
          */
         void move(const std::vector<uint16_t>& point) const;
 
@@ -50,6 +259,15 @@ class Trajectory{
          */
         Trajectory(communication::AbstractController* toDevice);
 
+        /**
+         * @brief Constructs a new Trajectory object from a trajectory file (see load())
+         * 
+         * @param toDevice pointer to the Controller device to send the trajectories to, does not create it
+         * @param fileName the name of the file
+         * @throw FileError if the file cannot be mapped or is not a valid trajectory
+         */
+        Trajectory(communication::AbstractController* toDevice, const std::string& fileName);
+
         /**
          * @brief Destroys the Trajectory:: Trajectory object
          * 
@@ -57,12 +275,33 @@ class Trajectory{
          */
         virtual ~Trajectory();
 
+        Trajectory(const Trajectory&) = delete;
+        Trajectory& operator=(const Trajectory&) = delete;
+
+
+        /**
+         * @brief Sets a collision checker verifying each point before sending it to the device
+         * 
+         * @param collisionChecker pointer to the checker, built for the same device, does not create it, nullptr to disable verifications
+         */
+        void setCollisionChecker(kinematics::CollisionChecker* collisionChecker);
+
+        /**
+         * @brief Checks whether a point of the trajectory makes the arm collide with itself or its workspace
+         * 
+         * @param pos the position of the point in the trajectory
+         * @return true if a collision checker is set and detects a collision
+         * @return false otherwise
+         */
+        bool pointCollides(int pos) const;
+
 
         /**
          * @brief Adds a point to the trajectory at a specified position
          * 
          * @param point the coordinates of the servomotors
          * @param pos the position in the trajectory to put the point
+         * @throw TrajectoryError if the point does not match the number of servomotors of the trajectory or if the trajectory is timed by the time of each point
          */
         void addPoint(const std::vector<uint16_t>& point, int pos);
 
@@ -70,9 +309,19 @@ class Trajectory{
          * @brief Adds a point to the end of the trajectory
          * 
          * @param point the coordinates of the servomotors
+         * @throw TrajectoryError if the point does not match the number of servomotors of the trajectory or if the trajectory is timed by the time of each point
          */
         void addPoint(const std::vector<uint16_t>& point);
 
+        /**
+         * @brief Adds a point to the end of a trajectory timed by the time of each point, as a recorded trajectory
+         * 
+         * @param point the coordinates of the servomotors
+         * @param time the time of the point, in seconds, not before the time of the last point
+         * @throw TrajectoryError if the trajectory contains points without time or is timed by limits, if the time is before the last point or if the point does not match the number of servomotors of the trajectory
+         */
+        void addTimedPoint(const std::vector<uint16_t>& point, double time);
+
         /**
          * @brief Removes a point from the trajectory
          * 
@@ -87,6 +336,133 @@ class Trajectory{
         void removePoint();
 
 
+        /**
+         * @brief Removes every point and the timing of the trajectory
+         * 
+         */
+        void clear();
+
+
+        /**
+         * @brief Sets the blend tolerance of a point
+         * 
+         * A point with a tolerance is passed without stopping when the trajectory is timed by limits, the setpoints staying within the tolerance of the point for each servomotor. The first and last points are always stopped at.
+         * 
+         * @param pos the position of the point in the trajectory
+         * @param tolerance the largest distance between the setpoints and the point, in servomotor unit, 0 to stop at the point
+         * @throw TrajectoryError if the tolerance is negative
+         */
+        void setBlendTolerance(int pos, double tolerance);
+
+        /**
+         * @brief Sets the blend tolerance of every point of the trajectory, the points added afterwards being stopped at
+         * 
+         * @param tolerance the largest distance between the setpoints and each point, in servomotor unit, 0 to stop at every point
+         * @throw TrajectoryError if the tolerance is negative
+         */
+        void setBlendTolerance(double tolerance);
+
+        /**
+         * @brief Gets the blend tolerance of a point
+         * 
+         * @param pos the position of the point in the trajectory
+         * @return double the tolerance, in servomotor unit, 0 if the trajectory stops at the point
+         */
+        double getBlendTolerance(int pos) const;
+
+
+        /**
+         * @brief Gets the number of points of the trajectory
+         * 
+         * @return uint64_t the number of points
+         */
+        uint64_t getNbPoints() const;
+
+        /**
+         * @brief Gets the number of servomotors of each point
+         * 
+         * @return int the number of positions of each point, 0 if the trajectory is empty and not timed by limits
+         */
+        int getNbServos() const;
+
+        /**
+         * @brief Gets a point of the trajectory, without copying it
+         * 
+         * @param pos the position of the point in the trajectory
+         * @return const uint16_t* the getNbServos() positions of the point, valid until the trajectory is modified
+         */
+        const uint16_t* getPoint(uint64_t pos) const;
+
+
+        /**
+         * @brief Saves the trajectory, its points and timing, in a binary file
+         * 
+         * The file is written next to the saved one then renamed over it, so that a trajectory can be saved to the file it was loaded from and an existing file is never left half written.
+         * 
+         * @param fileName the name of the file
+         * @throw FileError if the file cannot be written
+         */
+        void save(const std::string& fileName) const;
+
+        /**
+         * @brief Replaces the trajectory by the content of a file written by save(), mapped in memory without being copied
+         * 
+         * A trajectory timed by limits is timed again from the points, in a time proportional to their number.
+         * 
+         * @param fileName the name of the file
+         * @throw FileError if the file cannot be mapped or is not a valid trajectory, the trajectory being then empty
+         */
+        void load(const std::string& fileName);
+
+
+        /**
+         * @brief Sets the speed and acceleration limits of the servomotors, timing the trajectory
+         * 
+         * Replaces the time of each point of a recorded trajectory.
+         * 
+         * @param speeds the largest speed of each servomotor, in servomotor unit per second
+         * @param accelerations the largest acceleration of each servomotor, in servomotor unit per squared second
+         * @param velocityProfile the profile followed between two points (see VelocityProfile enum for more details)
+         * @throw TrajectoryError if the limits are not strictly positive, are not of the same size or do not match the number of servomotors of the trajectory
+         */
+        void setTimeLimits(const std::vector<double>& speeds, const std::vector<double>& accelerations, VelocityProfile velocityProfile = trapezoidalProfile);
+
+        /**
+         * @brief Checks whether the trajectory is timed
+         * 
+         * @return true if the limits of the servomotors are set or each point has a time
+         * @return false otherwise
+         */
+        bool isTimed() const;
+
+        /**
+         * @brief Gets the duration of a segment of the trajectory
+         * 
+         * @param segment the index of the segment, between the points segment and segment + 1
+         * @return double the time between the two points, in seconds, from the beginning of the blend of a point passed without stopping
+         * @throw TrajectoryError if the trajectory is not timed
+         */
+        double getSegmentDuration(int segment) const;
+
+        /**
+         * @brief Gets the duration of the whole trajectory
+         * 
+         * @return double the duration, in seconds, 0 if there is less than 2 points
+         * @throw TrajectoryError if the trajectory is not timed
+         */
+        double getDuration() const;
+
+        /**
+         * @brief Computes the setpoint of the servomotors at a given time
+         * 
+         * @param time the time elapsed since the beginning of the trajectory, in seconds, clamped to its duration
+         * @param setpoint output positions of the servomotors, not rounded
+         * @param reverse if true, samples the trajectory from its last point, the timing being the same in both directions
+         * @throw TrajectoryError if the trajectory is not timed or is empty
+         */
+        void sample(double time, std::vector<double>& setpoint, bool reverse = false) const;
+
+
         /**
          * @brief Initializes the position of the device to the first position stored
          * 
@@ -0,0 +1,133 @@
+/**
+ * @file trajectoryexecutor.h
+ * @author Gaël Gendron (gael.gendron@insa-rennes.fr)
+ * @brief File containing the TrajectoryExecutor class, streaming the setpoints of a timed trajectory to a device
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+
+#ifndef TRAJECTORYEXECUTOR_H
+#define TRAJECTORYEXECUTOR_H
+
+#include <vector>
+#include <cstdint>
+
+#include "trajectory.h"
+
+namespace armlearn {
+
+
+// Default rate at which the setpoints are sent to the device, in Hz
+#define EXECUTOR_RATE 100
+
+// Default largest distance between the last setpoint and the position of a servomotor before the execution is aborted, in servomotor unit
+#define EXECUTOR_MAX_DEVIATION 200
+
+// Positions per second travelled at one unit of speed of the servomotors (SPEED_UNIT rpm, a turn being 4096 positions)
+#define EXECUTOR_SPEED_SCALE (SPEED_UNIT * 4096 / 60)
+
+
+/**
+ * @brief Summary of the execution of a trajectory (see TrajectoryExecutor::execute())
+ *
+ *  - nbSetpoints : the number of setpoints sent to the device
+ *  - nbLate : the number of setpoints sent after their deadline, the rate being too high for the device
+ *  - maxDeviation : the largest distance between a setpoint and the position of a servomotor at the next period, in servomotor unit
+ *  - duration : the time taken by the execution, final convergence included, in seconds
+ */
+struct ExecutionSummary{
+    uint64_t nbSetpoints;
+    uint64_t nbLate;
+    double maxDeviation;
+    double duration;
+};
+
+
+/**
+ * @class TrajectoryExecutor
+ * @brief Executes timed trajectories (see Trajectory::setTimeLimits()) by streaming their setpoints to a device at a fixed rate, without waiting for each one to be reached
+ *
+ * At each period, the setpoint of the next period is sent with the speed needed to reach it in time (speed feed-forward), so that the device moves continuously instead of stopping at each point.
+ * The points of the trajectory with a blend tolerance (see Trajectory::setBlendTolerance()) are passed without stopping, the corners being rounded.
+ * The position of the device is read back at each period and the execution is aborted if it deviates too much from the setpoints, the device then holding its position.
+ *
+ */
+class TrajectoryExecutor{
+
+    protected:
+        communication::AbstractController* device;
+        kinematics::CollisionChecker* checker;
+
+        double rate;
+        double maxDeviation;
+        bool feedForward;
+
+
+    public:
+
+        /**
+         * @brief Constructs a new TrajectoryExecutor object
+         *
+         * @param toDevice pointer to the Controller device to send the setpoints to, does not create it
+         */
+        TrajectoryExecutor(communication::AbstractController* toDevice);
+
+        /**
+         * @brief Destroys the TrajectoryExecutor object
+         *
+         * Does not delete the controller
+         */
+        virtual ~TrajectoryExecutor();
+
+
+        /**
+         * @brief Sets the rate at which the setpoints are sent, EXECUTOR_RATE by default
+         *
+         * @param frequency the number of setpoints sent per second
+         * @throw TrajectoryError if the rate is not strictly positive
+         */
+        void setRate(double frequency);
+
+        /**
+         * @brief Sets the largest deviation allowed before aborting the execution, EXECUTOR_MAX_DEVIATION by default
+         *
+         * @param deviation the largest distance between the last setpoint and the position of any servomotor, in servomotor unit
+         * @throw TrajectoryError if the deviation is not strictly positive
+         */
+        void setMaxDeviation(double deviation);
+
+        /**
+         * @brief Enables or disables the speed feed-forward, enabled by default
+         *
+         * @param enable if true, the speed of each servomotor is set at each period to reach the next setpoint in time, otherwise the speeds are not modified
+         */
+        void setFeedForward(bool enable);
+
+        /**
+         * @brief Sets a collision checker verifying each setpoint before sending it to the device
+         *
+         * @param collisionChecker pointer to the checker, built for the same device, does not create it, nullptr to disable verifications
+         */
+        void setCollisionChecker(kinematics::CollisionChecker* collisionChecker);
+
+
+        /**
+         * @brief Executes a timed trajectory, the device being expected at its first point (see Trajectory::init())
+         *
+         * Blocks for the duration of the trajectory, then waits for the device to reach the last point. The speeds of the servomotors are restored afterwards, if they have been set before.
+         *
+         * @param trajectory the trajectory to execute
+         * @param reverse if true, executes the trajectory from its last point
+         * @return ExecutionSummary the summary of the execution
+         * @throw TrajectoryError if the trajectory is not timed or does not match the device, if the device deviates too much from the setpoints, if a setpoint makes the device collide or if the device fails
+         */
+        ExecutionSummary execute(const Trajectory& trajectory, bool reverse = false);
+
+};
+
+}
+
+#endif
@@ -0,0 +1,78 @@
+/**
+ * @file mappedfile.h
+ * @author Gaël Gendron (gael.gendron@insa-rennes.fr)
+ * @brief File containing the MappedFile class, giving a read-only view of a file mapped in memory
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <string>
+#include <sstream>
+#include <cstddef>
+
+#include "fileerror.h"
+
+namespace armlearn {
+
+
+/**
+ * @class MappedFile
+ * @brief Read-only view of a whole file, mapped in memory without being copied
+ *
+ * Pages are loaded by the system on first access, opening a large file is immediate.
+ * The view stays valid as long as the object exists.
+ *
+ */
+class MappedFile{
+
+    protected:
+        int descriptor;
+        void* data;
+        size_t size;
+
+    public:
+
+        /**
+         * @brief Constructs a new MappedFile object, mapping the file in memory
+         *
+         * @param fileName the name of the file to map
+         * @throw FileError if the file cannot be opened or mapped
+         */
+        MappedFile(const std::string& fileName);
+
+        /**
+         * @brief Destroys the MappedFile object, unmapping the file
+         *
+         */
+        virtual ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+
+        /**
+         * @brief Gets the content of the file
+         *
+         * @return const void* pointer to the first byte of the file
+         */
+        const void* getData() const;
+
+        /**
+         * @brief Gets the size of the file
+         *
+         * @return size_t the number of bytes of the file
+         */
+        size_t getSize() const;
+
+};
+
+}
+
+#endif
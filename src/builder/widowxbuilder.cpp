@@ -25,11 +25,12 @@ void WidowXBuilder::buildController(communication::AbstractController& controlle
 }
 
 void WidowXBuilder::buildConverter(kinematics::Converter& converter){
-    converter.addServo("base", kinematics::rotZ, 0, 0, 125, 0, 0, M_PI);
-	converter.addServo("shoulder", kinematics::rotX, 0, -49, 142, M_PI/2, 0, M_PI); // Add 90° because of the orientation of the elbow servomotor
-	converter.addServo("elbow", kinematics::rotX, 0, 0, 142);
-	converter.addServo("wristAngle", kinematics::rotX, 0, 0, 74);
-	converter.addServo("wristRotate", kinematics::rotZ, 0, 0, 41);
-	converter.addServo("gripper", kinematics::rotZ, 0, 0, 40);
+    kinematics::WidowXChain::build(converter);
+
+	converter.setServoLimits({BASE_MIN, SHOULDER_MIN, ELBOW_MIN, WRISTANGLE_MIN, WRISTROTATE_MIN, GRIPPER_MIN}, {BASE_MAX, SHOULDER_MAX, ELBOW_MAX, WRISTANGLE_MAX, WRISTROTATE_MAX, GRIPPER_MAX});
 }
 
+void WidowXBuilder::buildCollisionChecker(kinematics::CollisionChecker& checker){
+    const double linkRadii[kinematics::WidowXChain::nbSegments] = {20, 20, 20, 20, 15, 25}; // Radius small enough to fold the arm in sleep position
+    kinematics::WidowXChain::build(checker, linkRadii);
+}
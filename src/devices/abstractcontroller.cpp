@@ -55,6 +55,15 @@ bool AbstractController::removeMotor(uint8_t id){
     return true;
 }
 
+std::vector<uint8_t> AbstractController::getMotorIds() const{
+    std::vector<uint8_t> res;
+    for(auto ptr=motors->cbegin(); ptr != motors->cend(); ptr++){  
+        res.push_back(ptr->first);
+    }
+
+    return res;
+}
+
 
 void AbstractController::changeSpeed(uint16_t newSpeed){
     for(auto ptr=motors->begin(); ptr != motors->end(); ptr++){ 
@@ -146,6 +146,7 @@ bool ArmSimulator::enableTorque(int id, bool enable){
     if(!getMotor(id, ptr)) return false;
 
     ptr->setStatus(enable ? activated : connected);
+    return true;
 }
 
 bool ArmSimulator::torqueEnabled(int id){
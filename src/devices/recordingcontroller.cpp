@@ -0,0 +1,203 @@
+/**
+ * @copyright Copyright (c) 2019
+ */
+
+
+#include <algorithm>
+
+#include "recordingcontroller.h"
+
+using namespace armlearn;
+using namespace communication;
+
+RecordingController::RecordingController(AbstractController* controller, const std::string& fileName, DisplayMode displayMode, std::ostream& out):AbstractController(displayMode, out), device(controller), log(fileName){
+    for(uint8_t id : device->getMotorIds()){
+        const Servomotor* servo = device->showServomotor(id);
+
+        AbstractController::addMotor(id, servo->getName(), servo->getType());
+        write(motorDeclaration, id, servo->getType(), returnedTrue, servo->getName());
+        synchronize(id);
+    }
+}
+
+RecordingController::~RecordingController(){
+    log.flush();
+}
+
+
+void RecordingController::write(RecordType type, uint8_t id, int32_t value, RecordOutcome outcome, const std::string& text){
+    SessionRecord rec;
+    rec.type = type;
+    rec.id = id;
+    rec.value = value;
+    rec.outcome = outcome;
+    rec.text = text;
+
+    log.write(rec);
+}
+
+bool RecordingController::record(RecordType type, uint8_t id, int32_t value, const std::function<bool()>& command, const std::string& text){
+    bool res;
+    try{
+        res = command();
+    }catch(IdError& e){
+        write(type, id, value, idErrorThrown, e.what());
+        throw;
+    }catch(OutOfRangeError& e){
+        write(type, id, value, outOfRangeErrorThrown, e.what());
+        throw;
+    }catch(ConnectionError& e){
+        write(type, id, value, connectionErrorThrown, e.what());
+        throw;
+    }catch(std::exception& e){
+        write(type, id, value, otherErrorThrown, e.what());
+        throw;
+    }
+
+    write(type, id, value, res ? returnedTrue : returnedFalse, text);
+    return res;
+}
+
+
+void RecordingController::synchronize(uint8_t id){
+    auto mirror = motors->find(id);
+    if(mirror == motors->end()) return;
+
+    std::vector<uint8_t> ids = device->getMotorIds();
+    if(std::find(ids.begin(), ids.end(), id) == ids.end()) return;
+
+    const Servomotor* servo = device->showServomotor(id);
+    Servomotor* ptr = mirror->second;
+
+    if(servo->getStatus() != ptr->getStatus()){
+        ptr->setStatus(servo->getStatus());
+        write(statusUpdate, id, servo->getStatus());
+    }
+    ptr->setLED(servo->getLED());
+    ptr->setTargetSpeed(servo->getTargetSpeed());
+    ptr->setTargetPosition(servo->getTargetPosition());
+}
+
+void RecordingController::synchronize(){
+    for(auto ptr = motors->cbegin(); ptr != motors->cend(); ptr++){
+        synchronize(ptr->first);
+    }
+}
+
+
+
+void RecordingController::connect(){
+    record(connectCommand, 0, 0, [this](){ device->connect(); return true; });
+    synchronize();
+}
+
+void RecordingController::ping(uint8_t id){
+    record(pingCommand, id, 0, [this, id](){ device->ping(id); return true; });
+}
+
+
+bool RecordingController::addMotor(uint8_t id, const std::string& name, Type type){
+    bool res = record(addMotorCommand, id, type, [this, id, &name, type](){ return device->addMotor(id, name, type); }, name);
+    if(res){
+        AbstractController::addMotor(id, name, type);
+        synchronize(id);
+    }
+
+    return res;
+}
+
+bool RecordingController::removeMotor(uint8_t id){
+    bool res = record(removeMotorCommand, id, 0, [this, id](){ return device->removeMotor(id); });
+    if(res) AbstractController::removeMotor(id);
+
+    return res;
+}
+
+bool RecordingController::changeId(uint8_t oldId, uint8_t newId){
+    bool res = record(changeIdCommand, oldId, newId, [this, oldId, newId](){ return device->changeId(oldId, newId); });
+    if(res){
+        auto ptr = motors->find(oldId);
+        Servomotor* servo = ptr->second;
+        servo->setId(newId);
+
+        motors->erase(ptr);
+        motors->insert(std::pair<int, Servomotor*>(newId, servo));
+        synchronize(newId);
+    }
+
+    return res;
+}
+
+bool RecordingController::turnLED(uint8_t id, bool on){
+    bool res = record(turnLEDCommand, id, on, [this, id, on](){ return device->turnLED(id, on); });
+    synchronize(id);
+
+    return res;
+}
+
+bool RecordingController::turnLED(uint8_t id){
+    bool res = record(toggleLEDCommand, id, 0, [this, id](){ return device->turnLED(id); });
+    synchronize(id);
+
+    return res;
+}
+
+
+bool RecordingController::changeSpeed(uint8_t id, uint16_t newSpeed){
+    bool res = record(changeSpeedCommand, id, newSpeed, [this, id, newSpeed](){ return device->changeSpeed(id, newSpeed); });
+    synchronize(id);
+
+    return res;
+}
+
+bool RecordingController::setPosition(uint8_t id, uint16_t newPosition){
+    bool res = record(setPositionCommand, id, newPosition, [this, id, newPosition](){ return device->setPosition(id, newPosition); });
+    synchronize(id);
+
+    return res;
+}
+
+bool RecordingController::addPosition(uint8_t id, int dx){
+    bool res = record(addPositionCommand, id, dx, [this, id, dx](){ return device->addPosition(id, dx); });
+    synchronize(id);
+
+    return res;
+}
+
+
+bool RecordingController::enableTorque(int id, bool enable){
+    bool res = record(enableTorqueCommand, id, enable, [this, id, enable](){ return device->enableTorque(id, enable); });
+    synchronize(id);
+
+    return res;
+}
+
+bool RecordingController::torqueEnabled(int id){
+    return record(torqueEnabledCommand, id, 0, [this, id](){ return device->torqueEnabled(id); });
+}
+
+
+bool RecordingController::updateInfos(uint8_t id){
+    bool res = record(updateInfosCommand, id, 0, [this, id](){ return device->updateInfos(id); });
+
+    auto mirror = motors->find(id);
+    if(res && mirror != motors->end()){
+        SessionRecord rec;
+        rec.type = stateUpdate;
+        rec.id = id;
+        rec.value = 0;
+        rec.outcome = returnedTrue;
+        rec.infos = device->showServomotor(id)->getInfos();
+        log.write(rec);
+
+        mirror->second->setInfos(rec.infos);
+    }
+    synchronize(id);
+
+    return res;
+}
+
+
+void RecordingController::flush(){
+    log.flush();
+}
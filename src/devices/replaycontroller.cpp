@@ -0,0 +1,235 @@
+/**
+ * @copyright Copyright (c) 2019
+ */
+
+
+#include "replaycontroller.h"
+
+using namespace armlearn;
+using namespace communication;
+
+ReplayController::ReplayController(const std::string& fileName, bool replayInRealTime, DisplayMode displayMode, std::ostream& out):AbstractController(displayMode, out), log(fileName), recordsLeft(false), realTime(replayInRealTime){
+    advance();
+    while(recordsLeft && nextRecord.type == motorDeclaration){
+        AbstractController::addMotor(nextRecord.id, nextRecord.text, (Type) nextRecord.value);
+        advance();
+        applyUpdates();
+    }
+
+    startTime = std::chrono::steady_clock::now();
+}
+
+ReplayController::~ReplayController(){
+
+}
+
+
+void ReplayController::advance(){
+    recordsLeft = log.next(nextRecord);
+}
+
+Servomotor* ReplayController::findMotor(uint8_t id) const{
+    auto it = motors->find(id);
+    return it == motors->end() ? nullptr : it->second;
+}
+
+bool ReplayController::expect(RecordType type, uint8_t id, int32_t value, RecordOutcome& outcome, std::string& text){
+    if(!recordsLeft || nextRecord.type != type || nextRecord.id != id || nextRecord.value != value){
+        std::stringstream disp;
+        disp << "Command " << type << " on ID " << (int) id << " with value " << value << " does not match the session log";
+        if(recordsLeft) disp << " (expected command " << nextRecord.type << " on ID " << (int) nextRecord.id << " with value " << nextRecord.value << ")";
+        else disp << " (end of log reached)";
+
+        if(mode & print) output << disp.str() << std::endl;
+        if(mode & except) throw ConnectionError(disp.str());
+        return false;
+    }
+
+    if(realTime) std::this_thread::sleep_until(startTime + std::chrono::microseconds(nextRecord.time));
+
+    outcome = nextRecord.outcome;
+    text = nextRecord.text;
+    advance();
+
+    return true;
+}
+
+void ReplayController::applyUpdates(){
+    while(recordsLeft && (nextRecord.type == statusUpdate || nextRecord.type == stateUpdate)){
+        Servomotor* ptr = findMotor(nextRecord.id);
+        if(ptr != nullptr){
+            if(nextRecord.type == statusUpdate) ptr->setStatus((Status) nextRecord.value);
+            else ptr->setInfos(nextRecord.infos);
+        }
+
+        advance();
+    }
+}
+
+void ReplayController::rethrow(RecordOutcome outcome, const std::string& text) const{
+    switch(outcome){
+        case idErrorThrown:
+            throw IdError(text);
+
+        case outOfRangeErrorThrown:
+            throw OutOfRangeError(text);
+
+        case connectionErrorThrown:
+            throw ConnectionError(text);
+
+        case otherErrorThrown:
+            throw std::runtime_error(text);
+
+        default:
+            break;
+    }
+}
+
+bool ReplayController::replay(RecordType type, uint8_t id, int32_t value){
+    RecordOutcome outcome;
+    std::string text;
+    if(!expect(type, id, value, outcome, text)) return false;
+
+    applyUpdates();
+    rethrow(outcome, text);
+
+    return outcome == returnedTrue;
+}
+
+
+bool ReplayController::finished() const{
+    return !recordsLeft;
+}
+
+
+
+void ReplayController::connect(){
+    replay(connectCommand, 0, 0);
+}
+
+void ReplayController::ping(uint8_t id){
+    replay(pingCommand, id, 0);
+}
+
+
+bool ReplayController::addMotor(uint8_t id, const std::string& name, Type type){
+    RecordOutcome outcome;
+    std::string text;
+    if(!expect(addMotorCommand, id, type, outcome, text)) return false;
+
+    if(outcome == returnedTrue) AbstractController::addMotor(id, name, type);
+    applyUpdates();
+    rethrow(outcome, text);
+
+    return outcome == returnedTrue;
+}
+
+bool ReplayController::removeMotor(uint8_t id){
+    RecordOutcome outcome;
+    std::string text;
+    if(!expect(removeMotorCommand, id, 0, outcome, text)) return false;
+
+    if(outcome == returnedTrue) AbstractController::removeMotor(id);
+    applyUpdates();
+    rethrow(outcome, text);
+
+    return outcome == returnedTrue;
+}
+
+bool ReplayController::changeId(uint8_t oldId, uint8_t newId){
+    RecordOutcome outcome;
+    std::string text;
+    if(!expect(changeIdCommand, oldId, newId, outcome, text)) return false;
+
+    Servomotor* ptr = findMotor(oldId);
+    if(outcome == returnedTrue && ptr != nullptr){
+        ptr->setId(newId);
+
+        motors->erase(motors->find(oldId));
+        motors->insert(std::pair<int, Servomotor*>(newId, ptr));
+    }
+    applyUpdates();
+    rethrow(outcome, text);
+
+    return outcome == returnedTrue;
+}
+
+bool ReplayController::turnLED(uint8_t id, bool on){
+    RecordOutcome outcome;
+    std::string text;
+    if(!expect(turnLEDCommand, id, on, outcome, text)) return false;
+
+    Servomotor* ptr = findMotor(id);
+    if(outcome == returnedTrue && ptr != nullptr) ptr->setLED(on);
+    applyUpdates();
+    rethrow(outcome, text);
+
+    return outcome == returnedTrue;
+}
+
+bool ReplayController::turnLED(uint8_t id){
+    RecordOutcome outcome;
+    std::string text;
+    if(!expect(toggleLEDCommand, id, 0, outcome, text)) return false;
+
+    Servomotor* ptr = findMotor(id);
+    if(outcome == returnedTrue && ptr != nullptr) ptr->setLED(!ptr->getLED());
+    applyUpdates();
+    rethrow(outcome, text);
+
+    return outcome == returnedTrue;
+}
+
+
+bool ReplayController::changeSpeed(uint8_t id, uint16_t newSpeed){
+    RecordOutcome outcome;
+    std::string text;
+    if(!expect(changeSpeedCommand, id, newSpeed, outcome, text)) return false;
+
+    Servomotor* ptr = findMotor(id);
+    if(outcome == returnedTrue && ptr != nullptr) ptr->setTargetSpeed(newSpeed);
+    applyUpdates();
+    rethrow(outcome, text);
+
+    return outcome == returnedTrue;
+}
+
+bool ReplayController::setPosition(uint8_t id, uint16_t newPosition){
+    RecordOutcome outcome;
+    std::string text;
+    if(!expect(setPositionCommand, id, newPosition, outcome, text)) return false;
+
+    Servomotor* ptr = findMotor(id);
+    if(outcome == returnedTrue && ptr != nullptr) ptr->setTargetPosition(newPosition);
+    applyUpdates();
+    rethrow(outcome, text);
+
+    return outcome == returnedTrue;
+}
+
+bool ReplayController::addPosition(uint8_t id, int dx){
+    RecordOutcome outcome;
+    std::string text;
+    if(!expect(addPositionCommand, id, dx, outcome, text)) return false;
+
+    Servomotor* ptr = findMotor(id);
+    if(outcome == returnedTrue && ptr != nullptr) ptr->setTargetPosition(ptr->getTargetPosition() + dx);
+    applyUpdates();
+    rethrow(outcome, text);
+
+    return outcome == returnedTrue;
+}
+
+
+bool ReplayController::enableTorque(int id, bool enable){
+    return replay(enableTorqueCommand, id, enable);
+}
+
+bool ReplayController::torqueEnabled(int id){
+    return replay(torqueEnabledCommand, id, 0);
+}
+
+
+bool ReplayController::updateInfos(uint8_t id){
+    return replay(updateInfosCommand, id, 0);
+}
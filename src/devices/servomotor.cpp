@@ -51,6 +51,14 @@ uint16_t Servomotor::getTargetPosition() const{
     return targetPosition;
 }
 
+uint16_t Servomotor::getMinPosition() const{
+    return posMin;
+}
+
+uint16_t Servomotor::getMaxPosition() const{
+    return posMax;
+}
+
 uint16_t Servomotor::getCurrentPosition() const{
     return position;
 }
@@ -59,6 +67,10 @@ double Servomotor::getTimeSinceUpdate() const{
     return std::chrono::duration<double, std::ratio<1, 1>>(std::chrono::system_clock::now() - lastUpdate).count();
 }
 
+std::vector<uint8_t> Servomotor::getInfos() const{
+    return {(uint8_t) position, (uint8_t) (position >> BYTE_SIZE), (uint8_t) speed, (uint8_t) (speed >> BYTE_SIZE), (uint8_t) load, (uint8_t) (load >> BYTE_SIZE), voltage, temperature, (uint8_t) instructionRegistered, 0, (uint8_t) inMovement};
+}
+
 
 std::string Servomotor::toString() const{
     std::stringstream streamRep;
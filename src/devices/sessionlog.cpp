@@ -0,0 +1,154 @@
+/**
+ * @copyright Copyright (c) 2019
+ */
+
+#include "sessionlog.h"
+
+using namespace armlearn;
+using namespace communication;
+
+
+/**
+ * @brief Checks if a record carries a text
+ *
+ */
+static inline bool hasText(const SessionRecord& record){
+    return record.type == motorDeclaration || record.type == addMotorCommand || record.outcome > returnedTrue;
+}
+
+
+
+SessionLogWriter::SessionLogWriter(const std::string& fileName):file(fileName, std::ios::out | std::ios::binary | std::ios::trunc), lastTime(0){
+    if(!file.is_open()){
+        std::stringstream errMsg;
+        errMsg << "Error while opening session log " << fileName;
+
+        throw FileError(errMsg.str());
+    }
+
+    file.write(SESSION_LOG_MAGIC, sizeof(SESSION_LOG_MAGIC) - 1);
+    file.put((char) SESSION_LOG_VERSION);
+
+    startTime = std::chrono::steady_clock::now();
+}
+
+SessionLogWriter::~SessionLogWriter(){
+    file.close();
+}
+
+
+void SessionLogWriter::writeVarint(uint64_t value){
+    while(value >= 0x80){
+        file.put((char) ((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    file.put((char) value);
+}
+
+void SessionLogWriter::write(SessionRecord& record){
+    if(record.type == stateUpdate && record.infos.size() != READ_LENGTH){
+        std::stringstream errMsg;
+        errMsg << "Error : state update of " << record.infos.size() << " bytes instead of " << READ_LENGTH;
+
+        throw FileError(errMsg.str());
+    }
+
+    record.time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+
+    file.put((char) record.type);
+    writeVarint(record.time - lastTime);
+    file.put((char) record.id);
+    writeVarint(((uint32_t) record.value << 1) ^ (uint32_t) (record.value >> 31)); // Zigzag encoding, small negative values stay small
+    file.put((char) record.outcome);
+
+    if(record.type == stateUpdate) file.write((const char*) record.infos.data(), READ_LENGTH);
+    if(hasText(record)){
+        writeVarint(record.text.size());
+        file.write(record.text.data(), record.text.size());
+    }
+
+    lastTime = record.time;
+}
+
+void SessionLogWriter::flush(){
+    file.flush();
+}
+
+
+
+SessionLogReader::SessionLogReader(const std::string& fileName):file(fileName, std::ios::in | std::ios::binary), lastTime(0){
+    if(!file.is_open()){
+        std::stringstream errMsg;
+        errMsg << "Error while opening session log " << fileName;
+
+        throw FileError(errMsg.str());
+    }
+
+    char header[sizeof(SESSION_LOG_MAGIC)];
+    file.read(header, sizeof(SESSION_LOG_MAGIC));
+    if(!file || std::string(header, sizeof(SESSION_LOG_MAGIC) - 1) != SESSION_LOG_MAGIC || header[sizeof(SESSION_LOG_MAGIC) - 1] != SESSION_LOG_VERSION){
+        std::stringstream errMsg;
+        errMsg << "File " << fileName << " is not a session log of version " << SESSION_LOG_VERSION;
+
+        throw FileError(errMsg.str());
+    }
+}
+
+SessionLogReader::~SessionLogReader(){
+    file.close();
+}
+
+
+bool SessionLogReader::readVarint(uint64_t& value){
+    value = 0;
+    int shift = 0;
+    int byte;
+
+    do{
+        byte = file.get();
+        if(byte == EOF) return false;
+
+        value |= ((uint64_t) (byte & 0x7F)) << shift;
+        shift += 7;
+    }while(byte & 0x80);
+
+    return true;
+}
+
+bool SessionLogReader::next(SessionRecord& record){
+    int type = file.get();
+    if(type == EOF) return false;
+
+    uint64_t elapsed, value;
+    int id, outcome;
+
+    bool correct = readVarint(elapsed);
+    correct = correct && (id = file.get()) != EOF;
+    correct = correct && readVarint(value);
+    correct = correct && (outcome = file.get()) != EOF;
+    if(!correct) throw FileError("Session log truncated");
+
+    record.type = (RecordType) type;
+    record.time = lastTime + elapsed;
+    record.id = id;
+    record.value = (int32_t) ((value >> 1) ^ (~(value & 1) + 1)); // Zigzag decoding
+    record.outcome = (RecordOutcome) outcome;
+    lastTime = record.time;
+
+    record.infos.clear();
+    if(record.type == stateUpdate){
+        record.infos.resize(READ_LENGTH);
+        if(!file.read((char*) record.infos.data(), READ_LENGTH)) throw FileError("Session log truncated");
+    }
+
+    record.text.clear();
+    if(hasText(record)){
+        uint64_t size;
+        if(!readVarint(size)) throw FileError("Session log truncated");
+
+        record.text.resize(size);
+        if(size > 0 && !file.read(&record.text[0], size)) throw FileError("Session log truncated");
+    }
+
+    return true;
+}
@@ -19,21 +19,21 @@ SdfLearner::~SdfLearner(){
 }
 
 
-double SdfLearner::computeReward(const std::vector<float> target, const std::vector<int> action) const{
-    std::vector<uint16_t> positionOutput;
-    auto position = device->getPosition();
+double SdfLearner::computeReward(const std::vector<float>& target, const std::vector<int>& action) const{
+    auto positionOutput = device->getPosition();
 
     auto outPtr = action.cbegin();
-    for(auto posPtr = position.cbegin(); posPtr < position.cend(); posPtr++) {
-        positionOutput.push_back((uint16_t)(*posPtr + *outPtr));
+    for(auto posPtr = positionOutput.begin(); posPtr < positionOutput.end(); posPtr++) {
+        *posPtr += *outPtr;
         outPtr++;
     }
     
     if(!device->validPosition(positionOutput)) return VALID_COEFF;
     
-    auto newCoords = verifier->computeServoToCoord(positionOutput)->getCoord();
+    double newCoords[3];
+    if(verifier->servoToCoord(positionOutput.data(), newCoords) != kinematics::computationSucceeded) return VALID_COEFF;
 
-    auto err = computeSquaredError(target, newCoords);
+    auto err = computeSquaredError(target.data(), newCoords, target.size());
     if(abs(err) < LEARN_ERROR_MARGIN) return -VALID_COEFF;
     
     return -TARGET_COEFF * err - MOVEMENT_COEFF * computeSquaredError(device->getPosition(), action);
@@ -106,8 +106,13 @@ void SdfLearner::step(int state_space_size, int action_space_size, float x_targe
     std::cout << "Action : "; for(auto v : newPos) std::cout << v << " "; std::cout << std::endl;
     std::cout << "Reward : " << stepReward << std::endl;
     auto position = device->getPosition();
+    double coordinates[3];
     std::cout << "Position : "; for(auto v : position) std::cout << v << " "; std::cout << std::endl;
-    std::cout << "Coordinates : "; for(auto v : verifier->computeServoToCoord(position)->getCoord()) std::cout << v << " "; std::cout << std::endl;
+    if(verifier->servoToCoord(position.data(), coordinates) == kinematics::computationSucceeded){
+        std::cout << "Coordinates : "; for(auto v : coordinates) std::cout << v << " "; std::cout << std::endl;
+    }else{
+        std::cout << "Coordinates : could not be computed" << std::endl;
+    }
 
     // Update position for learner
     state_observation[0] = x_target;
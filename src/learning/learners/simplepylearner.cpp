@@ -23,9 +23,10 @@ template<class R, class T> double SimplePyLearner::computeReward(const std::vect
     std::vector<uint16_t> positionOutput = apply<T, uint16_t>(output, [](T x){return x;});
     if(!device->validPosition(positionOutput)) return VALID_COEFF;
     
-    auto newCoords = verifier->computeServoToCoord(positionOutput)->getCoord();
+    double newCoords[3];
+    if(verifier->servoToCoord(positionOutput.data(), newCoords) != kinematics::computationSucceeded) return VALID_COEFF;
 
-    auto err = computeSquaredError(input, newCoords);
+    auto err = computeSquaredError(input.data(), newCoords, input.size());
     if(abs(err) < LEARN_ERROR_MARGIN) return -VALID_COEFF;
 
     //return TARGET_COEFF * (computeSquaredError(input, oldCoords) - computeSquaredError(input, newCoords)) - MOVEMENT_COEFF * computeSquaredError(device->getPosition(), positionOutput);
@@ -82,16 +83,21 @@ Output<std::vector<uint16_t>>* SimplePyLearner::produce(const Input<uint16_t>& i
         }
 
         auto newPosition = device->getPosition(); // Display new position
-        auto newCoords = verifier->computeServoToCoord(newPosition)->getCoord();
+        double newCoords[3];
         std::cout << "Position [ ";
         for(auto ptr = newPosition.cbegin(); ptr < newPosition.cend(); ptr++) {
             std::cout << *ptr << " ";
         }
-        std::cout << "] --> {";
-        for(auto ptr = newCoords.cbegin(); ptr < newCoords.cend(); ptr++) {
-            std::cout << *ptr << " ";
+        std::cout << "] --> ";
+        if(verifier->servoToCoord(newPosition.data(), newCoords) == kinematics::computationSucceeded){
+            std::cout << "{";
+            for(auto v : newCoords) {
+                std::cout << v << " ";
+            }
+            std::cout << "}" << std::endl;
+        }else{
+            std::cout << "coordinates could not be computed" << std::endl;
         }
-        std::cout << "}" << std::endl;
 
         std::cout << "Output " << nbIt << ": ";
         for(auto ptr = output.cbegin(); ptr < output.cend(); ptr++) std::cout << *ptr << ", ";
@@ -0,0 +1,459 @@
+/**
+ * @copyright Copyright (c) 2019
+ */
+
+
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <algorithm>
+
+#include "analyticcartesianconverter.h"
+
+using namespace armlearn;
+using namespace kinematics;
+
+
+// Position of a servomotor when its angle is null
+#define MIDDLE_POSITION FROM_RADIAN(0.0)
+
+
+/**
+ * @brief Brings an angle back within [-PI, PI)
+ *
+ */
+template<typename Scalar>
+static inline Scalar normalizeAngle(Scalar angle){
+    return angle - (Scalar) (2 * M_PI) * std::floor((angle + (Scalar) M_PI) / (Scalar) (2 * M_PI));
+}
+
+/**
+ * @brief Computes the distance between a point and the line passing through origin along direction (unit vector)
+ *
+ */
+static double distanceToLine(const double* point, const double* origin, const double* direction){
+    double diff[3] = {point[0] - origin[0], point[1] - origin[1], point[2] - origin[2]};
+    double proj = diff[0] * direction[0] + diff[1] * direction[1] + diff[2] * direction[2];
+
+    return std::sqrt(std::max(diff[0] * diff[0] + diff[1] * diff[1] + diff[2] * diff[2] - proj * proj, 0.0));
+}
+
+
+
+AnalyticCartesianConverter::AnalyticCartesianConverter():CartesianConverter(), modelComputed(false), nbPlanar(0), wristSegment(0){
+
+}
+
+AnalyticCartesianConverter::~AnalyticCartesianConverter(){
+
+}
+
+AnalyticCartesianConverter* AnalyticCartesianConverter::clone() const{
+    return new AnalyticCartesianConverter(*this);
+}
+
+
+Converter* AnalyticCartesianConverter::addServo(const std::string& name, Axis axis, double lengthX, double lengthY, double lengthZ, double rotationX, double rotationY, double rotationZ){
+    if(nbServos == 0 && axis != fixed && axis != rotZ){
+        std::stringstream errMsg;
+        errMsg << "Axis of the first servomotor has to be " << rotZ << " not " << axis;
+
+        throw ConverterError(errMsg.str());
+    }
+
+    Converter::addServo(name, axis, lengthX, lengthY, lengthZ, rotationX, rotationY, rotationZ);
+    modelComputed = false;
+
+    return this;
+}
+
+Converter* AnalyticCartesianConverter::removeAllServos(){
+    Converter::removeAllServos();
+    modelComputed = false;
+
+    return this;
+}
+
+
+
+void AnalyticCartesianConverter::computeModel(){
+    int nbSegments = chain.getNbSegments();
+    int nbJoints = chain.getNbJoints();
+    if(nbJoints < 2) throw ConverterError("Device must contain a rotational base followed by at least one servomotor");
+
+    // Frames of the device in its middle position
+    std::vector<double> zeros(nbJoints, 0.0);
+    std::vector<Frame> frames(nbSegments);
+    chain.computeFrames(zeros.data(), frames.data());
+    const double* tip = frames[nbSegments - 1].pos;
+
+    // Position and direction of the axis of each servomotor
+    static const Frame identity = {{1, 0, 0, 0, 1, 0, 0, 0, 1}, {0, 0, 0}};
+    std::vector<std::vector<double>> origins, directions;
+    std::vector<int> jointSegments;
+    for(int i = 0; i < nbSegments; i++){
+        Axis axis = chain.getAxis(i);
+        if(axis == fixed) continue;
+        jointSegments.push_back(i);
+
+        if(axis == transX || axis == transY || axis == transZ){
+            std::stringstream errMsg;
+            errMsg << "Servomotor " << chain.getName(i) << " translates, only rotating servomotors are supported";
+
+            throw ConverterError(errMsg.str());
+        }
+
+        const Frame& frame = i > 0 ? frames[i - 1] : identity; // The servomotor rotates the frame at the end of the previous part
+        int column = axis - rotX;
+        origins.push_back({frame.pos[0], frame.pos[1], frame.pos[2]});
+        directions.push_back({frame.rot[column], frame.rot[3 + column], frame.rot[6 + column]});
+    }
+
+    // Base must rotate along the vertical axis passing through the origin
+    if(std::abs(std::abs(directions[0][2]) - 1) > ANALYTIC_TOLERANCE || std::abs(origins[0][0]) > ANALYTIC_TOLERANCE || std::abs(origins[0][1]) > ANALYTIC_TOLERANCE)
+        throw ConverterError("First servomotor must rotate along the vertical axis of the device");
+    baseSign = directions[0][2] > 0 ? 1 : -1;
+
+    // Last servomotors whose axis passes through the end of the arm do not move it
+    int lastPlanar = nbJoints - 1;
+    while(lastPlanar > 0 && distanceToLine(tip, origins[lastPlanar].data(), directions[lastPlanar].data()) < ANALYTIC_TOLERANCE) lastPlanar--;
+
+    nbPlanar = lastPlanar;
+    wristSegment = jointSegments[nbPlanar];
+    if(nbPlanar < 1 || nbPlanar > ANALYTIC_MAX_PLANAR){
+        std::stringstream errMsg;
+        errMsg << "Device has " << nbPlanar << " servomotors moving its end after the base, analytic computation requires between 1 and " << ANALYTIC_MAX_PLANAR;
+
+        throw ConverterError(errMsg.str());
+    }
+
+    // Planar servomotors must rotate along parallel horizontal axes
+    const std::vector<double>& axis = directions[1];
+    if(std::abs(axis[2]) > ANALYTIC_TOLERANCE) throw ConverterError("Servomotors following the base must rotate along a horizontal axis");
+
+    planeAxis[0] = axis[0];
+    planeAxis[1] = axis[1];
+    radialAxis[0] = -axis[1]; // Z x axis, the frame (axis, radial, Z) is direct
+    radialAxis[1] = axis[0];
+
+    double points[ANALYTIC_MAX_PLANAR + 1][2]; // Coordinates of the planar servomotors and of the end of the arm in the plane (radial, Z)
+    for(int j = 1; j <= nbPlanar; j++){
+        const std::vector<double>& dir = directions[j];
+        double dot = dir[0] * axis[0] + dir[1] * axis[1] + dir[2] * axis[2];
+        if(std::abs(std::abs(dot) - 1) > ANALYTIC_TOLERANCE){
+            std::stringstream errMsg;
+            errMsg << "Servomotor " << j << " does not rotate along the same axis as servomotor 1";
+
+            throw ConverterError(errMsg.str());
+        }
+
+        planarSign[j - 1] = dot > 0 ? 1 : -1;
+        points[j - 1][0] = origins[j][0] * radialAxis[0] + origins[j][1] * radialAxis[1];
+        points[j - 1][1] = origins[j][2];
+    }
+    points[nbPlanar][0] = tip[0] * radialAxis[0] + tip[1] * radialAxis[1];
+    points[nbPlanar][1] = tip[2];
+
+    lateral = tip[0] * planeAxis[0] + tip[1] * planeAxis[1];
+    shoulder[0] = points[0][0];
+    shoulder[1] = points[0][1];
+
+    for(int j = 0; j < nbPlanar; j++){
+        links[j][0] = points[j + 1][0] - points[j][0];
+        links[j][1] = points[j + 1][1] - points[j][1];
+        linkLength[j] = std::sqrt(links[j][0] * links[j][0] + links[j][1] * links[j][1]);
+        linkAngle[j] = std::atan2(links[j][1], links[j][0]);
+    }
+
+    modelComputed = true;
+}
+
+
+template<typename Scalar>
+bool AnalyticCartesianConverter::solvePlanar(Scalar targetR, Scalar targetZ, Scalar pitch, bool elbowUp, Scalar* angles) const{
+    Scalar absolute[ANALYTIC_MAX_PLANAR]; // Rotation of each part in the plane, sum of the angles of the previous servomotors
+    const Scalar tolerance = std::max((Scalar) ANALYTIC_TOLERANCE, 16 * std::numeric_limits<Scalar>::epsilon()); // Rounding errors of single precision exceed ANALYTIC_TOLERANCE
+
+    if(nbPlanar == 1){
+        Scalar length = linkLength[0];
+        if(std::abs(std::sqrt(targetR * targetR + targetZ * targetZ) - length) > tolerance * std::max((Scalar) 1, length)) return false;
+
+        absolute[0] = std::atan2(targetZ, targetR) - (Scalar) linkAngle[0];
+    }else{
+        // Position to reach with the first two parts, the last one having the given orientation
+        Scalar wristR = targetR;
+        Scalar wristZ = targetZ;
+        if(nbPlanar == 3){
+            wristR -= std::cos(pitch) * (Scalar) links[2][0] - std::sin(pitch) * (Scalar) links[2][1];
+            wristZ -= std::sin(pitch) * (Scalar) links[2][0] + std::cos(pitch) * (Scalar) links[2][1];
+        }
+
+        Scalar a = linkLength[0];
+        Scalar b = linkLength[1];
+        if(a * b < tolerance) return false;
+
+        Scalar cosElbow = (wristR * wristR + wristZ * wristZ - a * a - b * b) / (2 * a * b);
+        if(cosElbow > 1 + tolerance || cosElbow < -1 - tolerance) return false;
+        cosElbow = std::max((Scalar) -1, std::min((Scalar) 1, cosElbow));
+
+        Scalar elbow = elbowUp ? std::acos(cosElbow) : -std::acos(cosElbow);
+        Scalar first = std::atan2(wristZ, wristR) - std::atan2(b * std::sin(elbow), a + b * cosElbow);
+
+        absolute[0] = first - (Scalar) linkAngle[0];
+        absolute[1] = first + elbow - (Scalar) linkAngle[1];
+        if(nbPlanar == 3) absolute[2] = pitch;
+    }
+
+    // Servomotor angles from absolute rotations
+    Scalar previous = 0;
+    for(int j = 0; j < nbPlanar; j++){
+        angles[j] = normalizeAngle((Scalar) planarSign[j] * (absolute[j] - previous));
+        previous = absolute[j];
+    }
+
+    return true;
+}
+
+
+
+double AnalyticCartesianConverter::solveBranch(double radial, double height, double base, double pitch, bool elbowUp, const std::vector<double>& reference, std::vector<double>& candidate) const{
+    double angles[ANALYTIC_MAX_PLANAR];
+    if(forwardMode == singlePrecisionComputation){
+        float anglesSingle[ANALYTIC_MAX_PLANAR];
+        if(!solvePlanar<float>(radial - shoulder[0], height - shoulder[1], pitch, elbowUp, anglesSingle)) return std::numeric_limits<double>::infinity();
+
+        std::copy(anglesSingle, anglesSingle + nbPlanar, angles);
+    }else if(!solvePlanar<double>(radial - shoulder[0], height - shoulder[1], pitch, elbowUp, angles)) return std::numeric_limits<double>::infinity();
+
+    candidate[0] = std::round(FROM_RADIAN(base));
+    for(int j = 0; j < nbPlanar; j++) candidate[j + 1] = std::round(FROM_RADIAN(angles[j]));
+
+    double distance = 0;
+    for(int i = 0; i <= nbPlanar; i++){
+        if(!withinLimits(i, candidate[i])) return std::numeric_limits<double>::infinity();
+
+        distance += (candidate[i] - reference[i]) * (candidate[i] - reference[i]);
+    }
+
+    return distance;
+}
+
+
+
+ComputationStatus AnalyticCartesianConverter::tryServoToCoord(const std::vector<uint16_t>& positions, std::vector<double>& coordinates){
+    int nbJoints = chain.getNbJoints();
+    if(nbJoints != positions.size()) return invalidInputSize;
+
+    // Computation in single precision from the precomputed tables
+    if(forwardMode == singlePrecisionComputation){
+        float tip[3];
+        chain.computePositionsFromServo(positions.data(), 1, tip);
+
+        coordinates.assign(tip, tip + 3);
+
+        return computationSucceeded;
+    }
+
+    Frame tip;
+    if(forwardMode == tableComputation){
+        chain.computeTipFromServo(positions.data(), tip);
+    }else{
+        std::vector<double> jointValues(nbJoints);
+        for(int i = 0; i < nbJoints; i++){
+            jointValues[i] = TO_RADIAN((double) positions[i]); // Conversion from servomotor unit to radian
+        }
+
+        chain.computeTip(jointValues.data(), tip);
+    }
+
+
+    // Save coordinates
+    coordinates.assign(tip.pos, tip.pos + 3);
+
+    return computationSucceeded;
+}
+
+ComputationStatus AnalyticCartesianConverter::tryCoordToServo(const std::vector<double>& coordinates, std::vector<uint16_t>& positions){
+    if(coordinates.size() != 3) return invalidInputSize;
+    if(outOfReach(coordinates.data())) return unreachableTarget; // Rejected before running any solver
+
+    if(!modelComputed){
+        try{
+            computeModel();
+        }catch(ConverterError& e){ // Structure of the device not supported, checked once
+            return undefinedDevice;
+        }
+    }
+    int nbJoints = chain.getNbJoints();
+
+    // Reference position the solution must be the closest to
+    std::vector<double> reference(nbJoints);
+    for(int i = 0; i < nbJoints; i++){
+        reference[i] = positions.size() == nbJoints ? positions[i] : MIDDLE_POSITION;
+        if(!withinLimits(i, reference[i])) reference[i] = std::max(std::min(reference[i], servoMax[i] - 1.0), servoMin[i] + 1.0);
+    }
+
+    // Horizontal distance from the vertical plane containing the arm
+    double horizontal = coordinates[0] * coordinates[0] + coordinates[1] * coordinates[1] - lateral * lateral;
+    if(horizontal < -ANALYTIC_TOLERANCE) return noSolutionFound; // Coordinates out of reach of the device
+    double radial = std::sqrt(std::max(horizontal, 0.0));
+    double direction = std::atan2(coordinates[1], coordinates[0]);
+
+    // Orientation of the last part in the reference position
+    double refPitch = 0;
+    for(int j = 1; j <= nbPlanar; j++) refPitch += planarSign[j - 1] * TO_RADIAN(reference[j]);
+
+    std::vector<double> best;
+    std::vector<double> candidate(reference);
+    double bestDistance = std::numeric_limits<double>::infinity();
+
+    int maxStep = nbPlanar == 3 ? (int) std::ceil(M_PI / ANALYTIC_PITCH_STEP) : 0;
+    for(int step = 0; step <= maxStep && best.empty(); step++){ // Orientations closest to the reference are tried first
+        for(int side = (step == 0 ? 1 : -1); side <= 1; side += 2){
+            double pitch = refPitch + side * step * ANALYTIC_PITCH_STEP;
+
+            for(int facing = 0; facing < 2; facing++){ // Base facing the target or opposite to it
+                double r = facing ? -radial : radial;
+                double planeR = lateral * planeAxis[0] + r * radialAxis[0];
+                double planeY = lateral * planeAxis[1] + r * radialAxis[1];
+                double base = normalizeAngle(baseSign * (direction - std::atan2(planeY, planeR)));
+
+                for(int branch = 0; branch < (nbPlanar > 1 ? 2 : 1); branch++){
+                    double distance = solveBranch(r, coordinates[2], base, pitch, branch, reference, candidate);
+
+                    if(distance < bestDistance){
+                        best = candidate;
+                        bestDistance = distance;
+                    }
+                }
+            }
+        }
+    }
+
+    if(best.empty()) return noSolutionFound; // Coordinates cannot be reached within the servomotor limits
+
+
+    // Save positions
+    positions.assign(best.begin(), best.end());
+
+    return computationSucceeded;
+}
+
+
+ComputationStatus AnalyticCartesianConverter::tryTrackCoord(const std::vector<double>& coordinates, std::vector<uint16_t>& positions, TrackingReport& report){
+    return Converter::tryTrackCoord(coordinates, positions, report);
+}
+
+
+ComputationStatus AnalyticCartesianConverter::tryServoToPose(const std::vector<uint16_t>& positions, std::vector<double>& pose){
+    int nbJoints = chain.getNbJoints();
+    if(nbJoints != positions.size()) return invalidInputSize;
+
+    if(!modelComputed){
+        try{
+            computeModel();
+        }catch(ConverterError& e){ // Structure of the device not supported, checked once
+            return undefinedDevice;
+        }
+    }
+
+    std::vector<double> jointValues(nbJoints);
+    for(int i = 0; i < nbJoints; i++) jointValues[i] = TO_RADIAN((double) positions[i]); // Conversion from servomotor unit to radian
+
+    std::vector<Frame> frames(chain.getNbSegments());
+    chain.computeFrames(jointValues.data(), frames.data());
+
+    // Approach vector from the axis of the last planar servomotor to the end of the arm
+    const double* tip = frames.back().pos;
+    double wrist[3] = {0, 0, 0};
+    if(wristSegment > 0) std::copy(frames[wristSegment - 1].pos, frames[wristSegment - 1].pos + 3, wrist);
+
+    double approach[3] = {tip[0] - wrist[0], tip[1] - wrist[1], tip[2] - wrist[2]};
+    double norm = std::sqrt(approach[0] * approach[0] + approach[1] * approach[1] + approach[2] * approach[2]);
+    if(norm < ANALYTIC_TOLERANCE) return undefinedDevice; // End of the arm on the axis of the wrist, no approach direction
+
+
+    // Save pose
+    pose.assign(tip, tip + 3);
+    for(int k = 0; k < 3; k++) pose.push_back(approach[k] / norm);
+
+    return computationSucceeded;
+}
+
+ComputationStatus AnalyticCartesianConverter::tryPoseToServo(const std::vector<double>& pose, const std::vector<uint16_t>& reference, std::vector<std::vector<uint16_t>>& solutions){
+    solutions.clear();
+    if(pose.size() != 6) return invalidInputSize;
+    if(outOfReach(pose.data())) return unreachableTarget; // Rejected before running any solver
+
+    if(!modelComputed){
+        try{
+            computeModel();
+        }catch(ConverterError& e){ // Structure of the device not supported, checked once
+            return undefinedDevice;
+        }
+    }
+    if(nbPlanar != 3) return undefinedDevice; // Orientation of the end of the arm not independent from its position
+    int nbJoints = chain.getNbJoints();
+
+    double norm = std::sqrt(pose[3] * pose[3] + pose[4] * pose[4] + pose[5] * pose[5]);
+    if(norm < ANALYTIC_TOLERANCE) return noSolutionFound; // No orientation given
+    double approach[3] = {pose[3] / norm, pose[4] / norm, pose[5] / norm};
+
+    // Reference position the solutions are sorted by, servomotors after the wrist keeping their position
+    std::vector<double> ref(nbJoints);
+    for(int i = 0; i < nbJoints; i++){
+        ref[i] = reference.size() == nbJoints ? reference[i] : MIDDLE_POSITION;
+        if(!withinLimits(i, ref[i])) ref[i] = std::max(std::min(ref[i], servoMax[i] - 1.0), servoMin[i] + 1.0);
+    }
+
+    // Horizontal distance from the vertical plane containing the arm
+    double horizontal = pose[0] * pose[0] + pose[1] * pose[1] - lateral * lateral;
+    if(horizontal < -ANALYTIC_TOLERANCE) return noSolutionFound; // Coordinates out of reach of the device
+    double radial = std::sqrt(std::max(horizontal, 0.0));
+    double direction = std::atan2(pose[1], pose[0]);
+
+    std::vector<std::pair<double, std::vector<double>>> found;
+    std::vector<double> candidate(ref);
+    for(int facing = 0; facing < 2; facing++){ // Base facing the target or opposite to it
+        double r = facing ? -radial : radial;
+        double planeR = lateral * planeAxis[0] + r * radialAxis[0];
+        double planeY = lateral * planeAxis[1] + r * radialAxis[1];
+        double rotation = direction - std::atan2(planeY, planeR); // Rotation of the vertical plane of the arm around the base axis
+        double base = normalizeAngle(baseSign * rotation);
+
+        // Approach vector expressed in the plane of the arm, it cannot leave this plane
+        double c = std::cos(rotation), s = std::sin(rotation);
+        double normal = approach[0] * (c * planeAxis[0] - s * planeAxis[1]) + approach[1] * (s * planeAxis[0] + c * planeAxis[1]);
+        if(std::abs(normal) > ANALYTIC_APPROACH_TOLERANCE) continue;
+
+        double inPlane = approach[0] * (c * radialAxis[0] - s * radialAxis[1]) + approach[1] * (s * radialAxis[0] + c * radialAxis[1]);
+        double pitch = std::atan2(approach[2], inPlane) - linkAngle[2]; // Orientation of the last planar part, decoupled from the position of the wrist
+
+        for(int branch = 0; branch < 2; branch++){
+            double distance = solveBranch(r, pose[2], base, pitch, branch, ref, candidate);
+            if(distance < std::numeric_limits<double>::infinity()) found.push_back(std::make_pair(distance, candidate));
+        }
+    }
+
+    if(found.empty()) return noSolutionFound; // Pose cannot be reached within the servomotor limits
+
+    // Save positions, closest to the reference first
+    std::stable_sort(found.begin(), found.end(), [](const std::pair<double, std::vector<double>>& a, const std::pair<double, std::vector<double>>& b){ return a.first < b.first; });
+    for(auto& solution : found) solutions.push_back(std::vector<uint16_t>(solution.second.cbegin(), solution.second.cend()));
+
+    return computationSucceeded;
+}
+
+Converter* AnalyticCartesianConverter::computePoseToServo(const std::vector<double>& pose){
+    std::vector<std::vector<uint16_t>> solutions;
+    ComputationStatus status = tryPoseToServo(pose, lastServo, solutions); // Closest solution to the last known position of the device
+    if(status != computationSucceeded) raise(status, "pose inverse kinematics", pose.size());
+
+    // Save coordinates
+    lastCoord.assign(pose.cbegin(), pose.cbegin() + 3);
+
+    // Save positions
+    lastServo.swap(solutions.front());
+
+    return this;
+}
@@ -3,112 +3,251 @@
  */
 
 
+#include <cmath>
+#include <algorithm>
+
 #include "basiccartesianconverter.h"
 
 using namespace armlearn;
 using namespace kinematics;
 
 
-BasicCartesianConverter::BasicCartesianConverter():CartesianConverter(){
+BasicCartesianConverter::BasicCartesianConverter():CartesianConverter(), workspaceIndex(nullptr), solver(newtonRaphsonSolver), maxIterations(IK_MAX_ITERATIONS), tolerance(IK_TOLERANCE){
+    cartesianConverter = new KDL::ChainFkSolverPos_recursive(*device);
+
+    intermediaryVelocitySolver = new KDL::ChainIkSolverVel_pinv(*device);
+    positionConverter = new KDL::ChainIkSolverPos_NR(*device, *cartesianConverter, *intermediaryVelocitySolver, maxIterations, tolerance);
+}
+
+BasicCartesianConverter::BasicCartesianConverter(const BasicCartesianConverter& other):CartesianConverter(other), workspaceIndex(other.workspaceIndex), solver(other.solver), maxIterations(other.maxIterations), tolerance(other.tolerance){
     cartesianConverter = new KDL::ChainFkSolverPos_recursive(*device);
 
     intermediaryVelocitySolver = new KDL::ChainIkSolverVel_pinv(*device);
-    positionConverter = new KDL::ChainIkSolverPos_NR(*device, *cartesianConverter, *intermediaryVelocitySolver);
+    positionConverter = new KDL::ChainIkSolverPos_NR(*device, *cartesianConverter, *intermediaryVelocitySolver, maxIterations, tolerance);
+
+    updateSolvers();
 }
 
 BasicCartesianConverter::~BasicCartesianConverter(){
     delete positionConverter;
+    delete intermediaryVelocitySolver;
     delete cartesianConverter;
 }
 
 
-Converter* BasicCartesianConverter::computeServoToCoord(const std::vector<uint16_t>& positions){
+void BasicCartesianConverter::updateSolvers(){
+    cartesianConverter->updateInternalDataStructures();
+    intermediaryVelocitySolver->updateInternalDataStructures();
+    positionConverter->updateInternalDataStructures();
 
-    // Create input joint array
     int nbJoints = device->getNrOfJoints();
-    if(nbJoints != positions.size()){
+    jointPositions.resize(nbJoints);
+    initialValues.resize(nbJoints);
+    seed.resize(nbJoints);
+    candidate.resize(nbJoints);
+    weights.resize(nbJoints);
+    motion.resize(nbJoints);
+    jacobianBuffer.resize(6 * nbJoints);
+}
+
+bool BasicCartesianConverter::solveLevenbergMarquardt(const double* coordinates){
+    int nbJoints = chain.getNbJoints();
+    double* values = jointPositions.data.data();
+
+    // Start from the seed, moved strictly within the limits
+    for(int j = 0; j < nbJoints; j++){
+        values[j] = std::max(TO_RADIAN(servoMin[j] + 1.0), std::min(TO_RADIAN(servoMax[j] - 1.0), initialValues(j)));
+    }
+
+    Frame tip;
+    double error[3];
+    computeChainTip(values, tip);
+    for(int k = 0; k < 3; k++) error[k] = coordinates[k] - tip.pos[k];
+    double distance = std::sqrt(error[0] * error[0] + error[1] * error[1] + error[2] * error[2]);
+
+    double damping = LM_INITIAL_DAMPING;
+    for(int it = 0; it < maxIterations && distance > tolerance; it++){
+        computeChainJacobian(values, jacobianBuffer.data());
+
+        // Joints at a limit are locked when the step pushes them against it
+        std::fill(weights.begin(), weights.end(), 1.0);
+        for(int pass = 0; pass < nbJoints; pass++){
+            std::copy(weights.cbegin(), weights.cend(), motion.begin());
+            if(!solveDamped(jacobianBuffer.data(), nbJoints, damping, error, motion.data())) return false;
+
+            bool blocked = false;
+            for(int j = 0; j < nbJoints; j++){
+                if(weights[j] != 0 && ((values[j] <= TO_RADIAN(servoMin[j] + 1.0) && motion[j] < 0) || (values[j] >= TO_RADIAN(servoMax[j] - 1.0) && motion[j] > 0))){
+                    weights[j] = 0;
+                    blocked = true;
+                }
+            }
+            if(!blocked) break;
+        }
+
+        // Candidate step, clamped to the limits
+        for(int j = 0; j < nbJoints; j++){
+            candidate[j] = std::max(TO_RADIAN(servoMin[j] + 1.0), std::min(TO_RADIAN(servoMax[j] - 1.0), values[j] + motion[j]));
+        }
+
+        double candidateError[3];
+        computeChainTip(candidate.data(), tip);
+        for(int k = 0; k < 3; k++) candidateError[k] = coordinates[k] - tip.pos[k];
+        double candidateDistance = std::sqrt(candidateError[0] * candidateError[0] + candidateError[1] * candidateError[1] + candidateError[2] * candidateError[2]);
+
+        // Accepted steps reduce the damping towards Gauss-Newton, rejected ones increase it towards gradient descent
+        if(candidateDistance < distance){
+            std::copy(candidate.cbegin(), candidate.cend(), values);
+            std::copy(candidateError, candidateError + 3, error);
+            distance = candidateDistance;
+            damping /= 2;
+        }else{
+            damping *= 4;
+            if(damping > LM_MAX_DAMPING) break;
+        }
+    }
+
+    return distance <= tolerance;
+}
+
+BasicCartesianConverter* BasicCartesianConverter::clone() const{
+    return new BasicCartesianConverter(*this);
+}
+
+Converter* BasicCartesianConverter::addServo(const std::string& name, Axis axis, double lengthX, double lengthY, double lengthZ, double rotationX, double rotationY, double rotationZ){
+    Converter::addServo(name, axis, lengthX, lengthY, lengthZ, rotationX, rotationY, rotationZ);
+    updateSolvers();
+
+    return this;
+}
+
+Converter* BasicCartesianConverter::removeAllServos(){
+    Converter::removeAllServos();
+    updateSolvers();
+
+    return this;
+}
+
+
+Converter* BasicCartesianConverter::setWorkspaceIndex(const WorkspaceIndex* index){
+    workspaceIndex = index;
+    touch();
+
+    return this;
+}
+
+Converter* BasicCartesianConverter::setSolver(IKSolver type, int iterations, double eps){
+    if(iterations < 1 || eps <= 0){
         std::stringstream errMsg;
-        errMsg << "Input size " << positions.size() << " does not match the number of servomotors : " << nbJoints;
+        errMsg << "Invalid budget for the inverse kinematics solver : " << iterations << " iterations, tolerance of " << eps;
+
+        throw ConverterError(errMsg.str());
+    }
+
+    solver = type;
+    maxIterations = iterations;
+    tolerance = eps;
+    touch();
+
+    delete positionConverter;
+    positionConverter = new KDL::ChainIkSolverPos_NR(*device, *cartesianConverter, *intermediaryVelocitySolver, maxIterations, tolerance);
 
-        throw ComputationError(errMsg.str());
+    return this;
+}
+
+IKSolver BasicCartesianConverter::getSolver() const{
+    return solver;
+}
+
+
+ComputationStatus BasicCartesianConverter::tryServoToCoord(const std::vector<uint16_t>& positions, std::vector<double>& coordinates){
+
+    // Create input joint array
+    int nbJoints = device->getNrOfJoints();
+    if(nbJoints != positions.size()) return invalidInputSize;
+
+    // Computation in single precision from the precomputed tables
+    if(forwardMode == singlePrecisionComputation){
+        float tip[3];
+        chain.computePositionsFromServo(positions.data(), 1, tip);
+
+        coordinates.assign(tip, tip + 3);
+
+        return computationSucceeded;
+    }
+
+    // Computation from the precomputed tables, without solver
+    if(forwardMode == tableComputation){
+        Frame tip;
+        chain.computeTipFromServo(positions.data(), tip);
+
+        coordinates.assign(tip.pos, tip.pos + 3);
+
+        return computationSucceeded;
     }
-    KDL::JntArray jointPositions = KDL::JntArray(nbJoints);
-    
+
     int i=0;
     for(auto ptr = positions.cbegin(); ptr < positions.cend(); ptr++){
         jointPositions(i)= TO_RADIAN((double) *ptr); // Conversion from servomotor unit to radian
         i++;
     }
  
-    // Create the frame that will contain the results
-    KDL::Frame cartPos;
- 
     // Calculate forward position kinematics
-    cartesianConverter->updateInternalDataStructures();
     int correct;
     correct = cartesianConverter->JntToCart(jointPositions, cartPos);
-    if(correct < 0){
-        throw ComputationError("Error : could not calculate forward kinematics");
-    }
+    if(correct < 0) return noSolutionFound;
 
 
-    // Save positions
-    lastServo = std::vector<uint16_t>(positions);
-
     // Save coordinates
-    KDL::Vector res = cartPos.p;
-    lastCoord = {res.x(), res.y(), res.z()};
+    const KDL::Vector& res = cartPos.p;
+    coordinates.resize(3);
+    coordinates[0] = res.x();
+    coordinates[1] = res.y();
+    coordinates[2] = res.z();
 
 
-    return this;
+    return computationSucceeded;
 }
 
-Converter* BasicCartesianConverter::computeCoordToServo(const std::vector<double>& coordinates){
+ComputationStatus BasicCartesianConverter::tryCoordToServo(const std::vector<double>& coordinates, std::vector<uint16_t>& positions){
 
     // Create input frame
-    int spaceDim = 3;
-    if(coordinates.size() != 3){
-        std::stringstream errMsg;
-        errMsg << "Input size " << coordinates.size() << " does not match the number of dimensions in the coordinates system : " << spaceDim;
-
-        throw ComputationError(errMsg.str());
+    if(coordinates.size() != 3) return invalidInputSize;
+    if(outOfReach(coordinates.data())) return unreachableTarget; // Rejected before running any solver
+    cartPos = KDL::Frame(KDL::Vector(coordinates[0], coordinates[1], coordinates[2]));
+
+    // Fill initial joint array from the closest sample of the index, or from the given starting point
+    if(workspaceIndex != nullptr && !workspaceIndex->empty() && workspaceIndex->getNbServos() == initialValues.rows()){
+        workspaceIndex->nearest(coordinates.data(), seed.data());
+        for(int i=0; i < seed.size(); i++){
+            initialValues(i)= TO_RADIAN((double) seed[i]); // Conversion from servomotor unit to radian
+        }
+    }else if(positions.size() == initialValues.rows()){
+        int i=0;
+        for(auto ptr = positions.cbegin(); ptr < positions.cend(); ptr++){
+            initialValues(i)= TO_RADIAN((double) *ptr); // Conversion from servomotor unit to radian
+            i++;
+        }
+    }else{
+        SetToZero(initialValues);
     }
-    KDL::Frame cartPos(KDL::Vector(coordinates[0], coordinates[1], coordinates[2]));
-
-    // Create initial joint array from last known position of the device
-    KDL::JntArray initialValues(device->getNrOfJoints());
-    int i=0;
-    for(auto ptr = lastServo.cbegin(); ptr < lastServo.cend(); ptr++){
-        initialValues(i)= TO_RADIAN((double) *ptr); // Conversion from servomotor unit to radian
-        i++;
-    }
-
-    // Create the joint array that will contain the results
-    KDL::JntArray jointPositions(device->getNrOfJoints());
 
     // Calculate inverse position kinematics
-    positionConverter->updateInternalDataStructures();
-    int correct;
-    correct = positionConverter->CartToJnt(initialValues, cartPos, jointPositions);
-    if(correct < 0){
-        std::stringstream errMsg;
-        errMsg << "Error " << correct << " : could not calculate inverse kinematics";
-
-        throw ComputationError(errMsg.str());
+    if(solver == levenbergMarquardtSolver){
+        if(!solveLevenbergMarquardt(coordinates.data())) return noSolutionFound;
+    }else{
+        int correct;
+        correct = positionConverter->CartToJnt(initialValues, cartPos, jointPositions);
+        if(correct < 0) return noSolutionFound;
     }
 
 
-    // Save coordinates
-    lastCoord = std::vector<double>(coordinates);
-
     // Save positions
-    lastServo = {};
+    positions.resize(jointPositions.rows());
     for(int i=0; i < jointPositions.rows(); i++){
-        lastServo.push_back(FROM_RADIAN(jointPositions(i))); // Conversion from radian to servomotor unit
+        positions[i] = std::round(FROM_RADIAN(jointPositions(i))); // Conversion from radian to servomotor unit
     }
 
 
-    return this;
+    return computationSucceeded;
 }
-
-
@@ -3,16 +3,285 @@
  */
 
 
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
 #include "cartesianconverter.h"
+#include "reachabilitymap.h"
 
 using namespace armlearn;
 using namespace kinematics;
 
 
-CartesianConverter::CartesianConverter():Converter(){
+/**
+ * @brief Converts a rotation matrix stored row by row into a unit quaternion [X, Y, Z, W]
+ *
+ */
+static void toQuaternion(const double* rot, double* quat){
+    double trace = rot[0] + rot[4] + rot[8];
+
+    if(trace > 0){ // Largest component chosen as divisor for numerical stability
+        double s = 0.5 / std::sqrt(trace + 1);
+        quat[3] = 0.25 / s;
+        quat[0] = (rot[7] - rot[5]) * s;
+        quat[1] = (rot[2] - rot[6]) * s;
+        quat[2] = (rot[3] - rot[1]) * s;
+    }else if(rot[0] > rot[4] && rot[0] > rot[8]){
+        double s = 2 * std::sqrt(1 + rot[0] - rot[4] - rot[8]);
+        quat[3] = (rot[7] - rot[5]) / s;
+        quat[0] = 0.25 * s;
+        quat[1] = (rot[1] + rot[3]) / s;
+        quat[2] = (rot[2] + rot[6]) / s;
+    }else if(rot[4] > rot[8]){
+        double s = 2 * std::sqrt(1 + rot[4] - rot[0] - rot[8]);
+        quat[3] = (rot[2] - rot[6]) / s;
+        quat[0] = (rot[1] + rot[3]) / s;
+        quat[1] = 0.25 * s;
+        quat[2] = (rot[5] + rot[7]) / s;
+    }else{
+        double s = 2 * std::sqrt(1 + rot[8] - rot[0] - rot[4]);
+        quat[3] = (rot[3] - rot[1]) / s;
+        quat[0] = (rot[2] + rot[6]) / s;
+        quat[1] = (rot[5] + rot[7]) / s;
+        quat[2] = 0.25 * s;
+    }
+}
+
+
+
+CartesianConverter::CartesianConverter():Converter(), reachability(nullptr){
 
 }
 
 CartesianConverter::~CartesianConverter(){
 
-}
\ No newline at end of file
+}
+
+
+void CartesianConverter::computeServoToCoordBatch(const uint16_t* positions, int nbConfigs, double* coordinates, bool withOrientation){
+    if(forwardMode == singlePrecisionComputation && !withOrientation){
+        std::vector<float> res((size_t) nbConfigs * 3);
+        chain.computePositionsFromServo(positions, nbConfigs, res.data());
+
+        std::copy(res.cbegin(), res.cend(), coordinates);
+        return;
+    }
+
+    int nbJoints = chain.getNbJoints();
+    int stride = withOrientation ? 7 : 3;
+
+    std::vector<double> jointValues((size_t) CHAIN_BATCH_LANES * nbJoints);
+    Frame tips[CHAIN_BATCH_LANES];
+
+    for(int start = 0; start < nbConfigs; start += CHAIN_BATCH_LANES){
+        int lanes = std::min(CHAIN_BATCH_LANES, nbConfigs - start);
+
+        const uint16_t* block = positions + (size_t) start * nbJoints;
+        for(int k = 0; k < lanes * nbJoints; k++) jointValues[k] = TO_RADIAN((double) block[k]); // Conversion from servomotor unit to radian
+
+        chain.computeTips(jointValues.data(), lanes, tips);
+
+        for(int l = 0; l < lanes; l++){
+            double* res = coordinates + (size_t) (start + l) * stride;
+            res[0] = tips[l].pos[0];
+            res[1] = tips[l].pos[1];
+            res[2] = tips[l].pos[2];
+
+            if(withOrientation) toQuaternion(tips[l].rot, res + 3);
+        }
+    }
+}
+
+
+void CartesianConverter::computeServoToCoordBatch(const uint16_t* positions, int nbConfigs, float* coordinates){
+    if(forwardMode == singlePrecisionComputation){
+        chain.computePositionsFromServo(positions, nbConfigs, coordinates);
+    }else{
+        Converter::computeServoToCoordBatch(positions, nbConfigs, coordinates);
+    }
+}
+
+
+Converter* CartesianConverter::setReachabilityMap(const ReachabilityMap* map){
+    reachability = map;
+    touch();
+
+    return this;
+}
+
+bool CartesianConverter::outOfReach(const double* coordinates) const{
+    return reachability != nullptr && !reachability->reachable(coordinates);
+}
+
+
+ComputationStatus CartesianConverter::tryJacobian(const std::vector<uint16_t>& positions, std::vector<double>& jacobian) const{
+    int nbJoints = chain.getNbJoints();
+    if(positions.size() != nbJoints) return invalidInputSize;
+
+    std::vector<double> jointValues(nbJoints);
+    for(int i = 0; i < nbJoints; i++) jointValues[i] = TO_RADIAN((double) positions[i]); // Conversion from servomotor unit to radian
+
+    jacobian.resize(6 * nbJoints);
+    computeChainJacobian(jointValues.data(), jacobian.data());
+
+    double scale = 2 * M_PI / SERVO_RESOLUTION; // Derivative of the radian with respect to the servomotor unit
+    for(auto& v : jacobian) v *= scale;
+
+    return computationSucceeded;
+}
+
+ComputationStatus CartesianConverter::tryServoToCoordGradient(const uint16_t* positions, double* coordinates, double* gradient) const{
+    int nbJoints = chain.getNbJoints();
+    if(nbJoints == 0) return undefinedDevice;
+
+    computeServoToCoordGradientBatch(positions, 1, coordinates, gradient);
+
+    return computationSucceeded;
+}
+
+void CartesianConverter::computeServoToCoordGradientBatch(const uint16_t* positions, int nbConfigs, double* coordinates, double* gradients) const{
+    int nbJoints = chain.getNbJoints();
+    double scale = 2 * M_PI / SERVO_RESOLUTION; // Derivative of the radian with respect to the servomotor unit
+
+    std::vector<double> jointValues(nbJoints);
+    for(int c = 0; c < nbConfigs; c++){
+        const uint16_t* config = positions + (size_t) c * nbJoints;
+        for(int i = 0; i < nbJoints; i++) jointValues[i] = TO_RADIAN((double) config[i]); // Conversion from servomotor unit to radian
+
+        double* gradient = gradients + (size_t) c * 3 * nbJoints;
+        computeChainGradient(jointValues.data(), coordinates + (size_t) c * 3, gradient);
+        for(int k = 0; k < 3 * nbJoints; k++) gradient[k] *= scale;
+    }
+}
+
+void CartesianConverter::computeChainTip(const double* jointValues, Frame& tip) const{
+    chain.computeTip(jointValues, tip);
+}
+
+void CartesianConverter::computeChainJacobian(const double* jointValues, double* jacobian) const{
+    chain.computeJacobian(jointValues, jacobian);
+}
+
+void CartesianConverter::computeChainGradient(const double* jointValues, double* position, double* gradient) const{
+    chain.computePositionGradient(jointValues, position, gradient);
+}
+
+
+double CartesianConverter::limitWeight(int servo, double position, double direction) const{
+    double low = servoMin[servo], high = servoMax[servo];
+    if(direction * (2 * position - high - low) <= 0) return 1; // Moving away from the closest limit, not penalized (Chan and Dubey)
+    if(position <= low || position >= high) return 0;
+
+    double gradient = std::pow(high - low, 2) * (2 * position - high - low) / (4 * std::pow(high - position, 2) * std::pow(position - low, 2));
+
+    return 1 / (1 + std::fabs(gradient));
+}
+
+bool CartesianConverter::solveDamped(const double* jacobian, int nbJoints, double damping, const double* displacement, double* motion) const{
+
+    // A = J W^-1 J^T + damping^2 I, symmetric 3 x 3
+    double a[9];
+    for(int r = 0; r < 3; r++){
+        for(int c = r; c < 3; c++){
+            double sum = r == c ? damping * damping : 0;
+            for(int j = 0; j < nbJoints; j++) sum += jacobian[r * nbJoints + j] * motion[j] * jacobian[c * nbJoints + j];
+
+            a[3*r + c] = sum;
+            a[3*c + r] = sum;
+        }
+    }
+
+    // y = A^-1 dx, using the adjugate of A
+    double cof[9] = {
+        a[4] * a[8] - a[5] * a[7], a[2] * a[7] - a[1] * a[8], a[1] * a[5] - a[2] * a[4],
+        a[5] * a[6] - a[3] * a[8], a[0] * a[8] - a[2] * a[6], a[2] * a[3] - a[0] * a[5],
+        a[3] * a[7] - a[4] * a[6], a[1] * a[6] - a[0] * a[7], a[0] * a[4] - a[1] * a[3]
+    };
+    double det = a[0] * cof[0] + a[1] * cof[3] + a[2] * cof[6];
+    if(std::fabs(det) < std::numeric_limits<double>::min()) return false; // Only possible without damping
+
+    double y[3];
+    for(int r = 0; r < 3; r++) y[r] = (cof[3*r] * displacement[0] + cof[3*r + 1] * displacement[1] + cof[3*r + 2] * displacement[2]) / det;
+
+    // dq = W^-1 J^T y
+    for(int j = 0; j < nbJoints; j++) motion[j] *= jacobian[j] * y[0] + jacobian[nbJoints + j] * y[1] + jacobian[2 * nbJoints + j] * y[2];
+
+    return true;
+}
+
+
+ComputationStatus CartesianConverter::tryVelocityStep(const std::vector<uint16_t>& positions, const std::vector<double>& displacement, std::vector<double>& motion, double damping){
+    int nbJoints = chain.getNbJoints();
+    if(displacement.size() != 3) return invalidInputSize;
+
+    ComputationStatus status = tryJacobian(positions, jacobianBuffer);
+    if(status != computationSucceeded) return status;
+    const double* jac = jacobianBuffer.data(); // Only the first 3 rows, linear velocity, are used
+
+    // Damping scaled as the jacobian is derived with respect to the servomotor unit instead of the radian
+    double scaledDamping = damping * 2 * M_PI / SERVO_RESOLUTION;
+
+    // Unweighted solution first, giving the direction in which each servomotor moves
+    motion.assign(nbJoints, 1);
+    if(!solveDamped(jac, nbJoints, scaledDamping, displacement.data(), motion.data())) return noSolutionFound;
+
+    for(int j = 0; j < nbJoints; j++) motion[j] = limitWeight(j, positions[j], motion[j]);
+    if(!solveDamped(jac, nbJoints, scaledDamping, displacement.data(), motion.data())) return noSolutionFound;
+
+    return computationSucceeded;
+}
+
+
+ComputationStatus CartesianConverter::tryTrackCoord(const std::vector<double>& coordinates, std::vector<uint16_t>& positions, TrackingReport& report){
+    int nbJoints = chain.getNbJoints();
+    if(coordinates.size() != 3) return invalidInputSize;
+    if(nbJoints == 0) return undefinedDevice;
+    if(positions.size() != nbJoints) return Converter::tryTrackCoord(coordinates, positions, report); // No previous solution to start from
+    if(outOfReach(coordinates.data())) return unreachableTarget; // Rejected before running any iteration
+
+    trackingBuffer.resize(6 * nbJoints); // Own buffer, the jacobian one keeps the 6 rows expected by the solvers of the inherited classes
+    double* current = trackingBuffer.data(); // Positions in servomotor unit, not rounded between the iterations
+    double* motion = current + nbJoints;
+    double* jointValues = motion + nbJoints;
+    double* gradient = jointValues + nbJoints;
+    for(int j = 0; j < nbJoints; j++) current[j] = positions[j];
+
+    double tip[3], displacement[3];
+    double scale = 2 * M_PI / SERVO_RESOLUTION; // Derivative of the radian with respect to the servomotor unit
+
+    report.iterations = 0;
+    while(true){
+        for(int j = 0; j < nbJoints; j++) jointValues[j] = TO_RADIAN(current[j]); // Conversion from servomotor unit to radian
+        computeChainGradient(jointValues, tip, gradient);
+
+        for(int k = 0; k < 3; k++) displacement[k] = coordinates[k] - tip[k];
+        double error = std::sqrt(displacement[0] * displacement[0] + displacement[1] * displacement[1] + displacement[2] * displacement[2]);
+        if(error <= trackingTolerance || report.iterations == trackingIterations) break;
+
+        std::fill(motion, motion + nbJoints, 1.0); // Unweighted solution first, giving the direction in which each servomotor moves
+        if(!solveDamped(gradient, nbJoints, VELOCITY_DAMPING, displacement, motion)) break;
+
+        for(int j = 0; j < nbJoints; j++) motion[j] = limitWeight(j, current[j], motion[j]);
+        if(!solveDamped(gradient, nbJoints, VELOCITY_DAMPING, displacement, motion)) break;
+
+        // Motion computed in radian, moving servomotors kept strictly within their limits
+        for(int j = 0; j < nbJoints; j++){
+            if(motion[j] != 0) current[j] = std::min<double>(servoMax[j] - 1, std::max<double>(servoMin[j] + 1, current[j] + motion[j] / scale));
+        }
+        report.iterations++;
+    }
+
+    // Error measured again on the positions rounded to the servomotor unit
+    Frame reached;
+    for(int j = 0; j < nbJoints; j++){
+        positions[j] = std::round(current[j]);
+        jointValues[j] = TO_RADIAN((double) positions[j]);
+    }
+    computeChainTip(jointValues, reached);
+
+    report.error = std::sqrt(std::pow(coordinates[0] - reached.pos[0], 2) + std::pow(coordinates[1] - reached.pos[1], 2) + std::pow(coordinates[2] - reached.pos[2], 2));
+    report.converged = report.error <= trackingTolerance;
+
+    return computationSucceeded;
+}
@@ -0,0 +1,272 @@
+/**
+ * @copyright Copyright (c) 2019
+ */
+
+
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+#include "collisionchecker.h"
+
+using namespace armlearn;
+using namespace kinematics;
+
+
+// Length under which a capsule is considered as a sphere
+#define DEGENERATE_LENGTH 1e-9
+
+
+/**
+ * @brief Clamps a value between 0 and 1
+ *
+ */
+static inline double clampUnit(double value){
+    return value < 0 ? 0 : (value > 1 ? 1 : value);
+}
+
+/**
+ * @brief Computes the squared distance between segments [p1, q1] and [p2, q2] (see Ericson, Real-Time Collision Detection, 5.1.9)
+ *
+ */
+static double segmentsSquaredDistance(const double* p1, const double* q1, const double* p2, const double* q2){
+    double d1[3], d2[3], r[3];
+    for(int i = 0; i < 3; i++){
+        d1[i] = q1[i] - p1[i];
+        d2[i] = q2[i] - p2[i];
+        r[i] = p1[i] - p2[i];
+    }
+
+    double a = d1[0] * d1[0] + d1[1] * d1[1] + d1[2] * d1[2];
+    double e = d2[0] * d2[0] + d2[1] * d2[1] + d2[2] * d2[2];
+    double f = d2[0] * r[0] + d2[1] * r[1] + d2[2] * r[2];
+
+    double s = 0;
+    double t = 0;
+    if(a > DEGENERATE_LENGTH || e > DEGENERATE_LENGTH){
+        if(a <= DEGENERATE_LENGTH){ // First segment is a point
+            t = clampUnit(f / e);
+        }else{
+            double c = d1[0] * r[0] + d1[1] * r[1] + d1[2] * r[2];
+
+            if(e <= DEGENERATE_LENGTH){ // Second segment is a point
+                s = clampUnit(-c / a);
+            }else{
+                double b = d1[0] * d2[0] + d1[1] * d2[1] + d1[2] * d2[2];
+                double denom = a * e - b * b;
+
+                s = denom > 0 ? clampUnit((b * f - c * e) / denom) : 0; // Parallel segments if denom is null, any point is valid
+                t = (b * s + f) / e;
+
+                if(t < 0){
+                    t = 0;
+                    s = clampUnit(-c / a);
+                }else if(t > 1){
+                    t = 1;
+                    s = clampUnit((b - c) / a);
+                }
+            }
+        }
+    }
+
+    double dist = 0;
+    for(int i = 0; i < 3; i++){
+        double diff = r[i] + d1[i] * s - d2[i] * t;
+        dist += diff * diff;
+    }
+
+    return dist;
+}
+
+
+
+CollisionChecker::CollisionChecker():chain(), radius(), boundRadius(), ignoredPairs(), referenceComputed(false), tableHeight(DEFAULT_TABLE_HEIGHT), workspaceDefined(false), jointValues(), frames(){
+
+}
+
+CollisionChecker::~CollisionChecker(){
+
+}
+
+
+CollisionChecker* CollisionChecker::addServo(const std::string& name, Axis axis, double lengthX, double lengthY, double lengthZ, double rotationX, double rotationY, double rotationZ, double linkRadius){
+    chain.addSegment(name, axis, lengthX, lengthY, lengthZ, rotationX, rotationY, rotationZ);
+    radius.push_back(linkRadius);
+
+    // Radius of the sphere centered on the middle of the capsule and containing it, infinite if the length of the part varies
+    bool translating = (axis == transX || axis == transY || axis == transZ);
+    boundRadius.push_back(translating ? std::numeric_limits<double>::infinity() : std::sqrt(lengthX * lengthX + lengthY * lengthY + lengthZ * lengthZ) / 2 + linkRadius);
+
+    frames.resize(chain.getNbSegments());
+    jointValues.resize(chain.getNbJoints());
+    referenceComputed = false;
+
+    return this;
+}
+
+CollisionChecker* CollisionChecker::removeAllServos(){
+    chain.clear();
+    radius.clear();
+    boundRadius.clear();
+
+    frames.clear();
+    jointValues.clear();
+    referenceComputed = false;
+
+    return this;
+}
+
+
+CollisionChecker* CollisionChecker::setTableHeight(double height){
+    tableHeight = height;
+
+    return this;
+}
+
+CollisionChecker* CollisionChecker::setWorkspace(const std::vector<double>& minCorner, const std::vector<double>& maxCorner){
+    if(minCorner.size() != 3 || maxCorner.size() != 3){
+        std::stringstream errMsg;
+        errMsg << "Workspace corners of sizes " << minCorner.size() << " and " << maxCorner.size() << " do not match the number of dimensions in the coordinates system : 3";
+
+        throw ComputationError(errMsg.str());
+    }
+
+    for(int i = 0; i < 3; i++){
+        workspaceMin[i] = minCorner[i];
+        workspaceMax[i] = maxCorner[i];
+    }
+    workspaceDefined = true;
+
+    return this;
+}
+
+CollisionChecker* CollisionChecker::removeWorkspace(){
+    workspaceDefined = false;
+
+    return this;
+}
+
+
+
+void CollisionChecker::getCapsule(int segment, const double*& start, const double*& end) const{
+    static const double origin[3] = {0, 0, 0};
+
+    start = segment > 0 ? frames[segment - 1].pos : origin;
+    end = frames[segment].pos;
+}
+
+bool CollisionChecker::capsulesIntersect(int first, int second) const{
+    const double *start1, *end1, *start2, *end2;
+    getCapsule(first, start1, end1);
+    getCapsule(second, start2, end2);
+
+    // Fast rejection using the spheres bounding the capsules
+    double centerDist = 0;
+    for(int i = 0; i < 3; i++){
+        double diff = (start1[i] + end1[i] - start2[i] - end2[i]) / 2;
+        centerDist += diff * diff;
+    }
+    double maxDist = boundRadius[first] + boundRadius[second];
+    if(centerDist > maxDist * maxDist) return false;
+
+    double minDist = radius[first] + radius[second];
+    return segmentsSquaredDistance(start1, end1, start2, end2) < minDist * minDist;
+}
+
+bool CollisionChecker::underTable(int segment) const{
+    const double *start, *end;
+    getCapsule(segment, start, end);
+
+    return std::min(start[2], end[2]) - radius[segment] < tableHeight;
+}
+
+void CollisionChecker::computeReference(){
+    int nbSegments = chain.getNbSegments();
+
+    std::fill(jointValues.begin(), jointValues.end(), 0.0);
+    if(nbSegments > 0) chain.computeFrames(jointValues.data(), frames.data());
+
+    ignoredPairs.assign(nbSegments * nbSegments, false);
+    for(int i = 0; i < nbSegments; i++){
+        for(int j = i + 1; j < nbSegments; j++){
+            bool ignored = (j == i + 1) || capsulesIntersect(i, j); // Adjacent parts always touch each other
+            ignoredPairs[i * nbSegments + j] = ignored;
+            ignoredPairs[j * nbSegments + i] = ignored;
+        }
+    }
+
+    referenceComputed = true;
+}
+
+
+
+CollisionChecker* CollisionChecker::computeFrames(const std::vector<uint16_t>& positions){
+    if(positions.size() != jointValues.size()){
+        std::stringstream errMsg;
+        errMsg << "Input size " << positions.size() << " does not match the number of servomotors : " << jointValues.size();
+
+        throw ComputationError(errMsg.str());
+    }
+
+    if(!referenceComputed) computeReference();
+
+    auto valPtr = jointValues.begin();
+    for(auto ptr = positions.cbegin(); ptr < positions.cend(); ptr++){
+        *valPtr = TO_RADIAN((double) *ptr); // Conversion from servomotor unit to radian
+        valPtr++;
+    }
+
+    if(!frames.empty()) chain.computeFrames(jointValues.data(), frames.data());
+
+    return this;
+}
+
+bool CollisionChecker::selfCollision() const{
+    if(!referenceComputed) return false; // No position computed since last change of the device
+
+    int nbSegments = chain.getNbSegments();
+
+    for(int i = 0; i < nbSegments; i++){
+        for(int j = i + 2; j < nbSegments; j++){
+            if(!ignoredPairs[i * nbSegments + j] && capsulesIntersect(i, j)) return true;
+        }
+    }
+
+    return false;
+}
+
+bool CollisionChecker::workspaceCollision() const{
+    if(!referenceComputed) return false;
+
+    int nbSegments = chain.getNbSegments();
+
+    for(int i = 0; i < nbSegments; i++){
+        if(i > 0 && underTable(i)) return true; // First part stands on the table
+
+        if(workspaceDefined){
+            const double *start, *end;
+            getCapsule(i, start, end);
+
+            for(int k = 0; k < 3; k++){
+                if(std::min(start[k], end[k]) - radius[i] < workspaceMin[k] || std::max(start[k], end[k]) + radius[i] > workspaceMax[k]) return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+bool CollisionChecker::collides(const std::vector<uint16_t>& positions){
+    computeFrames(positions);
+
+    return workspaceCollision() || selfCollision();
+}
+
+
+const Frame& CollisionChecker::getFrame(int segment) const{
+    return frames[segment];
+}
+
+int CollisionChecker::getNbServos() const{
+    return chain.getNbJoints();
+}
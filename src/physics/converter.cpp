@@ -3,14 +3,27 @@
  */
 
 
+#include <cmath>
+#include <algorithm>
+
 #include "converter.h"
 
 using namespace armlearn;
 using namespace kinematics;
 
 
-Converter::Converter():lastCoord(), lastServo(), nbServos(0){
+// Source of the identifiers of the configurations, never given twice so that a copy never shares the identifier of the converter it comes from
+static std::atomic<uint64_t> lastConfiguration(0);
+
+
+Converter::Converter():lastCoord(), lastServo(), servoBuffer(), coordBuffer(), nbServos(0), chain(), forwardMode(solverComputation), servoMin(), servoMax(), trackingIterations(TRACKING_MAX_ITERATIONS), trackingTolerance(TRACKING_TOLERANCE), lastTracking({0, 0, false}){
     device = new KDL::Chain();
+    touch();
+}
+
+Converter::Converter(const Converter& other):lastCoord(other.lastCoord), lastServo(other.lastServo), servoBuffer(), coordBuffer(), nbServos(other.nbServos), chain(other.chain), forwardMode(other.forwardMode), servoMin(other.servoMin), servoMax(other.servoMax), trackingIterations(other.trackingIterations), trackingTolerance(other.trackingTolerance), lastTracking(other.lastTracking){
+    device = new KDL::Chain(*other.device);
+    touch();
 }
 
 Converter::~Converter(){
@@ -18,8 +31,29 @@ Converter::~Converter(){
 }
 
 
+void Converter::touch(){
+    configuration = ++lastConfiguration;
+}
+
+Converter& Converter::scratch() const{
+    Scratch* entry;
+    {
+        std::lock_guard<std::mutex> guard(scratchLock);
+        entry = &clones[std::this_thread::get_id()]; // Elements of the map never move, the entry stays valid once the lock is released
+    }
+
+    if(entry->clone == nullptr || entry->configuration != configuration){
+        entry->clone.reset(clone());
+        entry->configuration = configuration;
+    }
+
+    return *entry->clone;
+}
+
+
 Converter* Converter::addServo(const std::string& name, Axis axis, double lengthX, double lengthY, double lengthZ, double rotationX, double rotationY, double rotationZ){
     nbServos++;
+    touch();
 
     KDL::Joint::JointType joint;
     switch (axis){
@@ -61,17 +95,225 @@ Converter* Converter::addServo(const std::string& name, Axis axis, double length
     rotFrame.DoRotZ(rotationZ);
 
     device->addSegment(KDL::Segment(name, KDL::Joint(joint), KDL::Frame(rotFrame, KDL::Vector(lengthX, lengthY, lengthZ))));
+
+    chain.addSegment(name, axis, lengthX, lengthY, lengthZ, rotationX, rotationY, rotationZ);
+    if(axis != fixed){
+        servoMin.push_back(BASE_MIN);
+        servoMax.push_back(BASE_MAX);
+    }
+
     return this;
 }
 
 Converter* Converter::removeAllServos(){
-    delete device;
-    device = new KDL::Chain();
+    *device = KDL::Chain(); // Same object kept, solvers built on it hold a reference
     nbServos = 0;
+    touch();
+
+    chain.clear();
+    servoMin.clear();
+    servoMax.clear();
+
+    return this;
+}
+
+Converter* Converter::setServoLimits(const std::vector<uint16_t>& minPositions, const std::vector<uint16_t>& maxPositions){
+    if(minPositions.size() != getNbServos() || maxPositions.size() != getNbServos()){
+        std::stringstream errMsg;
+        errMsg << "Limits of sizes " << minPositions.size() << " and " << maxPositions.size() << " do not match the number of servomotors : " << getNbServos();
+
+        throw ComputationError(errMsg.str());
+    }
+
+    servoMin = minPositions;
+    servoMax = maxPositions;
+    touch();
 
     return this;
 }
 
+Converter* Converter::setServoLimits(const communication::AbstractController& controller){
+    std::vector<uint16_t> minPositions;
+    std::vector<uint16_t> maxPositions;
+    for(uint8_t id : controller.getMotorIds()){
+        const communication::Servomotor* servo = controller.showServomotor(id);
+        minPositions.push_back(servo->getMinPosition());
+        maxPositions.push_back(servo->getMaxPosition());
+    }
+
+    return setServoLimits(minPositions, maxPositions);
+}
+
+Converter* Converter::setForwardMode(ForwardMode mode){
+    forwardMode = mode;
+    touch();
+
+    return this;
+}
+
+ForwardMode Converter::getForwardMode() const{
+    return forwardMode;
+}
+
+Converter* Converter::setTrackingLimits(int maxIterations, double tolerance){
+    if(maxIterations < 1) throw ComputationError("Error : the tracking inverse kinematics must run at least one iteration");
+    if(tolerance < 0) throw ComputationError("Error : the tolerance of the tracking inverse kinematics cannot be negative");
+
+    trackingIterations = maxIterations;
+    trackingTolerance = tolerance;
+    touch();
+
+    return this;
+}
+
+TrackingReport Converter::getTrackingReport() const{
+    return lastTracking;
+}
+
+bool Converter::withinLimits(int servo, double position) const{
+    return position > servoMin[servo] && position < servoMax[servo]; // Same bounds as Servomotor::validPosition()
+}
+
+bool Converter::validPosition(const uint16_t* positions) const{
+    if(servoMin.size() != getNbServos()) return true;
+
+    for(int i = 0; i < getNbServos(); i++){
+        if(!withinLimits(i, positions[i])) return false;
+    }
+
+    return true;
+}
+
+
+void Converter::raise(ComputationStatus status, const std::string& computation, int inputSize) const{
+    std::stringstream errMsg;
+    switch(status){
+        case invalidInputSize:
+            errMsg << "Input size " << inputSize << " is invalid for the " << computation << " of a device with " << getNbServos() << " servomotors";
+            throw ComputationError(errMsg.str());
+
+        case undefinedDevice:
+            errMsg << "Device not defined : structure not supported for the " << computation;
+            throw ConverterError(errMsg.str());
+
+        case unreachableTarget:
+            errMsg << "Error : coordinates out of reach of the device for the " << computation;
+            throw ComputationError(errMsg.str());
+
+        default:
+            errMsg << "Error : could not calculate " << computation;
+            throw ComputationError(errMsg.str());
+    }
+}
+
+
+Converter* Converter::computeServoToCoord(const std::vector<uint16_t>& positions){
+    ComputationStatus status = tryServoToCoord(positions, coordBuffer);
+    if(status != computationSucceeded) raise(status, "forward kinematics", positions.size());
+
+    // Save positions
+    lastServo.assign(positions.cbegin(), positions.cend());
+
+    // Save coordinates
+    lastCoord.swap(coordBuffer);
+
+    return this;
+}
+
+Converter* Converter::computeCoordToServo(const std::vector<double>& coordinates){
+    servoBuffer.assign(lastServo.cbegin(), lastServo.cend()); // Starts from the last known position of the device
+    ComputationStatus status = tryCoordToServo(coordinates, servoBuffer);
+    if(status != computationSucceeded) raise(status, "inverse kinematics", coordinates.size());
+
+    // Save coordinates
+    lastCoord.assign(coordinates.cbegin(), coordinates.cend());
+
+    // Save positions
+    lastServo.swap(servoBuffer);
+
+    return this;
+}
+
+Converter* Converter::computeTrackCoord(const std::vector<double>& coordinates){
+    servoBuffer.assign(lastServo.cbegin(), lastServo.cend()); // Starts from the last known position of the device
+    ComputationStatus status = tryTrackCoord(coordinates, servoBuffer, lastTracking);
+    if(status != computationSucceeded) raise(status, "tracking inverse kinematics", coordinates.size());
+
+    // Save coordinates
+    lastCoord.assign(coordinates.cbegin(), coordinates.cend());
+
+    // Save positions
+    lastServo.swap(servoBuffer);
+
+    return this;
+}
+
+
+ComputationStatus Converter::tryTrackCoord(const std::vector<double>& coordinates, std::vector<uint16_t>& positions, TrackingReport& report){
+    ComputationStatus status = tryCoordToServo(coordinates, positions);
+    if(status != computationSucceeded) return status;
+
+    std::vector<double> reached;
+    status = tryServoToCoord(positions, reached);
+    if(status != computationSucceeded) return status;
+
+    double squared = 0;
+    for(int k = 0; k < coordinates.size() && k < reached.size(); k++) squared += std::pow(coordinates[k] - reached[k], 2);
+
+    report.iterations = 0; // Fully solved
+    report.error = std::sqrt(squared);
+    report.converged = report.error <= trackingTolerance;
+
+    return computationSucceeded;
+}
+
+
+ComputationStatus Converter::servoToCoord(const uint16_t* positions, double* coordinates) const{
+    Converter& local = scratch();
+    local.servoBuffer.assign(positions, positions + getNbServos());
+
+    ComputationStatus status = local.tryServoToCoord(local.servoBuffer, local.coordBuffer);
+    if(status == computationSucceeded) std::copy(local.coordBuffer.cbegin(), local.coordBuffer.cend(), coordinates);
+
+    return status;
+}
+
+ComputationStatus Converter::coordToServo(const double* coordinates, uint16_t* positions) const{
+    Converter& local = scratch();
+    local.coordBuffer.assign(coordinates, coordinates + 3);
+    local.servoBuffer.assign(positions, positions + getNbServos());
+
+    ComputationStatus status = local.tryCoordToServo(local.coordBuffer, local.servoBuffer);
+    if(status == computationSucceeded) std::copy(local.servoBuffer.cbegin(), local.servoBuffer.cend(), positions);
+
+    return status;
+}
+
+
+void Converter::computeServoToCoordBatch(const uint16_t* positions, int nbConfigs, double* coordinates, bool withOrientation){
+    if(withOrientation) throw ComputationError("Error : converter cannot compute the orientation of the device");
+
+    int nbPositions = getNbServos();
+    std::vector<uint16_t> config(nbPositions);
+    std::vector<double> res;
+    for(int i = 0; i < nbConfigs; i++){
+        config.assign(positions + (size_t) i * nbPositions, positions + (size_t) (i + 1) * nbPositions);
+
+        ComputationStatus status = tryServoToCoord(config, res);
+        if(status != computationSucceeded) raise(status, "forward kinematics", nbPositions);
+
+        for(int k = 0; k < 3; k++) coordinates[3*i + k] = k < res.size() ? res[k] : 0;
+    }
+}
+
+
+void Converter::computeServoToCoordBatch(const uint16_t* positions, int nbConfigs, float* coordinates){
+    std::vector<double> res((size_t) nbConfigs * 3);
+    computeServoToCoordBatch(positions, nbConfigs, res.data());
+
+    std::copy(res.cbegin(), res.cend(), coordinates);
+}
+
 
 std::vector<double> Converter::getCoord() const{
     return lastCoord;
@@ -9,21 +9,46 @@ using namespace armlearn;
 using namespace kinematics;
 
 
-CylindricalConverter::CylindricalConverter():Converter(), baseDefined(false){
+/**
+ * @brief Converts an angle of the base into the nearest servomotor position, -PI and PI giving the same position
+ *
+ */
+static inline uint16_t baseServo(double angle){
+    long position = std::lround(FROM_RADIAN(std::remainder(angle, 2 * M_PI))); // Between 0 and SERVO_RESOLUTION included
+
+    return (uint16_t) (position % SERVO_RESOLUTION);
+}
+
+
+CylindricalConverter::CylindricalConverter():Converter(), seedCost(jointDistance), baseAxis(fixed), baseDefined(false){
     movingPart = new BasicCartesianConverter();
 
+    for(int s = 0; s < CYLINDRICAL_NB_SEEDS; s++) seedSolvers[s] = new BasicCartesianConverter();
+}
+
+CylindricalConverter::CylindricalConverter(const CylindricalConverter& other):Converter(other), seedCost(other.seedCost), baseAxis(other.baseAxis), baseDefined(other.baseDefined){
+    movingPart = other.movingPart->clone();
+
+    for(int s = 0; s < CYLINDRICAL_NB_SEEDS; s++) seedSolvers[s] = other.seedSolvers[s]->clone();
 }
 
 CylindricalConverter::~CylindricalConverter(){
+    for(int s = 0; s < CYLINDRICAL_NB_SEEDS; s++) delete seedSolvers[s];
+
     delete movingPart;
 }
 
+CylindricalConverter* CylindricalConverter::clone() const{
+    return new CylindricalConverter(*this);
+}
+
 
 Converter* CylindricalConverter::addServo(const std::string& name, Axis axis, double lengthX, double lengthY, double lengthZ, double rotationX, double rotationY, double rotationZ){
-    if(baseDefined)
+    if(baseDefined){
         movingPart->addServo(name, axis, lengthX, lengthY, lengthZ, rotationX, rotationY, rotationZ); 
-        
-    else{
+        for(int s = 0; s < CYLINDRICAL_NB_SEEDS; s++) seedSolvers[s]->addServo(name, axis, lengthX, lengthY, lengthZ, rotationX, rotationY, rotationZ);
+
+    }else{
         if(axis != rotX && axis != rotY && axis != rotZ){
             std::stringstream errMsg;
             errMsg << "Axis of the first servomotor has to be " << rotX << ", " << rotY << " or " << rotZ << " not " << axis;
@@ -32,10 +57,12 @@ Converter* CylindricalConverter::addServo(const std::string& name, Axis axis, do
         }
 
         movingPart->addServo(name, fixed, lengthX, lengthY, lengthZ, rotationX, rotationY, rotationZ);
+        for(int s = 0; s < CYLINDRICAL_NB_SEEDS; s++) seedSolvers[s]->addServo(name, fixed, lengthX, lengthY, lengthZ, rotationX, rotationY, rotationZ);
         baseAxis = axis;
         baseDefined = true;
     }
     if(axis != fixed) nbServos++;
+    touch();
     
     return this;
 }
@@ -44,88 +71,161 @@ Converter* CylindricalConverter::removeAllServos(){
     baseDefined = false;
     nbServos = 0;
     movingPart->removeAllServos();
+    for(int s = 0; s < CYLINDRICAL_NB_SEEDS; s++) seedSolvers[s]->removeAllServos();
+    touch();
 
     return this;
 }
 
+Converter* CylindricalConverter::setForwardMode(ForwardMode mode){
+    Converter::setForwardMode(mode);
+    movingPart->setForwardMode(mode);
 
+    return this;
+}
 
+Converter* CylindricalConverter::setTrackingLimits(int maxIterations, double tolerance){
+    Converter::setTrackingLimits(maxIterations, tolerance);
+    movingPart->setTrackingLimits(maxIterations, tolerance);
 
-Converter* CylindricalConverter::computeServoToCoord(const std::vector<uint16_t>& positions){
-    if(!baseDefined) throw ConverterError("Coordinate system not defined : add a rotational base");
+    return this;
+}
+
+Converter* CylindricalConverter::setSeedCost(const SeedCost& cost){
+    seedCost = cost;
+    touch();
+
+    return this;
+}
+
+double CylindricalConverter::jointDistance(const std::vector<uint16_t>& candidate, const std::vector<uint16_t>& current){
+    if(current.size() != candidate.size()) return 0;
+
+    double res = 0;
+    for(int i = 0; i < candidate.size(); i++) res += std::pow((double) candidate[i] - current[i], 2);
+
+    return res;
+}
+
+double CylindricalConverter::movingOrientation(const std::vector<uint16_t>& positions){
+    movingServo.assign(positions.cbegin() + 1, positions.cend());
+    if(movingPart->tryServoToCoord(movingServo, movingCoord) != computationSucceeded) return 0;
+
+    return std::atan2(movingCoord[1], movingCoord[0]);
+}
 
-    if(positions.size() < 1){
-        std::stringstream errMsg;
-        errMsg << "Input size " << positions.size() << " is invalid : < 1";
 
-        throw ComputationError(errMsg.str());
-    }
+
+
+ComputationStatus CylindricalConverter::tryServoToCoord(const std::vector<uint16_t>& positions, std::vector<double>& coordinates){
+    if(!baseDefined) return undefinedDevice; // Coordinate system not defined : add a rotational base
+
+    if(positions.size() < 1) return invalidInputSize;
 
     // Angle formed by the basis
     double dTeta = TO_RADIAN(positions[0]);
 
     // If system is only composed of a basis
     if(positions.size() < 2){
-        lastServo = std::vector<uint16_t>(positions);
-        lastCoord = {dTeta};
+        coordinates.assign(1, dTeta);
 
-        return this;
+        return computationSucceeded;
     }
 
     // Cartesian computation for the rest of the device
-    std::vector<double> cartCoord = movingPart->computeServoToCoord(std::vector<uint16_t>(positions.begin()+1, positions.end()))->getCoord();
-
+    movingServo.assign(positions.cbegin() + 1, positions.cend()); // Buffers kept between the calls, no allocation once sized
+    ComputationStatus status = movingPart->tryServoToCoord(movingServo, movingCoord);
+    if(status != computationSucceeded) return status;
 
-    // Save positions
-    lastServo = std::vector<uint16_t>(positions);
 
     // Save coordinates
-    lastCoord = {std::sqrt(std::pow(cartCoord[0], 2) + std::pow(cartCoord[1], 2)), (std::atan(cartCoord[1] / cartCoord[0]) + dTeta), cartCoord[2]};
+    coordinates.resize(3);
+    coordinates[0] = std::sqrt(std::pow(movingCoord[0], 2) + std::pow(movingCoord[1], 2));
+    coordinates[1] = std::atan(movingCoord[1] / movingCoord[0]) + dTeta;
+    coordinates[2] = movingCoord[2];
 
-    return this;
+    return computationSucceeded;
 }
 
-Converter* CylindricalConverter::computeCoordToServo(const std::vector<double>& coordinates){
-    if(!baseDefined) throw ConverterError("Coordinate system not defined : add a rotational base");
+ComputationStatus CylindricalConverter::tryCoordToServo(const std::vector<double>& coordinates, std::vector<uint16_t>& positions){
+    if(!baseDefined) return undefinedDevice; // Coordinate system not defined : add a rotational base
 
-    int spaceDim = 3;
-    if(coordinates.size() != 3){
-        std::stringstream errMsg;
-        errMsg << "Input size " << coordinates.size() << " does not match the number of dimensions in the coordinates system : " << spaceDim;
+    if(coordinates.size() != 3) return invalidInputSize;
 
-        throw ComputationError(errMsg.str());
-    }
+    double granularity = 2 * M_PI / CYLINDRICAL_NB_SEEDS; // Granularity of the range checked
+    std::vector<uint16_t> current;
+    if(positions.size() == nbServos) current = positions;
+
+    double start = current.size() > 1 ? movingOrientation(current) : 0; // Range starting from the orientation of the current positions
 
-    bool found = false;
-    double granularity = M_PI / 6; // Granularity of the range checked
-    double dTeta = coordinates[1];
-    std::vector<uint16_t> movPos;
-    std::string errMsg;
-
-    for(double i = 0; i < 2 * M_PI && !found; i += granularity){ // Need to compute for a range of values of the basis
-        try{
-            movPos = movingPart->computeCoordToServo({coordinates[0] * std::cos(i), coordinates[0] * std::sin(i), coordinates[2]})->getServo();
-
-            dTeta = dTeta - i;
-            found = true;
-        }catch(ComputationError e){ // Computation did not succeed, have to try again for another value of teta
-            errMsg = e.what();
-            
+    std::vector<uint16_t> candidates[CYLINDRICAL_NB_SEEDS];
+
+    #pragma omp parallel for schedule(dynamic)
+    for(int s = 0; s < CYLINDRICAL_NB_SEEDS; s++){ // Need to compute for a range of values of the basis
+        double i = start + s * granularity;
+
+        if(current.size() > 1) candidates[s].assign(current.begin()+1, current.end()); // Starts from the current positions
+        if(seedSolvers[s]->tryCoordToServo({coordinates[0] * std::cos(i), coordinates[0] * std::sin(i), coordinates[2]}, candidates[s]) == computationSucceeded){
+            candidates[s].insert(candidates[s].begin(), baseServo(coordinates[1] - i));
+        }else{ // Computation did not succeed for this value of teta
+            candidates[s].clear();
         }
     }
 
+    // Choice of the best solution
+    int best = -1;
+    double bestCost = 0;
+    for(int s = 0; s < CYLINDRICAL_NB_SEEDS; s++){
+        if(candidates[s].empty()) continue;
 
-    if(!found) throw ComputationError(errMsg);
-    
+        double cost = seedCost(candidates[s], current);
+        if(best < 0 || cost < bestCost){
+            best = s;
+            bestCost = cost;
+        }
+    }
 
-    // Save coordinates
-    lastCoord = std::vector<double>(coordinates);
+    if(best < 0) return noSolutionFound;
+    
 
     // Save positions
-    lastServo = std::vector<uint16_t>(movPos);
-    lastServo.insert(lastServo.begin(), FROM_RADIAN(dTeta));
+    positions.swap(candidates[best]);
 
-    return this;
+    return computationSucceeded;
 }
 
 
+ComputationStatus CylindricalConverter::tryTrackCoord(const std::vector<double>& coordinates, std::vector<uint16_t>& positions, TrackingReport& report){
+    if(!baseDefined || nbServos < 2) return undefinedDevice; // Coordinate system not defined : add a rotational base and a moving part
+
+    if(coordinates.size() != 3) return invalidInputSize;
+
+    if(positions.size() != nbServos){ // No previous solution to start from
+        ComputationStatus status = tryCoordToServo(coordinates, positions);
+        if(status != computationSucceeded) return status;
+
+        // Error measured in cartesian coordinates, the moving part being rotated by the base
+        double orientation = movingOrientation(positions) + TO_RADIAN(positions[0]);
+        double radius = std::sqrt(std::pow(movingCoord[0], 2) + std::pow(movingCoord[1], 2));
+
+        report.iterations = 0;
+        report.error = std::sqrt(std::pow(radius * std::cos(orientation) - coordinates[0] * std::cos(coordinates[1]), 2) + std::pow(radius * std::sin(orientation) - coordinates[0] * std::sin(coordinates[1]), 2) + std::pow(movingCoord[2] - coordinates[2], 2));
+        report.converged = report.error <= trackingTolerance;
+
+        return computationSucceeded;
+    }
+
+    // Orientation of the moving part kept, the base turning toward the target
+    double orientation = movingOrientation(positions);
+    movingCoord.assign({coordinates[0] * std::cos(orientation), coordinates[0] * std::sin(orientation), coordinates[2]});
+
+    ComputationStatus status = movingPart->tryTrackCoord(movingCoord, movingServo, report);
+    if(status != computationSucceeded) return status;
+
+
+    // Save positions
+    positions[0] = baseServo(coordinates[1] - orientation);
+    std::copy(movingServo.cbegin(), movingServo.cend(), positions.begin() + 1);
+
+    return computationSucceeded;
+}
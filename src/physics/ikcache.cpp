@@ -0,0 +1,126 @@
+/**
+ * @copyright Copyright (c) 2019
+ */
+
+
+#include <cmath>
+
+#include "ikcache.h"
+
+using namespace armlearn;
+using namespace kinematics;
+
+
+bool IKCache::Key::operator==(const Key& other) const{
+    return cell[0] == other.cell[0] && cell[1] == other.cell[1] && cell[2] == other.cell[2];
+}
+
+size_t IKCache::KeyHash::operator()(const Key& key) const{
+    uint64_t hash = 14695981039346656037ULL; // FNV-1a over the 3 cells
+    for(int k = 0; k < 3; k++){
+        hash ^= (uint64_t) key.cell[k];
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+
+
+IKCache::IKCache(size_t maxSize, double cellSize):capacity(maxSize < 1 ? 1 : maxSize), resolution(cellSize), hits(0), misses(0){
+    lookup.reserve(capacity);
+}
+
+IKCache::~IKCache(){
+
+}
+
+
+bool IKCache::toKey(const std::vector<double>& coordinates, Key& key) const{
+    if(coordinates.size() < 3) return false;
+
+    for(int k = 0; k < 3; k++){
+        double cell = std::floor(coordinates[k] / resolution);
+        if(!std::isfinite(cell) || std::fabs(cell) > 1e15) return false;
+
+        key.cell[k] = (int64_t) cell;
+    }
+
+    return true;
+}
+
+
+bool IKCache::find(const std::vector<double>& coordinates, std::vector<uint16_t>& positions){
+    Key key;
+    bool valid = toKey(coordinates, key);
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    auto it = valid ? lookup.find(key) : lookup.end();
+    if(it == lookup.end()){
+        misses++;
+        return false;
+    }
+
+    entries.splice(entries.begin(), entries, it->second); // Becomes the most recently used
+    positions = it->second->second;
+    hits++;
+
+    return true;
+}
+
+void IKCache::insert(const std::vector<double>& coordinates, const std::vector<uint16_t>& positions){
+    Key key;
+    if(!toKey(coordinates, key)) return;
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    auto it = lookup.find(key);
+    if(it != lookup.end()){
+        it->second->second = positions;
+        entries.splice(entries.begin(), entries, it->second);
+        return;
+    }
+
+    if(entries.size() >= capacity){ // Drops the least recently used result
+        lookup.erase(entries.back().first);
+        entries.pop_back();
+    }
+
+    entries.emplace_front(key, positions);
+    lookup[key] = entries.begin();
+}
+
+void IKCache::clear(){
+    std::lock_guard<std::mutex> guard(lock);
+
+    entries.clear();
+    lookup.clear();
+}
+
+
+size_t IKCache::size() const{
+    std::lock_guard<std::mutex> guard(lock);
+
+    return entries.size();
+}
+
+size_t IKCache::getCapacity() const{
+    return capacity;
+}
+
+double IKCache::getResolution() const{
+    return resolution;
+}
+
+uint64_t IKCache::getHits() const{
+    std::lock_guard<std::mutex> guard(lock);
+
+    return hits;
+}
+
+uint64_t IKCache::getMisses() const{
+    std::lock_guard<std::mutex> guard(lock);
+
+    return misses;
+}
@@ -0,0 +1,504 @@
+/**
+ * @copyright Copyright (c) 2019
+ */
+
+
+#include <cmath>
+#include <algorithm>
+
+#include "kinematicchain.h"
+#include "range.h"
+
+using namespace armlearn;
+using namespace kinematics;
+
+
+/**
+ * @brief Multiplies two rotation matrices stored row by row (res = a * b)
+ *
+ */
+static inline void multiplyRotations(const double* a, const double* b, double* res){
+    for(int i = 0; i < 3; i++){
+        for(int j = 0; j < 3; j++){
+            res[3*i + j] = a[3*i] * b[j] + a[3*i + 1] * b[3 + j] + a[3*i + 2] * b[6 + j];
+        }
+    }
+}
+
+/**
+ * @brief Sines and cosines of the angles of all servomotor positions
+ *
+ */
+template<typename Scalar>
+struct TrigTable{
+    Scalar cosines[SERVO_RESOLUTION];
+    Scalar sines[SERVO_RESOLUTION];
+
+    TrigTable(){
+        for(int i = 0; i < SERVO_RESOLUTION; i++){
+            cosines[i] = std::cos(TO_RADIAN((double) i));
+            sines[i] = std::sin(TO_RADIAN((double) i));
+        }
+    }
+};
+
+static const TrigTable<double> trigTable;
+static const TrigTable<float> trigTableSingle;
+
+
+/**
+ * @brief Rotates the rotation matrix along one of its own axis, given the cosine and sine of the angle (rot = rot * R(axis, angle))
+ *
+ */
+static inline void rotateAlong(double* rot, Axis axis, double c, double s){
+    int a, b; // Columns modified by the rotation
+    switch(axis){
+        case rotX:
+            a = 1; b = 2;
+            break;
+
+        case rotY:
+            a = 2; b = 0;
+            break;
+
+        case rotZ:
+            a = 0; b = 1;
+            break;
+
+        default:
+            return;
+    }
+
+    for(int i = 0; i < 3; i++){
+        double ca = rot[3*i + a];
+        double cb = rot[3*i + b];
+        rot[3*i + a] = c * ca + s * cb;
+        rot[3*i + b] = c * cb - s * ca;
+    }
+}
+
+/**
+ * @brief Rotates the rotation matrix along one of its own axis (rot = rot * R(axis, angle))
+ *
+ */
+static inline void rotateAlong(double* rot, Axis axis, double angle){
+    rotateAlong(rot, axis, std::cos(angle), std::sin(angle));
+}
+
+
+/**
+ * @brief Moves a frame through the rigid part of a segment (frame = frame * part), moved being the frame after the joint
+ *
+ */
+static inline void moveThroughPart(const double* partRot, const double* partTrans, const double* moved, double* rot, double* pos){
+    // Translation expressed in the moved frame, then fixed rotation of the part
+    for(int i = 0; i < 3; i++) pos[i] += moved[3*i] * partTrans[0] + moved[3*i + 1] * partTrans[1] + moved[3*i + 2] * partTrans[2];
+    multiplyRotations(moved, partRot, rot);
+}
+
+/**
+ * @brief Moves a frame through an arm part (frame = frame * joint(value) * part), returns the number of joint values used
+ *
+ */
+static inline int moveThrough(Axis axis, const double* partRot, const double* partTrans, const double* jointValues, double* rot, double* pos){
+    double moved[9];
+    std::copy(rot, rot + 9, moved);
+
+    int used = 0;
+    switch(axis){
+        case rotX:
+        case rotY:
+        case rotZ:
+            rotateAlong(moved, axis, *jointValues);
+            used = 1;
+            break;
+
+        case transX:
+        case transY:
+        case transZ:
+            for(int i = 0; i < 3; i++) pos[i] += moved[3*i + (axis - transX)] * *jointValues;
+            used = 1;
+            break;
+
+        case fixed:
+        default:
+            break;
+    }
+
+    moveThroughPart(partRot, partTrans, moved, rot, pos);
+    return used;
+}
+
+/**
+ * @brief Moves a frame through an arm part given the position of its servomotor, sines and cosines being read from the tables
+ *
+ */
+static inline int moveThroughServo(Axis axis, const double* partRot, const double* partTrans, const uint16_t* positions, double* rot, double* pos){
+    double moved[9];
+    std::copy(rot, rot + 9, moved);
+
+    int used = 0;
+    switch(axis){
+        case rotX:
+        case rotY:
+        case rotZ:{
+            int index = *positions & (SERVO_RESOLUTION - 1); // Position SERVO_RESOLUTION is the same angle as 0
+            rotateAlong(moved, axis, trigTable.cosines[index], trigTable.sines[index]);
+            used = 1;
+            break;
+        }
+
+        case transX:
+        case transY:
+        case transZ:
+            for(int i = 0; i < 3; i++) pos[i] += moved[3*i + (axis - transX)] * TO_RADIAN((double) *positions);
+            used = 1;
+            break;
+
+        case fixed:
+        default:
+            break;
+    }
+
+    moveThroughPart(partRot, partTrans, moved, rot, pos);
+    return used;
+}
+
+
+
+KinematicChain::KinematicChain():segments(), nbJoints(0){
+
+}
+
+KinematicChain::~KinematicChain(){
+
+}
+
+
+void KinematicChain::addSegment(const std::string& name, Axis axis, double lengthX, double lengthY, double lengthZ, double rotationX, double rotationY, double rotationZ){
+    Segment seg;
+    seg.name = name;
+    seg.axis = axis;
+
+    // Same composition as KDL::Rotation::DoRotX, DoRotY then DoRotZ
+    double identity[9] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+    std::copy(identity, identity + 9, seg.rot);
+    rotateAlong(seg.rot, rotX, rotationX);
+    rotateAlong(seg.rot, rotY, rotationY);
+    rotateAlong(seg.rot, rotZ, rotationZ);
+
+    seg.trans[0] = lengthX;
+    seg.trans[1] = lengthY;
+    seg.trans[2] = lengthZ;
+
+    std::copy(seg.rot, seg.rot + 9, seg.rotSingle);
+    std::copy(seg.trans, seg.trans + 3, seg.transSingle);
+
+    segments.push_back(seg);
+    if(axis != fixed) nbJoints++;
+}
+
+void KinematicChain::clear(){
+    segments.clear();
+    nbJoints = 0;
+}
+
+
+int KinematicChain::getNbSegments() const{
+    return segments.size();
+}
+
+int KinematicChain::getNbJoints() const{
+    return nbJoints;
+}
+
+Axis KinematicChain::getAxis(int segment) const{
+    return segments[segment].axis;
+}
+
+const std::string& KinematicChain::getName(int segment) const{
+    return segments[segment].name;
+}
+
+
+void KinematicChain::computeFrames(const double* jointValues, Frame* frames) const{
+    double rot[9] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+    double pos[3] = {0, 0, 0};
+
+    for(auto ptr = segments.cbegin(); ptr < segments.cend(); ptr++){
+        jointValues += moveThrough(ptr->axis, ptr->rot, ptr->trans, jointValues, rot, pos);
+
+        std::copy(rot, rot + 9, frames->rot);
+        std::copy(pos, pos + 3, frames->pos);
+        frames++;
+    }
+}
+
+void KinematicChain::computeTip(const double* jointValues, Frame& tip) const{
+    double rot[9] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+    double pos[3] = {0, 0, 0};
+
+    for(auto ptr = segments.cbegin(); ptr < segments.cend(); ptr++){
+        jointValues += moveThrough(ptr->axis, ptr->rot, ptr->trans, jointValues, rot, pos);
+    }
+
+    std::copy(rot, rot + 9, tip.rot);
+    std::copy(pos, pos + 3, tip.pos);
+}
+
+void KinematicChain::computeJacobianColumns(const double* jointValues, const double* tip, double* jacobian, bool angular) const{
+    double rot[9] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+    double pos[3] = {0, 0, 0};
+
+    int column = 0;
+    for(auto ptr = segments.cbegin(); ptr < segments.cend(); ptr++){
+        if(ptr->axis != fixed){
+            double axis[3]; // Axis of the joint in the base frame, not changed by the motion of the joint itself
+            int index = (ptr->axis - rotX) % 3;
+            for(int i = 0; i < 3; i++) axis[i] = rot[3*i + index];
+
+            double* linear = jacobian + column;
+            double* rotation = jacobian + 3 * nbJoints + column;
+            if(ptr->axis == rotX || ptr->axis == rotY || ptr->axis == rotZ){
+                double arm[3] = {tip[0] - pos[0], tip[1] - pos[1], tip[2] - pos[2]};
+
+                linear[0] = axis[1] * arm[2] - axis[2] * arm[1];
+                linear[nbJoints] = axis[2] * arm[0] - axis[0] * arm[2];
+                linear[2 * nbJoints] = axis[0] * arm[1] - axis[1] * arm[0];
+                if(angular) for(int i = 0; i < 3; i++) rotation[i * nbJoints] = axis[i];
+            }else{
+                for(int i = 0; i < 3; i++) linear[i * nbJoints] = axis[i];
+                if(angular) for(int i = 0; i < 3; i++) rotation[i * nbJoints] = 0;
+            }
+
+            column++;
+        }
+
+        jointValues += moveThrough(ptr->axis, ptr->rot, ptr->trans, jointValues, rot, pos);
+    }
+}
+
+void KinematicChain::computeJacobian(const double* jointValues, double* jacobian) const{
+    Frame tip;
+    computeTip(jointValues, tip);
+
+    computeJacobianColumns(jointValues, tip.pos, jacobian, true);
+}
+
+void KinematicChain::computePositionGradient(const double* jointValues, double* position, double* gradient) const{
+    Frame tip;
+    computeTip(jointValues, tip);
+    std::copy(tip.pos, tip.pos + 3, position);
+
+    computeJacobianColumns(jointValues, tip.pos, gradient, false);
+}
+
+void KinematicChain::computeTipFromServo(const uint16_t* positions, Frame& tip) const{
+    double rot[9] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+    double pos[3] = {0, 0, 0};
+
+    for(auto ptr = segments.cbegin(); ptr < segments.cend(); ptr++){
+        positions += moveThroughServo(ptr->axis, ptr->rot, ptr->trans, positions, rot, pos);
+    }
+
+    std::copy(rot, rot + 9, tip.rot);
+    std::copy(pos, pos + 3, tip.pos);
+}
+
+void KinematicChain::computeTips(const double* jointValues, int nbConfigs, Frame* tips) const{
+    // Block of configurations stored lane by lane, so that each operation is a loop over the lanes
+    double rot[9][CHAIN_BATCH_LANES];
+    double pos[3][CHAIN_BATCH_LANES];
+    double cosines[CHAIN_BATCH_LANES];
+    double sines[CHAIN_BATCH_LANES];
+    double values[CHAIN_BATCH_LANES];
+
+    for(int start = 0; start < nbConfigs; start += CHAIN_BATCH_LANES){
+        int lanes = std::min(CHAIN_BATCH_LANES, nbConfigs - start);
+        const double* blockValues = jointValues + (size_t) start * nbJoints;
+
+        for(int k = 0; k < 9; k++){
+            #pragma omp simd
+            for(int l = 0; l < CHAIN_BATCH_LANES; l++) rot[k][l] = (k % 4 == 0) ? 1 : 0;
+        }
+        for(int k = 0; k < 3; k++){
+            #pragma omp simd
+            for(int l = 0; l < CHAIN_BATCH_LANES; l++) pos[k][l] = 0;
+        }
+
+        int joint = 0;
+        for(auto ptr = segments.cbegin(); ptr < segments.cend(); ptr++){
+            Axis axis = ptr->axis;
+
+            if(axis != fixed){
+                for(int l = 0; l < CHAIN_BATCH_LANES; l++) values[l] = l < lanes ? blockValues[(size_t) l * nbJoints + joint] : 0; // Unused lanes computed with null values
+                joint++;
+            }
+
+            switch(axis){
+                case rotX:
+                case rotY:
+                case rotZ:{
+                    for(int l = 0; l < CHAIN_BATCH_LANES; l++){
+                        cosines[l] = std::cos(values[l]);
+                        sines[l] = std::sin(values[l]);
+                    }
+
+                    int a = (axis == rotX) ? 1 : (axis == rotY ? 2 : 0); // Same columns as in rotateAlong()
+                    int b = (axis == rotX) ? 2 : (axis == rotY ? 0 : 1);
+                    for(int i = 0; i < 3; i++){
+                        double* ca = rot[3*i + a];
+                        double* cb = rot[3*i + b];
+
+                        #pragma omp simd
+                        for(int l = 0; l < CHAIN_BATCH_LANES; l++){
+                            double va = ca[l];
+                            double vb = cb[l];
+                            ca[l] = cosines[l] * va + sines[l] * vb;
+                            cb[l] = cosines[l] * vb - sines[l] * va;
+                        }
+                    }
+                    break;
+                }
+
+                case transX:
+                case transY:
+                case transZ:
+                    for(int i = 0; i < 3; i++){
+                        const double* column = rot[3*i + (axis - transX)];
+
+                        #pragma omp simd
+                        for(int l = 0; l < CHAIN_BATCH_LANES; l++) pos[i][l] += column[l] * values[l];
+                    }
+                    break;
+
+                case fixed:
+                default:
+                    break;
+            }
+
+            // Translation expressed in the moved frame, then fixed rotation of the part
+            const double* trans = ptr->trans;
+            const double* partRot = ptr->rot;
+            for(int i = 0; i < 3; i++){
+                double* r0 = rot[3*i];
+                double* r1 = rot[3*i + 1];
+                double* r2 = rot[3*i + 2];
+
+                #pragma omp simd
+                for(int l = 0; l < CHAIN_BATCH_LANES; l++){
+                    pos[i][l] += r0[l] * trans[0] + r1[l] * trans[1] + r2[l] * trans[2];
+
+                    double m0 = r0[l], m1 = r1[l], m2 = r2[l];
+                    r0[l] = m0 * partRot[0] + m1 * partRot[3] + m2 * partRot[6];
+                    r1[l] = m0 * partRot[1] + m1 * partRot[4] + m2 * partRot[7];
+                    r2[l] = m0 * partRot[2] + m1 * partRot[5] + m2 * partRot[8];
+                }
+            }
+        }
+
+        for(int l = 0; l < lanes; l++){
+            Frame& tip = tips[start + l];
+            for(int k = 0; k < 9; k++) tip.rot[k] = rot[k][l];
+            for(int k = 0; k < 3; k++) tip.pos[k] = pos[k][l];
+        }
+    }
+}
+
+void KinematicChain::computePositionsFromServo(const uint16_t* positions, int nbConfigs, float* coordinates) const{
+    // Same computation as computeTips(), the block of configurations being stored lane by lane
+    float rot[9][CHAIN_BATCH_LANES_SINGLE];
+    float pos[3][CHAIN_BATCH_LANES_SINGLE];
+    float cosines[CHAIN_BATCH_LANES_SINGLE];
+    float sines[CHAIN_BATCH_LANES_SINGLE];
+    float values[CHAIN_BATCH_LANES_SINGLE];
+
+    for(int start = 0; start < nbConfigs; start += CHAIN_BATCH_LANES_SINGLE){
+        int lanes = std::min(CHAIN_BATCH_LANES_SINGLE, nbConfigs - start);
+        const uint16_t* blockPositions = positions + (size_t) start * nbJoints;
+
+        for(int k = 0; k < 9; k++){
+            #pragma omp simd
+            for(int l = 0; l < CHAIN_BATCH_LANES_SINGLE; l++) rot[k][l] = (k % 4 == 0) ? 1 : 0;
+        }
+        for(int k = 0; k < 3; k++){
+            #pragma omp simd
+            for(int l = 0; l < CHAIN_BATCH_LANES_SINGLE; l++) pos[k][l] = 0;
+        }
+
+        int joint = 0;
+        for(auto ptr = segments.cbegin(); ptr < segments.cend(); ptr++){
+            Axis axis = ptr->axis;
+
+            switch(axis){
+                case rotX:
+                case rotY:
+                case rotZ:{
+                    for(int l = 0; l < CHAIN_BATCH_LANES_SINGLE; l++){
+                        int index = l < lanes ? blockPositions[(size_t) l * nbJoints + joint] & (SERVO_RESOLUTION - 1) : 0; // Unused lanes computed with null angles
+                        cosines[l] = trigTableSingle.cosines[index];
+                        sines[l] = trigTableSingle.sines[index];
+                    }
+
+                    int a = (axis == rotX) ? 1 : (axis == rotY ? 2 : 0); // Same columns as in rotateAlong()
+                    int b = (axis == rotX) ? 2 : (axis == rotY ? 0 : 1);
+                    for(int i = 0; i < 3; i++){
+                        float* ca = rot[3*i + a];
+                        float* cb = rot[3*i + b];
+
+                        #pragma omp simd
+                        for(int l = 0; l < CHAIN_BATCH_LANES_SINGLE; l++){
+                            float va = ca[l];
+                            float vb = cb[l];
+                            ca[l] = cosines[l] * va + sines[l] * vb;
+                            cb[l] = cosines[l] * vb - sines[l] * va;
+                        }
+                    }
+                    break;
+                }
+
+                case transX:
+                case transY:
+                case transZ:
+                    for(int l = 0; l < CHAIN_BATCH_LANES_SINGLE; l++) values[l] = l < lanes ? TO_RADIAN((float) blockPositions[(size_t) l * nbJoints + joint]) : 0; // Same unit as computeTipFromServo()
+
+                    for(int i = 0; i < 3; i++){
+                        const float* column = rot[3*i + (axis - transX)];
+
+                        #pragma omp simd
+                        for(int l = 0; l < CHAIN_BATCH_LANES_SINGLE; l++) pos[i][l] += column[l] * values[l];
+                    }
+                    break;
+
+                case fixed:
+                default:
+                    break;
+            }
+            if(axis != fixed) joint++;
+
+            // Translation expressed in the moved frame, then fixed rotation of the part
+            const float* trans = ptr->transSingle;
+            const float* partRot = ptr->rotSingle;
+            for(int i = 0; i < 3; i++){
+                float* r0 = rot[3*i];
+                float* r1 = rot[3*i + 1];
+                float* r2 = rot[3*i + 2];
+
+                #pragma omp simd
+                for(int l = 0; l < CHAIN_BATCH_LANES_SINGLE; l++){
+                    pos[i][l] += r0[l] * trans[0] + r1[l] * trans[1] + r2[l] * trans[2];
+
+                    float m0 = r0[l], m1 = r1[l], m2 = r2[l];
+                    r0[l] = m0 * partRot[0] + m1 * partRot[3] + m2 * partRot[6];
+                    r1[l] = m0 * partRot[1] + m1 * partRot[4] + m2 * partRot[7];
+                    r2[l] = m0 * partRot[2] + m1 * partRot[5] + m2 * partRot[8];
+                }
+            }
+        }
+
+        for(int l = 0; l < lanes; l++){
+            float* res = coordinates + (size_t) (start + l) * 3;
+            for(int k = 0; k < 3; k++) res[k] = pos[k][l];
+        }
+    }
+}
@@ -9,16 +9,28 @@ using namespace armlearn;
 using namespace kinematics;
 
 
-OptimCartesianConverter::OptimCartesianConverter():CartesianConverter(), rotatingBase(false), baseDefined(false){
+OptimCartesianConverter::OptimCartesianConverter():CartesianConverter(), rotatingBase(false), baseDefined(false), cache(nullptr), cacheConfiguration(configuration.load()){
     converters[0] = new BasicCartesianConverter();
     converters[1] = new CylindricalConverter();
 }
 
+OptimCartesianConverter::OptimCartesianConverter(const OptimCartesianConverter& other):CartesianConverter(other), rotatingBase(other.rotatingBase), baseDefined(other.baseDefined), cache(other.cache), cacheConfiguration(configuration.load()){ // Same device and settings, the results of the cache stay valid for the copy
+    // Copies made for the const queries after a change of the converter, the cache must be emptied as by tryCoordToServo()
+    if(cache != nullptr && other.cacheConfiguration.exchange(other.configuration) != other.configuration) cache->clear();
+
+    converters[0] = other.converters[0]->clone();
+    converters[1] = other.converters[1]->clone();
+}
+
 OptimCartesianConverter::~OptimCartesianConverter(){
     delete converters[1];
     delete converters[0];
 }
 
+OptimCartesianConverter* OptimCartesianConverter::clone() const{
+    return new OptimCartesianConverter(*this);
+}
+
 
 Converter* OptimCartesianConverter::addServo(const std::string& name, Axis axis, double lengthX, double lengthY, double lengthZ, double rotationX, double rotationY, double rotationZ){
     if(!baseDefined){
@@ -27,18 +39,36 @@ Converter* OptimCartesianConverter::addServo(const std::string& name, Axis axis,
     }
 
     converters[rotatingBase]->addServo(name, axis, lengthX, lengthY, lengthZ, rotationX, rotationY, rotationZ);
+    Converter::addServo(name, axis, lengthX, lengthY, lengthZ, rotationX, rotationY, rotationZ); // Keeps the whole device for batch computations
+    if(cache != nullptr) cache->clear();
+
     return this;
 }
 
 Converter* OptimCartesianConverter::removeAllServos(){
     converters[rotatingBase]->removeAllServos();
+    Converter::removeAllServos();
     baseDefined = false;
+    if(cache != nullptr) cache->clear();
+
+    return this;
+}
+
+Converter* OptimCartesianConverter::setCache(IKCache* ikCache){
+    cache = ikCache;
+    if(cache != nullptr) cache->clear();
+    touch();
+    cacheConfiguration = configuration.load();
 
     return this;
 }
 
+IKCache* OptimCartesianConverter::getCache() const{
+    return cache;
+}
 
-std::vector<double> OptimCartesianConverter::convertCoordToCylindricalSystem(std::vector<double> cartCoord){
+
+void OptimCartesianConverter::convertCoordToCylindricalSystem(const std::vector<double>& cartCoord, std::vector<double>& cylCoord) const{
     if(cartCoord.size() != 3){
         std::stringstream errMsg;
         errMsg << "Input size " << cartCoord.size() << " is invalid : < 1";
@@ -46,17 +76,15 @@ std::vector<double> OptimCartesianConverter::convertCoordToCylindricalSystem(std
         throw ComputationError(errMsg.str());
     }
 
-    std::vector<double> res(3);
-
-    res[0] = std::sqrt(std::pow(cartCoord[0], 2) + std::pow(cartCoord[1], 2));
-    res[1] = std::atan(cartCoord[1] / cartCoord[0]);
-    res[2] = cartCoord[2];
-
+    double x = cartCoord[0], y = cartCoord[1], z = cartCoord[2];
+    cylCoord.resize(3);
 
-    return res;
+    cylCoord[0] = std::sqrt(std::pow(x, 2) + std::pow(y, 2));
+    cylCoord[1] = std::atan(y / x);
+    cylCoord[2] = z;
 }
 
-std::vector<double> OptimCartesianConverter::convertCoordFromCylindricalSystem(std::vector<double> cylCoord){
+void OptimCartesianConverter::convertCoordFromCylindricalSystem(const std::vector<double>& cylCoord, std::vector<double>& cartCoord) const{
     if(cylCoord.size() != 3){
         std::stringstream errMsg;
         errMsg << "Input size " << cylCoord.size() << " is invalid : < 1";
@@ -64,40 +92,68 @@ std::vector<double> OptimCartesianConverter::convertCoordFromCylindricalSystem(s
         throw ComputationError(errMsg.str());
     }
 
-    std::vector<double> res(3);
+    double radius = cylCoord[0], teta = cylCoord[1], z = cylCoord[2];
+    cartCoord.resize(3);
 
-    res[0] = cylCoord[0] * std::cos(cylCoord[1]);
-    res[1] = cylCoord[0] * std::sin(cylCoord[1]);
-    res[2] = cylCoord[2];
+    cartCoord[0] = radius * std::cos(teta);
+    cartCoord[1] = radius * std::sin(teta);
+    cartCoord[2] = z;
+}
 
 
-    return res;
-}
 
 
+ComputationStatus OptimCartesianConverter::tryServoToCoord(const std::vector<uint16_t>& positions, std::vector<double>& coordinates){
 
+    // Computation from the precomputed tables over the whole device, directly in cartesian system
+    if(forwardMode == tableComputation || forwardMode == singlePrecisionComputation){
+        if(positions.size() != chain.getNbJoints()) return invalidInputSize;
 
-Converter* OptimCartesianConverter::computeServoToCoord(const std::vector<uint16_t>& positions){
+        if(forwardMode == singlePrecisionComputation){
+            float tip[3];
+            chain.computePositionsFromServo(positions.data(), 1, tip);
 
-    // Save positions
-    lastServo = std::vector<uint16_t>(positions);
+            coordinates.assign(tip, tip + 3);
+
+            return computationSucceeded;
+        }
+
+        Frame tip;
+        chain.computeTipFromServo(positions.data(), tip);
+
+        coordinates.assign(tip.pos, tip.pos + 3);
+
+        return computationSucceeded;
+    }
 
     // Save coordinates
-    lastCoord = converters[rotatingBase]->computeServoToCoord(positions)->getCoord();
-    if(rotatingBase) lastCoord = convertCoordFromCylindricalSystem(lastCoord); // Need to convert from cylindrical to cartesian
+    ComputationStatus status = converters[rotatingBase]->tryServoToCoord(positions, coordinates);
+    if(status != computationSucceeded) return status;
+    if(coordinates.size() != 3) return invalidInputSize; // Device only composed of a base
+    if(rotatingBase) convertCoordFromCylindricalSystem(coordinates, coordinates); // Need to convert from cylindrical to cartesian
 
-    return this;
+    return computationSucceeded;
 }
 
-Converter* OptimCartesianConverter::computeCoordToServo(const std::vector<double>& coordinates){
+ComputationStatus OptimCartesianConverter::tryCoordToServo(const std::vector<double>& coordinates, std::vector<uint16_t>& positions){
+    if(coordinates.size() != 3) return invalidInputSize;
+    if(outOfReach(coordinates.data())) return unreachableTarget; // Rejected before running any solver
 
-    // Save coordinates
-    lastCoord = std::vector<double>(coordinates);
+    // Results computed before the last change of the converter (device, limits, solver...) are no longer valid
+    if(cache != nullptr && cacheConfiguration != configuration){
+        cache->clear();
+        cacheConfiguration = configuration.load();
+    }
+
+    // Result already computed for close coordinates
+    if(cache != nullptr && cache->find(coordinates, positions)) return computationSucceeded;
 
     // Save positions
-    lastServo = converters[rotatingBase]->computeCoordToServo(rotatingBase ? convertCoordToCylindricalSystem(coordinates) : coordinates)->getServo(); // Need to convert from cartesian to cylindrical
+    if(rotatingBase) convertCoordToCylindricalSystem(coordinates, cylindricalBuffer); // Need to convert from cartesian to cylindrical
+    ComputationStatus status = converters[rotatingBase]->tryCoordToServo(rotatingBase ? cylindricalBuffer : coordinates, positions);
+    if(status == computationSucceeded && cache != nullptr) cache->insert(coordinates, positions);
 
-    return this;
+    return status;
 }
 
 int OptimCartesianConverter::getNbServos() const{
@@ -0,0 +1,200 @@
+/**
+ * @copyright Copyright (c) 2019
+ */
+
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include "reachabilitymap.h"
+
+using namespace armlearn;
+using namespace kinematics;
+
+
+ReachabilityMap::ReachabilityMap(){
+    clear();
+}
+
+ReachabilityMap::~ReachabilityMap(){
+
+}
+
+
+void ReachabilityMap::clear(){
+    std::fill(center, center + 3, 0);
+    minRadius = 0;
+    maxRadius = std::numeric_limits<double>::infinity();
+    margin = 0;
+
+    std::fill(origin, origin + 3, 0);
+    std::fill(dims, dims + 3, 0);
+    voxelSize = 0;
+    bitmap.clear();
+}
+
+
+void ReachabilityMap::build(const CartesianConverter& converter, const std::vector<uint16_t>& minPositions, const std::vector<uint16_t>& maxPositions, const std::vector<int>& nbSamples, const std::vector<double>& shellCenter, double voxelSize){
+    int nbServos = converter.getNbServos();
+    if(minPositions.size() != nbServos || maxPositions.size() != nbServos || nbSamples.size() != nbServos){
+        std::stringstream errMsg;
+        errMsg << "Sampling bounds of sizes " << minPositions.size() << ", " << maxPositions.size() << " and " << nbSamples.size() << " do not match the number of servomotors : " << nbServos;
+
+        throw ComputationError(errMsg.str());
+    }
+    if(shellCenter.size() != 3) throw ComputationError("Error : the center of the reachability shell must have 3 coordinates");
+    if(voxelSize < 0) throw ComputationError("Error : the cells of the reachability bitmap cannot have a negative size");
+
+    uint64_t nbEntries = 1;
+    for(int s = 0; s < nbServos; s++){
+        if(nbSamples[s] < 1) throw ComputationError("Error : each servomotor must be sampled at least once");
+
+        nbEntries *= nbSamples[s];
+    }
+
+    clear();
+    std::copy(shellCenter.cbegin(), shellCenter.cend(), center);
+
+    // Sampled positions of each servomotor, and largest distance between any position and the closest sample
+    std::vector<std::vector<uint16_t>> samples(nbServos);
+    std::vector<double> halfSteps(nbServos);
+    for(int s = 0; s < nbServos; s++){
+        if(nbSamples[s] == 1){
+            samples[s].push_back((minPositions[s] + maxPositions[s]) / 2);
+            halfSteps[s] = std::abs(maxPositions[s] - minPositions[s]) / 2.0;
+            continue;
+        }
+
+        for(int k = 0; k < nbSamples[s]; k++){
+            samples[s].push_back(std::round(minPositions[s] + (double) (maxPositions[s] - minPositions[s]) * k / (nbSamples[s] - 1)));
+        }
+        halfSteps[s] = std::abs(maxPositions[s] - minPositions[s]) / (2.0 * (nbSamples[s] - 1)) + 0.5; // Rounding of the samples
+    }
+
+    // Coordinates of every configuration and first order bound of the displacement around them, by batches
+    std::vector<float> allCoords(nbEntries * 3);
+    std::vector<uint16_t> configs(REACHABILITY_BUILD_BATCH * nbServos);
+    std::vector<double> batchCoords(REACHABILITY_BUILD_BATCH * 3);
+    std::vector<double> batchGradients(REACHABILITY_BUILD_BATCH * 3 * nbServos);
+    std::vector<int> counter(nbServos, 0);
+
+    double low[3], high[3];
+    std::fill(low, low + 3, std::numeric_limits<double>::infinity());
+    std::fill(high, high + 3, -std::numeric_limits<double>::infinity());
+    double shellMin = std::numeric_limits<double>::infinity(), shellMax = 0, displacement = 0;
+
+    for(uint64_t done = 0; done < nbEntries;){
+        int batch = std::min<uint64_t>(REACHABILITY_BUILD_BATCH, nbEntries - done);
+
+        for(int c = 0; c < batch; c++){
+            for(int s = 0; s < nbServos; s++) configs[c * nbServos + s] = samples[s][counter[s]];
+
+            for(int s = nbServos - 1; s >= 0 && ++counter[s] == nbSamples[s]; s--) counter[s] = 0;
+        }
+
+        converter.computeServoToCoordGradientBatch(configs.data(), batch, batchCoords.data(), batchGradients.data());
+
+        for(int c = 0; c < batch; c++){
+            const double* coord = &batchCoords[c * 3];
+            const double* gradient = &batchGradients[c * 3 * nbServos];
+
+            double bound = 0;
+            for(int s = 0; s < nbServos; s++){
+                double column = std::sqrt(gradient[s] * gradient[s] + gradient[nbServos + s] * gradient[nbServos + s] + gradient[2 * nbServos + s] * gradient[2 * nbServos + s]);
+                bound += column * halfSteps[s];
+            }
+            displacement = std::max(displacement, bound);
+
+            double radius = std::sqrt(std::pow(coord[0] - center[0], 2) + std::pow(coord[1] - center[1], 2) + std::pow(coord[2] - center[2], 2));
+            shellMin = std::min(shellMin, radius);
+            shellMax = std::max(shellMax, radius);
+
+            for(int k = 0; k < 3; k++){
+                allCoords[(done + c) * 3 + k] = coord[k];
+                low[k] = std::min(low[k], coord[k]);
+                high[k] = std::max(high[k], coord[k]);
+            }
+        }
+
+        done += batch;
+    }
+
+    margin = REACHABILITY_MARGIN_FACTOR * displacement;
+    minRadius = std::max(0.0, shellMin - margin);
+    maxRadius = shellMax + margin;
+
+    if(voxelSize == 0) return;
+
+    // Grid covering the samples and their margin
+    uint64_t nbVoxels = 1;
+    for(int k = 0; k < 3; k++){
+        origin[k] = low[k] - margin;
+        dims[k] = std::floor((high[k] - low[k] + 2 * margin) / voxelSize) + 1;
+        nbVoxels *= dims[k];
+    }
+    if(nbVoxels >= std::numeric_limits<uint32_t>::max()) throw ComputationError("Error : too many cells for the reachability bitmap, increase their size");
+
+    this->voxelSize = voxelSize;
+    bitmap.assign((nbVoxels + 63) / 64, 0);
+
+    double coord[3];
+    for(uint64_t e = 0; e < nbEntries; e++){
+        std::copy(&allCoords[e * 3], &allCoords[e * 3] + 3, coord);
+        markVoxels(coord);
+    }
+}
+
+void ReachabilityMap::markVoxels(const double* coordinates){
+    int64_t first[3], last[3];
+    for(int k = 0; k < 3; k++){
+        first[k] = std::max<int64_t>(0, std::floor((coordinates[k] - margin - origin[k]) / voxelSize));
+        last[k] = std::min<int64_t>(dims[k] - 1, std::floor((coordinates[k] + margin - origin[k]) / voxelSize));
+    }
+
+    // All the cells intersecting the cube of half edge margin around the sample
+    for(int64_t x = first[0]; x <= last[0]; x++){
+        for(int64_t y = first[1]; y <= last[1]; y++){
+            for(int64_t z = first[2]; z <= last[2]; z++){
+                uint64_t voxel = (x * dims[1] + y) * dims[2] + z;
+                bitmap[voxel >> 6] |= (uint64_t) 1 << (voxel & 63);
+            }
+        }
+    }
+}
+
+
+bool ReachabilityMap::reachable(const double* coordinates) const{
+    double diff[3] = {coordinates[0] - center[0], coordinates[1] - center[1], coordinates[2] - center[2]};
+    double squared = diff[0] * diff[0] + diff[1] * diff[1] + diff[2] * diff[2];
+    if(squared > maxRadius * maxRadius || squared < minRadius * minRadius) return false;
+
+    if(bitmap.empty()) return true;
+
+    uint64_t voxel = 0;
+    for(int k = 0; k < 3; k++){
+        double cell = std::floor((coordinates[k] - origin[k]) / voxelSize);
+        if(cell < 0 || cell >= dims[k]) return false; // Outside of the grid covering all the samples and their margin
+
+        voxel = voxel * dims[k] + (uint64_t) cell;
+    }
+
+    return (bitmap[voxel >> 6] >> (voxel & 63)) & 1;
+}
+
+
+double ReachabilityMap::getMinRadius() const{
+    return minRadius;
+}
+
+double ReachabilityMap::getMaxRadius() const{
+    return maxRadius;
+}
+
+double ReachabilityMap::getMargin() const{
+    return margin;
+}
+
+bool ReachabilityMap::hasBitmap() const{
+    return !bitmap.empty();
+}
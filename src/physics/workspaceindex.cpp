@@ -0,0 +1,303 @@
+/**
+ * @copyright Copyright (c) 2019
+ */
+
+
+#include <fstream>
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include "workspaceindex.h"
+
+using namespace armlearn;
+using namespace kinematics;
+
+
+WorkspaceIndex::WorkspaceIndex():mapped(nullptr){
+    clear();
+}
+
+WorkspaceIndex::WorkspaceIndex(const std::string& fileName):mapped(nullptr){
+    clear();
+    load(fileName);
+}
+
+WorkspaceIndex::~WorkspaceIndex(){
+    delete mapped;
+}
+
+
+void WorkspaceIndex::clear(){
+    delete mapped;
+    mapped = nullptr;
+
+    offsetData.clear();
+    coordData.clear();
+    servoData.clear();
+
+    std::memset(&header, 0, sizeof(Header));
+    std::memcpy(header.magic, WORKSPACE_INDEX_MAGIC, sizeof(header.magic));
+    header.version = WORKSPACE_INDEX_VERSION;
+
+    offsets = nullptr;
+    coords = nullptr;
+    servos = nullptr;
+}
+
+uint64_t WorkspaceIndex::getNbVoxels() const{
+    return (uint64_t) header.dims[0] * header.dims[1] * header.dims[2];
+}
+
+
+void WorkspaceIndex::build(Converter& converter, const std::vector<uint16_t>& minPositions, const std::vector<uint16_t>& maxPositions, const std::vector<int>& nbSamples, double voxelSize){
+    int nbServos = converter.getNbServos();
+    if(minPositions.size() != nbServos || maxPositions.size() != nbServos || nbSamples.size() != nbServos){
+        std::stringstream errMsg;
+        errMsg << "Sampling bounds of sizes " << minPositions.size() << ", " << maxPositions.size() << " and " << nbSamples.size() << " do not match the number of servomotors : " << nbServos;
+
+        throw ComputationError(errMsg.str());
+    }
+    if(voxelSize <= 0) throw ComputationError("Error : the cells of the workspace index must have a positive size");
+
+    uint64_t nbEntries = 1;
+    for(int s = 0; s < nbServos; s++){
+        if(nbSamples[s] < 1) throw ComputationError("Error : each servomotor must be sampled at least once");
+
+        nbEntries *= nbSamples[s];
+        if(nbEntries > std::numeric_limits<uint32_t>::max()) throw ComputationError("Error : too many samples for the workspace index");
+    }
+
+    clear();
+    header.nbServos = nbServos;
+    header.nbEntries = nbEntries;
+    header.voxelSize = voxelSize;
+
+    // Sampled positions of each servomotor
+    std::vector<std::vector<uint16_t>> samples(nbServos);
+    for(int s = 0; s < nbServos; s++){
+        if(nbSamples[s] == 1){
+            samples[s].push_back((minPositions[s] + maxPositions[s]) / 2);
+            continue;
+        }
+
+        for(int k = 0; k < nbSamples[s]; k++){
+            samples[s].push_back(std::round(minPositions[s] + (double) (maxPositions[s] - minPositions[s]) * k / (nbSamples[s] - 1)));
+        }
+    }
+
+    // Computation of the coordinates of every configuration, by batches
+    std::vector<uint16_t> allServos(nbEntries * nbServos);
+    std::vector<float> allCoords(nbEntries * 3);
+    std::vector<double> batchCoords(WORKSPACE_BUILD_BATCH * 3);
+    std::vector<int> counter(nbServos, 0);
+
+    for(uint64_t done = 0; done < nbEntries;){
+        int batch = std::min<uint64_t>(WORKSPACE_BUILD_BATCH, nbEntries - done);
+        uint16_t* configs = &allServos[done * nbServos];
+
+        for(int c = 0; c < batch; c++){
+            for(int s = 0; s < nbServos; s++) configs[c * nbServos + s] = samples[s][counter[s]];
+
+            for(int s = nbServos - 1; s >= 0 && ++counter[s] == nbSamples[s]; s--) counter[s] = 0;
+        }
+
+        converter.computeServoToCoordBatch(configs, batch, batchCoords.data());
+        for(int i = 0; i < batch * 3; i++) allCoords[done * 3 + i] = batchCoords[i];
+
+        done += batch;
+    }
+
+    // Grid covering all the coordinates reached
+    for(int k = 0; k < 3; k++){
+        float low = allCoords[k], high = allCoords[k];
+        for(uint64_t e = 1; e < nbEntries; e++){
+            low = std::min(low, allCoords[e * 3 + k]);
+            high = std::max(high, allCoords[e * 3 + k]);
+        }
+
+        header.origin[k] = low;
+        header.dims[k] = std::floor((high - low) / voxelSize) + 1;
+    }
+    if(getNbVoxels() >= std::numeric_limits<uint32_t>::max()) throw ComputationError("Error : too many cells for the workspace index, increase their size");
+
+    // Sort of the samples by cell
+    std::vector<uint32_t> voxels(nbEntries);
+    offsetData.assign(getNbVoxels() + 1, 0);
+    for(uint64_t e = 0; e < nbEntries; e++){
+        uint64_t voxel = 0;
+        for(int k = 0; k < 3; k++){
+            int64_t cell = std::floor((allCoords[e * 3 + k] - header.origin[k]) / voxelSize);
+            voxel = voxel * header.dims[k] + std::max<int64_t>(0, std::min<int64_t>(cell, header.dims[k] - 1));
+        }
+
+        voxels[e] = voxel;
+        offsetData[voxel + 1]++;
+    }
+    for(uint64_t v = 0; v < getNbVoxels(); v++) offsetData[v + 1] += offsetData[v];
+
+    std::vector<uint32_t> cursors(offsetData.cbegin(), offsetData.cend() - 1);
+    coordData.resize(nbEntries * 3);
+    servoData.resize(nbEntries * nbServos);
+    for(uint64_t e = 0; e < nbEntries; e++){
+        uint32_t target = cursors[voxels[e]]++;
+        std::copy(&allCoords[e * 3], &allCoords[e * 3] + 3, &coordData[target * 3]);
+        std::copy(&allServos[e * nbServos], &allServos[e * nbServos] + nbServos, &servoData[(uint64_t) target * nbServos]);
+    }
+
+    offsets = offsetData.data();
+    coords = coordData.data();
+    servos = servoData.data();
+}
+
+
+void WorkspaceIndex::save(const std::string& fileName) const{
+    std::ofstream file(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+    if(!file.is_open()){
+        std::stringstream errMsg;
+        errMsg << "Error while opening workspace index " << fileName;
+
+        throw FileError(errMsg.str());
+    }
+
+    file.write((const char*) &header, sizeof(Header));
+    if(!empty()){
+        file.write((const char*) offsets, (getNbVoxels() + 1) * sizeof(uint32_t));
+        file.write((const char*) coords, (uint64_t) header.nbEntries * 3 * sizeof(float));
+        file.write((const char*) servos, (uint64_t) header.nbEntries * header.nbServos * sizeof(uint16_t));
+    }
+
+    if(!file.good()){
+        std::stringstream errMsg;
+        errMsg << "Error while writing workspace index " << fileName;
+
+        throw FileError(errMsg.str());
+    }
+}
+
+void WorkspaceIndex::load(const std::string& fileName){
+    clear();
+    mapped = new MappedFile(fileName);
+
+    const char* data = (const char*) mapped->getData();
+    uint64_t expectedSize = sizeof(Header);
+    if(mapped->getSize() >= sizeof(Header)){
+        std::memcpy(&header, data, sizeof(Header));
+        if(header.nbEntries > 0) expectedSize += (getNbVoxels() + 1) * sizeof(uint32_t) + (uint64_t) header.nbEntries * (3 * sizeof(float) + header.nbServos * sizeof(uint16_t));
+    }
+
+    if(mapped->getSize() < sizeof(Header) || std::memcmp(header.magic, WORKSPACE_INDEX_MAGIC, sizeof(header.magic)) != 0 || header.version != WORKSPACE_INDEX_VERSION || mapped->getSize() != expectedSize){
+        clear();
+
+        std::stringstream errMsg;
+        errMsg << "File " << fileName << " is not a valid workspace index";
+
+        throw FileError(errMsg.str());
+    }
+
+    if(empty()) return;
+
+    // Arrays used directly from the mapped file
+    offsets = (const uint32_t*) (data + sizeof(Header));
+    coords = (const float*) (offsets + getNbVoxels() + 1);
+    servos = (const uint16_t*) (coords + (uint64_t) header.nbEntries * 3);
+
+    if(offsets[getNbVoxels()] != header.nbEntries){
+        clear();
+
+        std::stringstream errMsg;
+        errMsg << "Workspace index " << fileName << " is corrupted";
+
+        throw FileError(errMsg.str());
+    }
+}
+
+
+bool WorkspaceIndex::empty() const{
+    return header.nbEntries == 0;
+}
+
+int WorkspaceIndex::getNbServos() const{
+    return header.nbServos;
+}
+
+int WorkspaceIndex::getNbEntries() const{
+    return header.nbEntries;
+}
+
+
+void WorkspaceIndex::searchVoxel(uint64_t voxel, const double* coordinates, int64_t& best, double& bestDistance) const{
+    for(uint32_t e = offsets[voxel]; e < offsets[voxel + 1]; e++){
+        const float* point = coords + (uint64_t) e * 3;
+
+        double distance = 0;
+        for(int k = 0; k < 3; k++) distance += (point[k] - coordinates[k]) * (point[k] - coordinates[k]);
+
+        if(distance < bestDistance){
+            best = e;
+            bestDistance = distance;
+        }
+    }
+}
+
+double WorkspaceIndex::nearest(const double* coordinates, uint16_t* positions) const{
+    if(empty()) throw ComputationError("Error : the workspace index is empty");
+
+    // Cell containing the target, possibly outside of the grid
+    int64_t center[3];
+    int64_t dims[3];
+    int64_t firstShell = 0, lastShell = 0;
+    for(int k = 0; k < 3; k++){
+        center[k] = std::floor((coordinates[k] - header.origin[k]) / header.voxelSize);
+        dims[k] = header.dims[k];
+
+        firstShell = std::max(firstShell, std::max(-center[k], center[k] - dims[k] + 1));
+        lastShell = std::max(lastShell, std::max(center[k], dims[k] - 1 - center[k]));
+    }
+
+    // Search by shells of cells around the target, until the next shell cannot contain a closer sample
+    int64_t best = -1;
+    double bestDistance = std::numeric_limits<double>::infinity();
+    for(int64_t r = firstShell; r <= lastShell; r++){
+        double shellDistance = (r - 1) * header.voxelSize;
+        if(best >= 0 && r > 0 && bestDistance <= shellDistance * shellDistance) break;
+
+        int64_t low[3], high[3];
+        for(int k = 0; k < 3; k++){
+            low[k] = std::max<int64_t>(0, center[k] - r);
+            high[k] = std::min<int64_t>(dims[k] - 1, center[k] + r);
+        }
+
+        for(int64_t x = low[0]; x <= high[0]; x++){
+            for(int64_t y = low[1]; y <= high[1]; y++){
+                uint64_t column = (x * dims[1] + y) * dims[2];
+
+                if(std::abs(x - center[0]) == r || std::abs(y - center[1]) == r){
+                    for(int64_t z = low[2]; z <= high[2]; z++) searchVoxel(column + z, coordinates, best, bestDistance);
+                }else{ // Only the bottom and top cells belong to the shell
+                    if(center[2] - r >= 0 && center[2] - r < dims[2]) searchVoxel(column + center[2] - r, coordinates, best, bestDistance);
+                    if(r > 0 && center[2] + r >= 0 && center[2] + r < dims[2]) searchVoxel(column + center[2] + r, coordinates, best, bestDistance);
+                }
+            }
+        }
+    }
+
+    std::copy(servos + best * header.nbServos, servos + (best + 1) * header.nbServos, positions);
+
+    return std::sqrt(bestDistance);
+}
+
+std::vector<uint16_t> WorkspaceIndex::nearest(const std::vector<double>& coordinates) const{
+    if(coordinates.size() != 3){
+        std::stringstream errMsg;
+        errMsg << "Input size " << coordinates.size() << " does not match the number of dimensions in the coordinates system : 3";
+
+        throw ComputationError(errMsg.str());
+    }
+
+    std::vector<uint16_t> positions(header.nbServos);
+    nearest(coordinates.data(), positions.data());
+
+    return positions;
+}
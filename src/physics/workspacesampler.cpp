@@ -0,0 +1,230 @@
+/**
+ * @copyright Copyright (c) 2019
+ */
+
+
+#include <fstream>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+#include "workspacesampler.h"
+
+using namespace armlearn;
+using namespace kinematics;
+
+
+/**
+ * @brief Header of the sample files
+ *
+ */
+struct SamplesHeader{
+    char magic[8];
+    uint32_t version;
+    uint32_t nbServos;
+    uint64_t nbSamples;
+};
+
+
+WorkspaceSampler::WorkspaceSampler(const Converter& conv):converter(conv), seed(){
+
+}
+
+WorkspaceSampler::~WorkspaceSampler(){
+
+}
+
+
+int WorkspaceSampler::getRecordSize(int nbServos){
+    return 2 * nbServos * sizeof(uint16_t) + 4 * sizeof(float) + sizeof(uint8_t);
+}
+
+void WorkspaceSampler::setSeed(const std::vector<uint16_t>& positions){
+    if(!positions.empty() && positions.size() != converter.getNbServos()){
+        std::stringstream errMsg;
+        errMsg << "Seed of size " << positions.size() << " does not match the number of servomotors : " << converter.getNbServos();
+
+        throw ComputationError(errMsg.str());
+    }
+
+    seed = positions;
+}
+
+
+SamplingSummary WorkspaceSampler::sample(const std::vector<uint16_t>& minPositions, const std::vector<uint16_t>& maxPositions, const std::vector<uint16_t>& strides, const std::string& fileName) const{
+    int nbServos = converter.getNbServos();
+    if(minPositions.size() != nbServos || maxPositions.size() != nbServos || strides.size() != nbServos){
+        std::stringstream errMsg;
+        errMsg << "Sampling ranges of sizes " << minPositions.size() << ", " << maxPositions.size() << " and " << strides.size() << " do not match the number of servomotors : " << nbServos;
+
+        throw ComputationError(errMsg.str());
+    }
+
+    // Number of positions of each servomotor, the last one changing first
+    std::vector<uint64_t> nbSteps(nbServos);
+    uint64_t nbSamples = 1;
+    for(int s = 0; s < nbServos; s++){
+        if(strides[s] == 0 || maxPositions[s] < minPositions[s]) throw ComputationError("Error : sampling ranges must be ordered with positive strides");
+
+        nbSteps[s] = (maxPositions[s] - minPositions[s]) / strides[s] + 1;
+        nbSamples *= nbSteps[s];
+    }
+
+    std::vector<uint16_t> start(seed);
+    if(start.empty()){
+        for(int s = 0; s < nbServos; s++) start.push_back((minPositions[s] + maxPositions[s]) / 2);
+    }
+
+    std::ofstream file(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+    if(!file.is_open()){
+        std::stringstream errMsg;
+        errMsg << "Error while opening sample file " << fileName;
+
+        throw FileError(errMsg.str());
+    }
+
+    SamplesHeader header;
+    std::memset(&header, 0, sizeof(SamplesHeader));
+    std::memcpy(header.magic, WORKSPACE_SAMPLES_MAGIC, sizeof(header.magic));
+    header.version = WORKSPACE_SAMPLES_VERSION;
+    header.nbServos = nbServos;
+    header.nbSamples = nbSamples;
+    file.write((const char*) &header, sizeof(SamplesHeader));
+
+    SamplingSummary summary = {nbSamples, 0, 0, 0, 0, 0};
+    int recordSize = getRecordSize(nbServos);
+    std::vector<char> block((size_t) std::min<uint64_t>(WORKSPACE_SAMPLER_BLOCK, nbSamples) * recordSize);
+
+    for(uint64_t first = 0; first < nbSamples; first += WORKSPACE_SAMPLER_BLOCK){
+        int64_t blockSize = std::min<uint64_t>(WORKSPACE_SAMPLER_BLOCK, nbSamples - first);
+        uint64_t nbForward = 0, nbInverse = 0, nbValid = 0;
+        double sumError = 0, maxError = 0;
+
+        #pragma omp parallel reduction(+:nbForward, nbInverse, nbValid, sumError) reduction(max:maxError)
+        {
+            std::vector<uint16_t> positions(nbServos);
+            std::vector<uint16_t> inverse(nbServos);
+            double coordinates[3], reached[3];
+
+            #pragma omp for schedule(dynamic, 64)
+            for(int64_t i = 0; i < blockSize; i++){
+                uint64_t index = first + i;
+                for(int s = nbServos - 1; s >= 0; s--){
+                    positions[s] = minPositions[s] + (index % nbSteps[s]) * strides[s];
+                    index /= nbSteps[s];
+                }
+
+                float error = -1;
+                uint8_t flags = 0;
+                std::fill(coordinates, coordinates + 3, 0);
+                std::copy(start.cbegin(), start.cend(), inverse.begin());
+
+                if(converter.servoToCoord(positions.data(), coordinates) == computationSucceeded){
+                    flags |= forwardSucceeded;
+
+                    if(converter.coordToServo(coordinates, inverse.data()) == computationSucceeded){
+                        flags |= inverseSucceeded;
+                        if(converter.validPosition(inverse.data())) flags |= inverseValid;
+
+                        if(converter.servoToCoord(inverse.data(), reached) == computationSucceeded){
+                            error = std::sqrt(std::pow(reached[0] - coordinates[0], 2) + std::pow(reached[1] - coordinates[1], 2) + std::pow(reached[2] - coordinates[2], 2));
+
+                            sumError += error;
+                            maxError = std::max(maxError, (double) error);
+                        }
+                    }
+                }
+                if(!(flags & inverseSucceeded)) std::fill(inverse.begin(), inverse.end(), 0);
+
+                nbForward += (flags & forwardSucceeded) != 0;
+                nbInverse += (flags & inverseSucceeded) != 0;
+                nbValid += (flags & inverseValid) != 0;
+
+                // Record of the sample
+                char* record = block.data() + (size_t) i * recordSize;
+                float coords[3] = {(float) coordinates[0], (float) coordinates[1], (float) coordinates[2]};
+                std::memcpy(record, positions.data(), nbServos * sizeof(uint16_t));
+                record += nbServos * sizeof(uint16_t);
+                std::memcpy(record, coords, sizeof(coords));
+                record += sizeof(coords);
+                std::memcpy(record, inverse.data(), nbServos * sizeof(uint16_t));
+                record += nbServos * sizeof(uint16_t);
+                std::memcpy(record, &error, sizeof(float));
+                record += sizeof(float);
+                *record = flags;
+            }
+        }
+
+        summary.nbForward += nbForward;
+        summary.nbInverse += nbInverse;
+        summary.nbValid += nbValid;
+        summary.meanError += sumError;
+        summary.maxError = std::max(summary.maxError, maxError);
+
+        file.write(block.data(), blockSize * recordSize);
+        if(!file.good()){
+            std::stringstream errMsg;
+            errMsg << "Error while writing sample file " << fileName;
+
+            throw FileError(errMsg.str());
+        }
+    }
+
+    // Mean over the samples whose round trip has been computed
+    uint64_t nbErrors = summary.nbInverse;
+    summary.meanError = nbErrors > 0 ? summary.meanError / nbErrors : 0;
+
+    return summary;
+}
+
+
+std::vector<WorkspaceSample> WorkspaceSampler::load(const std::string& fileName){
+    std::ifstream file(fileName, std::ios::in | std::ios::binary);
+    if(!file.is_open()){
+        std::stringstream errMsg;
+        errMsg << "Error while opening sample file " << fileName;
+
+        throw FileError(errMsg.str());
+    }
+
+    SamplesHeader header;
+    file.read((char*) &header, sizeof(SamplesHeader));
+    if(!file.good() || std::memcmp(header.magic, WORKSPACE_SAMPLES_MAGIC, sizeof(header.magic)) != 0 || header.version != WORKSPACE_SAMPLES_VERSION){
+        std::stringstream errMsg;
+        errMsg << "File " << fileName << " is not a valid sample file";
+
+        throw FileError(errMsg.str());
+    }
+
+    int nbServos = header.nbServos;
+    std::vector<char> record(getRecordSize(nbServos));
+    std::vector<WorkspaceSample> samples;
+
+    for(uint64_t i = 0; i < header.nbSamples; i++){
+        file.read(record.data(), record.size());
+        if(!file.good()){
+            std::stringstream errMsg;
+            errMsg << "Sample file " << fileName << " is truncated";
+
+            throw FileError(errMsg.str());
+        }
+
+        WorkspaceSample sample;
+        const char* ptr = record.data();
+        sample.positions.resize(nbServos);
+        std::memcpy(sample.positions.data(), ptr, nbServos * sizeof(uint16_t));
+        ptr += nbServos * sizeof(uint16_t);
+        std::memcpy(sample.coordinates, ptr, sizeof(sample.coordinates));
+        ptr += sizeof(sample.coordinates);
+        sample.inversePositions.resize(nbServos);
+        std::memcpy(sample.inversePositions.data(), ptr, nbServos * sizeof(uint16_t));
+        ptr += nbServos * sizeof(uint16_t);
+        std::memcpy(&sample.error, ptr, sizeof(float));
+        ptr += sizeof(float);
+        sample.flags = *ptr;
+
+        samples.push_back(sample);
+    }
+
+    return samples;
+}
@@ -3,28 +3,81 @@
  */
 
 
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
 #include "trajectory.h"
 
 using namespace armlearn;
 
 
-Trajectory::Trajectory(communication::AbstractController* toDevice){
+Trajectory::Trajectory(communication::AbstractController* toDevice):checker(nullptr), mapped(nullptr), profile(trapezoidalProfile), planPending(false){
     device = toDevice;
 
-    trajectories = new std::vector<std::vector<uint16_t>*>();
+    clear();
+}
+
+Trajectory::Trajectory(communication::AbstractController* toDevice, const std::string& fileName):checker(nullptr), mapped(nullptr), profile(trapezoidalProfile), planPending(false){
+    device = toDevice;
+
+    load(fileName);
 }
 
 Trajectory::~Trajectory(){
-    for(auto ptr1 = trajectories->begin(); ptr1 < trajectories->end(); ptr1++){
-        delete *ptr1;
+    delete mapped;
+}
+
+
+void Trajectory::own(){
+    if(mapped == nullptr) return;
+
+    pointData.assign(points, points + nbPoints * nbServos);
+    if(maxSpeeds.empty() && times != nullptr) timeData.assign(times, times + nbPoints); // Times of a trajectory timed by limits already computed
+
+    delete mapped;
+    mapped = nullptr;
+
+    updateViews();
+}
+
+void Trajectory::updateViews(){
+    if(mapped == nullptr) points = pointData.data();
+    times = timeData.empty() ? nullptr : timeData.data();
+}
+
+void Trajectory::checkPoint(const std::vector<uint16_t>& point) const{
+    if((nbPoints > 0 || isTimed()) && point.size() != nbServos){
+        std::stringstream errMsg;
+        errMsg << "Error : point of size " << point.size() << " does not match the " << nbServos << " servomotors of the trajectory";
+
+        throw TrajectoryError(errMsg.str());
     }
+}
+
+std::vector<uint16_t> Trajectory::pointAt(uint64_t pos) const{
+    return std::vector<uint16_t>(points + pos * nbServos, points + (pos + 1) * nbServos);
+}
+
 
-    delete trajectories;
+void Trajectory::setCollisionChecker(kinematics::CollisionChecker* collisionChecker){
+    checker = collisionChecker;
+}
+
+bool Trajectory::pointCollides(int pos) const{
+    if(pos <0 || pos >= (int64_t) nbPoints) throw std::out_of_range("Error : Value out of vector boundaries");
+
+    return checker != nullptr && checker->collides(pointAt(pos));
 }
 
 
 void Trajectory::move(const std::vector<uint16_t>& point) const{
     try{
+        if(checker != nullptr && checker->collides(point)) throw TrajectoryError("Error : Point makes the device collide");
+
         device->setPosition(point);
     }catch(ConnectionError e){
         throw TrajectoryError(e.what()); //TODO: handle instead of throwing
@@ -32,6 +85,8 @@ void Trajectory::move(const std::vector<uint16_t>& point) const{
         throw TrajectoryError(e.what());
     }catch(IdError e){
         throw TrajectoryError(e.what());
+    }catch(ComputationError e){
+        throw TrajectoryError(e.what());
     }
 
     device->waitFeedback();
@@ -42,59 +97,623 @@ void Trajectory::move(const std::vector<uint16_t>& point) const{
 
 
 void Trajectory::addPoint(const std::vector<uint16_t>& point, int pos){
-    if(pos <0 || pos > trajectories->size()) throw std::out_of_range("Error : Value out of vector boundaries");
-
-    std::vector<uint16_t>* newPoint = new std::vector<uint16_t>(point.cbegin(), point.cend());
-    std::vector<std::vector<uint16_t>*>::iterator ptrPos = trajectories->begin();
-    ptrPos += pos;
-
-    trajectories->insert(ptrPos, newPoint);
+    if(pos <0 || pos > (int64_t) nbPoints) throw std::out_of_range("Error : Value out of vector boundaries");
+    if(maxSpeeds.empty() && times != nullptr) throw TrajectoryError("Error : points of a recorded trajectory must be added with their time");
+    checkPoint(point);
+
+    own();
+    if(nbPoints == 0) nbServos = point.size();
+    pointData.insert(pointData.begin() + (uint64_t) pos * nbServos, point.cbegin(), point.cend());
+    nbPoints++;
+    updateViews();
+    if(!tolerances.empty()) tolerances.insert(tolerances.begin() + pos, 0);
+
+    if(!maxSpeeds.empty()){
+        if(nbPoints > 1) timings.insert(timings.begin() + std::min<int>(pos, timings.size()), SegmentTiming());
+        retime(pos - 1, pos); // Segments ending and starting at the new point
+    }
 }
 
 void Trajectory::addPoint(const std::vector<uint16_t>& point){
-    addPoint(point, this->trajectories->size());
+    addPoint(point, nbPoints);
+}
+
+void Trajectory::addTimedPoint(const std::vector<uint16_t>& point, double time){
+    if(!maxSpeeds.empty()) throw TrajectoryError("Error : trajectory timed by the limits of the servomotors, points cannot be added with their time");
+    if(nbPoints > 0 && times == nullptr) throw TrajectoryError("Error : trajectory containing points without time");
+    if(!std::isfinite(time) || (nbPoints > 0 && time < times[nbPoints - 1])){
+        std::stringstream errMsg;
+        errMsg << "Error : time " << time << " is before the last point of the trajectory";
+
+        throw TrajectoryError(errMsg.str());
+    }
+    checkPoint(point);
+
+    own();
+    if(nbPoints == 0) nbServos = point.size();
+    pointData.insert(pointData.end(), point.cbegin(), point.cend());
+    timeData.push_back(time);
+    if(!tolerances.empty()) tolerances.push_back(0);
+    nbPoints++;
+    updateViews();
 }
 
 
 void Trajectory::removePoint(int pos){
-    if(pos <0 || pos > trajectories->size()-1) throw std::out_of_range("Error : Value out of vector boundaries");
+    if(pos <0 || pos > (int64_t) nbPoints - 1) throw std::out_of_range("Error : Value out of vector boundaries");
+
+    own();
+    pointData.erase(pointData.begin() + (uint64_t) pos * nbServos, pointData.begin() + (uint64_t) (pos + 1) * nbServos);
+    nbPoints--;
+    if(!tolerances.empty()) tolerances.erase(tolerances.begin() + pos);
+
+    if(!maxSpeeds.empty()){
+        if(!timings.empty()) timings.erase(timings.begin() + std::min<int>(pos, timings.size() - 1));
+        updateViews();
+        retime(pos - 1, pos - 1); // Segment joining the points around the removed one
+    }else if(times != nullptr){
+        timeData.erase(timeData.begin() + pos);
+    }
 
-    trajectories->erase(trajectories->begin()+pos);
+    if(nbPoints == 0) nbServos = maxSpeeds.size();
+    updateViews();
 }
 
 void Trajectory::removePoint(){
-    removePoint(this->trajectories->size()-1);
+    removePoint(nbPoints - 1);
+}
+
+void Trajectory::clear(){
+    delete mapped;
+    mapped = nullptr;
+
+    nbServos = 0;
+    nbPoints = 0;
+    pointData.clear();
+    timeData.clear();
+
+    maxSpeeds.clear();
+    maxAccelerations.clear();
+    profile = trapezoidalProfile;
+    timings.clear();
+    tolerances.clear();
+    corners.clear();
+    planPending = false;
+
+    updateViews();
+}
+
+
+void Trajectory::setBlendTolerance(int pos, double tolerance){
+    if(pos <0 || pos >= (int64_t) nbPoints) throw std::out_of_range("Error : Value out of vector boundaries");
+    if(!(tolerance >= 0) || std::isinf(tolerance)) throw TrajectoryError("Error : blend tolerance must be positive");
+
+    if(tolerances.empty()){
+        if(tolerance == 0) return;
+        tolerances.assign(nbPoints, 0);
+    }
+    tolerances[pos] = tolerance;
+
+    if(!maxSpeeds.empty()) retime(pos - 1, pos); // Segments around the point
+}
+
+void Trajectory::setBlendTolerance(double tolerance){
+    if(!(tolerance >= 0) || std::isinf(tolerance)) throw TrajectoryError("Error : blend tolerance must be positive");
+
+    if(tolerance == 0) tolerances.clear(); // Stops at every point, timed segment by segment
+    else tolerances.assign(nbPoints, tolerance);
+
+    if(!maxSpeeds.empty()) retime(0, timings.size() - 1);
+}
+
+double Trajectory::getBlendTolerance(int pos) const{
+    if(pos <0 || pos >= (int64_t) nbPoints) throw std::out_of_range("Error : Value out of vector boundaries");
+
+    return tolerances.empty() ? 0 : tolerances[pos];
+}
+
+
+uint64_t Trajectory::getNbPoints() const{
+    return nbPoints;
+}
+
+int Trajectory::getNbServos() const{
+    return nbServos;
+}
+
+const uint16_t* Trajectory::getPoint(uint64_t pos) const{
+    if(pos >= nbPoints) throw std::out_of_range("Error : Value out of vector boundaries");
+
+    return points + pos * nbServos;
+}
+
+
+void Trajectory::save(const std::string& fileName) const{
+    Header header = {};
+    std::memcpy(header.magic, TRAJECTORY_FILE_MAGIC, sizeof(header.magic));
+    header.version = TRAJECTORY_FILE_VERSION;
+    header.nbServos = nbServos;
+    header.nbPoints = nbPoints;
+    header.timing = !maxSpeeds.empty() ? 1 : (times != nullptr ? 2 : 0);
+    header.profile = profile;
+    header.blended = !tolerances.empty();
+
+    std::string tempName = fileName + TRAJECTORY_TEMP_SUFFIX; // The saved file may be the one mapped by the trajectory
+    std::ofstream file(tempName, std::ios::out | std::ios::binary | std::ios::trunc);
+    if(!file.is_open()){
+        std::stringstream errMsg;
+        errMsg << "Error while opening trajectory file " << tempName;
+
+        throw FileError(errMsg.str());
+    }
+
+    file.write((const char*) &header, sizeof(Header));
+    if(header.timing == 1){
+        file.write((const char*) maxSpeeds.data(), nbServos * sizeof(double));
+        file.write((const char*) maxAccelerations.data(), nbServos * sizeof(double));
+    }else if(header.timing == 2){
+        file.write((const char*) times, nbPoints * sizeof(double));
+    }
+    if(header.blended) file.write((const char*) tolerances.data(), nbPoints * sizeof(double));
+    file.write((const char*) points, nbPoints * nbServos * sizeof(uint16_t));
+    file.close();
+
+    if(!file.good() || std::rename(tempName.c_str(), fileName.c_str()) != 0){ // Mapped data stays valid once its file is replaced
+        std::remove(tempName.c_str());
+
+        std::stringstream errMsg;
+        errMsg << "Error while writing trajectory file " << fileName;
+
+        throw FileError(errMsg.str());
+    }
+}
+
+void Trajectory::load(const std::string& fileName){
+    clear();
+    mapped = new MappedFile(fileName);
+
+    Header header = {};
+    const char* data = (const char*) mapped->getData();
+    bool valid = mapped->getSize() >= sizeof(Header);
+    if(valid){
+        std::memcpy(&header, data, sizeof(Header));
+        valid = std::memcmp(header.magic, TRAJECTORY_FILE_MAGIC, sizeof(header.magic)) == 0 && header.version == TRAJECTORY_FILE_VERSION && header.timing <= 2 && header.profile <= sCurveProfile && header.blended <= 1 && (header.nbServos > 0 || (header.nbPoints == 0 && header.timing != 1));
+    }
+
+    uint64_t limitsSize = header.timing == 1 ? 2 * (uint64_t) header.nbServos * sizeof(double) : 0;
+    uint64_t pointSize = valid ? header.nbServos * sizeof(uint16_t) + (header.timing == 2 ? sizeof(double) : 0) + (header.blended ? sizeof(double) : 0) : 0;
+    if(valid){
+        uint64_t remaining = mapped->getSize() - sizeof(Header);
+        valid = remaining >= limitsSize && (pointSize == 0 ? remaining == limitsSize : (remaining - limitsSize) % pointSize == 0 && (remaining - limitsSize) / pointSize == header.nbPoints); // Divisions avoiding overflows on corrupted sizes
+    }
+
+    if(!valid){
+        clear();
+
+        std::stringstream errMsg;
+        errMsg << "File " << fileName << " is not a valid trajectory";
+
+        throw FileError(errMsg.str());
+    }
+
+    nbServos = header.nbServos;
+    nbPoints = header.nbPoints;
+    profile = (VelocityProfile) header.profile;
+
+    // Arrays used directly from the mapped file
+    const double* limits = (const double*) (data + sizeof(Header));
+    const double* stamps = (const double*) (data + sizeof(Header) + limitsSize);
+    const double* blends = stamps + (header.timing == 2 ? nbPoints : 0);
+    points = (const uint16_t*) (blends + (header.blended ? nbPoints : 0));
+    if(header.timing == 2 && nbPoints > 0) times = stamps;
+
+    if(header.blended) tolerances.assign(blends, blends + nbPoints); // Copied, modified independently of the points
+    bool corrupted = false;
+    for(auto tolerance : tolerances) corrupted = corrupted || !(tolerance >= 0) || std::isinf(tolerance);
+
+    if(header.timing == 1){
+        for(int i = 0; i < 2 * nbServos; i++) corrupted = corrupted || !(limits[i] > 0) || std::isinf(limits[i]);
+    }
+
+    if(corrupted){
+        clear();
+
+        std::stringstream errMsg;
+        errMsg << "Trajectory file " << fileName << " is corrupted";
+
+        throw FileError(errMsg.str());
+    }
+
+    if(header.timing == 1){
+        maxSpeeds.assign(limits, limits + nbServos);
+        maxAccelerations.assign(limits + nbServos, limits + 2 * nbServos);
+        timings.resize(nbPoints > 0 ? nbPoints - 1 : 0);
+        retime(0, timings.size() - 1);
+    }
+}
+
+
+void Trajectory::setTimeLimits(const std::vector<double>& speeds, const std::vector<double>& accelerations, VelocityProfile velocityProfile){
+    if(speeds.size() != accelerations.size() || speeds.empty()){
+        std::stringstream errMsg;
+        errMsg << "Error : limits of sizes " << speeds.size() << " and " << accelerations.size() << " cannot time a trajectory";
+
+        throw TrajectoryError(errMsg.str());
+    }
+
+    if(nbPoints > 0 && speeds.size() != nbServos){
+        std::stringstream errMsg;
+        errMsg << "Error : limits of size " << speeds.size() << " do not match the " << nbServos << " servomotors of the trajectory";
+
+        throw TrajectoryError(errMsg.str());
+    }
+
+    for(int i = 0; i < speeds.size(); i++){
+        if(!(speeds[i] > 0) || !(accelerations[i] > 0)) throw TrajectoryError("Error : speed and acceleration limits must be strictly positive");
+    }
+
+    maxSpeeds = speeds;
+    maxAccelerations = accelerations;
+    profile = velocityProfile;
+    nbServos = speeds.size();
+
+    timings.resize(nbPoints > 0 ? nbPoints - 1 : 0);
+    retime(0, timings.size() - 1); // Time of each point of a recorded trajectory replaced
+}
+
+bool Trajectory::isTimed() const{
+    return !maxSpeeds.empty() || times != nullptr;
+}
+
+SegmentTiming Trajectory::timeSegment(int segment) const{
+    const uint16_t* from = points + (uint64_t) segment * nbServos;
+    const uint16_t* to = from + nbServos;
+
+    // Limits of the progress along the segment, from the servomotor moving the most compared to its limits
+    double speed = std::numeric_limits<double>::infinity();
+    double acceleration = std::numeric_limits<double>::infinity();
+    for(int i = 0; i < maxSpeeds.size(); i++){
+        double distance = std::abs((double) to[i] - from[i]);
+        if(distance == 0) continue;
+
+        speed = std::min(speed, maxSpeeds[i] / distance);
+        acceleration = std::min(acceleration, maxAccelerations[i] / distance);
+    }
+
+    if(std::isinf(speed)) return {0, 0, 0, 0, 0, 0, 0, 0}; // No servomotor moves
+
+    double factor = profile == sCurveProfile ? 2 : 1; // Ratio between the peak and the mean acceleration of the ramps
+    if(factor * speed * speed / acceleration >= 1) speed = std::sqrt(acceleration / factor); // Cruise speed not reached, no constant speed phase
+
+    double ramp = factor * speed / acceleration;
+
+    return {1 / speed + ramp, 0, 0, ramp, speed, ramp, 0, 0};
+}
+
+void Trajectory::retime(int first, int last){
+    if(!tolerances.empty()){ // Blends spreading the modifications over the neighbouring segments
+        planPending = true;
+        return;
+    }
+
+    timeSegments(first, last);
+}
+
+void Trajectory::timeSegments(int first, int last) const{
+    if(!corners.empty() || planPending){ // Segments of the previous plan, or of a plan never computed
+        corners.clear();
+        planPending = false;
+        first = 0;
+        last = nbPoints - 2;
+    }
+
+    first = std::max(first, 0);
+    timings.resize(nbPoints > 0 ? nbPoints - 1 : 0);
+    for(int s = first; s <= last && s < timings.size(); s++) timings[s] = timeSegment(s);
+
+    timeData.resize(nbPoints);
+    if(nbPoints > 0) timeData[0] = 0;
+    for(int s = first; s < timings.size(); s++) timeData[s + 1] = timeData[s] + timings[s].duration;
+
+    times = timeData.empty() ? nullptr : timeData.data();
+}
+
+double Trajectory::chordDistance(uint64_t first, uint64_t last, uint64_t pos, double& ratio) const{
+    const uint16_t* from = points + first * nbServos;
+    const uint16_t* to = points + last * nbServos;
+    const uint16_t* point = points + pos * nbServos;
+
+    double dot = 0, length = 0;
+    for(int i = 0; i < nbServos; i++){
+        dot += ((double) point[i] - from[i]) * ((double) to[i] - from[i]);
+        length += ((double) to[i] - from[i]) * ((double) to[i] - from[i]);
+    }
+    ratio = length > 0 ? std::min(std::max(dot / length, 0.0), 1.0) : 0;
+
+    double distance = 0;
+    for(int i = 0; i < nbServos; i++) distance = std::max(distance, std::abs(from[i] + ratio * ((double) to[i] - from[i]) - point[i]));
+
+    return distance;
+}
+
+void Trajectory::update() const{
+    std::lock_guard<std::mutex> guard(planLock); // Queries possibly made concurrently, e.g. by a TrajectoryExecutor
+    if(!planPending) return;
+
+    if(plan()){
+        planPending = false;
+        return;
+    }
+
+    timeSegments(0, nbPoints - 2); // Stops at every point
+}
+
+bool Trajectory::plan() const{
+    if(nbPoints == 0){
+        corners.clear();
+        timings.clear();
+        timeData.clear();
+        times = nullptr;
+
+        return true;
+    }
+
+    double factor = profile == sCurveProfile ? 2 : 1; // Ratio between the peak and the mean acceleration of the ramps
+    double deviation = profile == sCurveProfile ? 1.0 / 8 - 1 / (2 * M_PI * M_PI) : 1.0 / 8; // Distance between a corner and the middle of its blend, per unit of velocity change and of blend time
+    double ratio;
+
+    // Corners of the trajectory, with the tolerance left to their blend by the merged points (within the same distance of the segment as the blends of its corners)
+    std::vector<uint64_t> planned(1, 0);
+    std::vector<double> slacks(1, 0);
+    while(planned.back() + 1 < nbPoints){
+        uint64_t first = planned.back(), last = first + 1;
+        double slack = std::numeric_limits<double>::infinity();
+        while(last + 1 < nbPoints && last + 1 - first <= BLEND_LOOKAHEAD && tolerances[last] > 0){
+            bool merged = true;
+            double merging = std::numeric_limits<double>::infinity();
+            for(uint64_t p = first + 1; p <= last && merged; p++){
+                double distance = chordDistance(first, last + 1, p, ratio);
+                merged = distance <= tolerances[p] / 2;
+                merging = std::min(merging, tolerances[p] - distance);
+            }
+            if(!merged) break;
+
+            last++;
+            slack = merging;
+        }
+
+        slacks.back() = std::min(slacks.back(), slack);
+        planned.push_back(last);
+        slacks.push_back(std::min(tolerances[last], slack));
+    }
+
+    int nbSegments = planned.size() - 1;
+
+    // Largest speed and acceleration of the progress along each segment, from the servomotor moving the most compared to its limits, infinite if no servomotor moves
+    std::vector<double> speeds(nbSegments, std::numeric_limits<double>::infinity());
+    std::vector<double> accelerations(nbSegments, std::numeric_limits<double>::infinity());
+    for(int s = 0; s < nbSegments; s++){
+        for(int i = 0; i < nbServos; i++){
+            double distance = std::abs((double) points[planned[s + 1] * nbServos + i] - points[planned[s] * nbServos + i]);
+            if(distance == 0) continue;
+
+            speeds[s] = std::min(speeds[s], maxSpeeds[i] / distance);
+            accelerations[s] = std::min(accelerations[s], maxAccelerations[i] / distance);
+        }
+    }
+
+    // Time taken by the blend of each corner passed at the largest speeds of its segments, and squared ratio of these speeds keeping the blend within the tolerance, 0 to stop at the corner
+    std::vector<double> blends(nbSegments + 1, 0);
+    std::vector<double> junctions(nbSegments + 1, 0);
+    for(int c = 1; c < nbSegments; c++){
+        if(!(slacks[c] > 0) || std::isinf(speeds[c - 1]) || std::isinf(speeds[c])) continue;
+
+        double change = 0;
+        for(int i = 0; i < nbServos; i++){
+            double velocity = speeds[c] * ((double) points[planned[c + 1] * nbServos + i] - points[planned[c] * nbServos + i]) - speeds[c - 1] * ((double) points[planned[c] * nbServos + i] - points[planned[c - 1] * nbServos + i]);
+
+            change = std::max(change, std::abs(velocity));
+            blends[c] = std::max(blends[c], factor * std::abs(velocity) / maxAccelerations[i]);
+        }
+
+        junctions[c] = change == 0 ? 1 : std::min(1.0, slacks[c] / (deviation * change * blends[c])); // Distance to the corner proportional to the squared speed
+    }
+
+    // Progress taken by the blends and by a change of speed, per unit of squared ratio, the segments being long enough if (speeds at its corners being the ratios of its largest speed):
+    //  - ratioIn * (blendIn + ramp) + ratioOut * (blendOut - ramp) <= 1 when decelerating
+    //  - ratioIn * (blendIn - ramp) + ratioOut * (blendOut + ramp) <= 1 when accelerating
+    std::vector<double> blendsIn(nbSegments, 0), blendsOut(nbSegments, 0), ramps(nbSegments, 0);
+    for(int s = 0; s < nbSegments; s++){
+        if(std::isinf(speeds[s])) continue;
+
+        blendsIn[s] = speeds[s] * blends[s] / 2;
+        blendsOut[s] = speeds[s] * blends[s + 1] / 2;
+        ramps[s] = factor * speeds[s] * speeds[s] / (2 * accelerations[s]);
+    }
+
+    bool respected = false;
+    for(int pass = 0; pass < BLEND_MAX_PASSES && !respected; pass++){
+        // Backward pass, each corner slow enough to decelerate to the next one
+        for(int s = nbSegments - 1; s >= 0; s--){
+            double bound = (1 - junctions[s + 1] * (blendsOut[s] - ramps[s])) / (blendsIn[s] + ramps[s]);
+            junctions[s] = std::max(std::min(junctions[s], bound), 0.0);
+        }
+
+        // Forward pass, each corner slow enough to be reached from the previous one
+        for(int s = 0; s < nbSegments; s++){
+            double bound = (1 - junctions[s] * (blendsIn[s] - ramps[s])) / (blendsOut[s] + ramps[s]);
+            junctions[s + 1] = std::max(std::min(junctions[s + 1], bound), 0.0);
+        }
+
+        respected = true;
+        for(int s = 0; s < nbSegments; s++){
+            respected = respected && junctions[s] * (blendsIn[s] + ramps[s]) + junctions[s + 1] * (blendsOut[s] - ramps[s]) <= 1 + 1e-9;
+            respected = respected && junctions[s] * (blendsIn[s] - ramps[s]) + junctions[s + 1] * (blendsOut[s] + ramps[s]) <= 1 + 1e-9;
+        }
+    }
+
+    if(!respected) return false;
+
+    corners.swap(planned);
+    timings.resize(nbSegments);
+    timeData.resize(nbPoints);
+    timeData[0] = 0;
+    for(int s = 0; s < nbSegments; s++){
+        SegmentTiming& timing = timings[s];
+        if(std::isinf(speeds[s])){
+            timing = {0, 0, 0, 0, 0, 0, 0, 0};
+        }else{
+            timing.speedIn = std::sqrt(junctions[s]) * speeds[s];
+            timing.speedOut = std::sqrt(junctions[s + 1]) * speeds[s];
+            timing.blendIn = std::sqrt(junctions[s]) * blends[s];
+            timing.blendOut = std::sqrt(junctions[s + 1]) * blends[s + 1];
+
+            // Highest speed reachable between the blends, the mean acceleration of the ramps being the largest acceleration divided by the factor
+            double length = 1 - timing.speedIn * timing.blendIn / 2 - timing.speedOut * timing.blendOut / 2;
+            timing.speed = std::min(speeds[s], std::sqrt(accelerations[s] * length / factor + (timing.speedIn * timing.speedIn + timing.speedOut * timing.speedOut) / 2));
+            timing.speed = std::max(timing.speed, std::max(timing.speedIn, timing.speedOut));
+
+            timing.rampIn = factor * (timing.speed - timing.speedIn) / accelerations[s];
+            timing.rampOut = factor * (timing.speed - timing.speedOut) / accelerations[s];
+            double cruise = std::max(length - (timing.speedIn + timing.speed) / 2 * timing.rampIn - (timing.speedOut + timing.speed) / 2 * timing.rampOut, 0.0) / timing.speed;
+
+            timing.duration = timing.blendIn + timing.rampIn + cruise + timing.rampOut + timing.blendOut;
+        }
+
+        uint64_t first = corners[s], last = corners[s + 1];
+        timeData[last] = timeData[first] + timing.duration - timing.blendOut; // Next segment starting with the blend
+
+        // Merged points timed in proportion to their progress along the segment
+        for(uint64_t p = first + 1; p < last; p++){
+            chordDistance(first, last, p, ratio);
+            timeData[p] = std::max(timeData[p - 1], timeData[first] + ratio * (timeData[last] - timeData[first]));
+        }
+    }
+
+    times = timeData.data();
+
+    return true;
+}
+
+double Trajectory::progress(const SegmentTiming& timing, double time) const{
+    if(timing.duration == 0 || time >= timing.duration) return 1;
+    if(time <= 0) return 0;
+
+    bool decelerating = time > timing.duration - timing.rampOut - timing.blendOut;
+    double elapsed = decelerating ? timing.duration - time : time; // Deceleration symmetric to the acceleration
+    double blend = decelerating ? timing.blendOut : timing.blendIn;
+    double ramp = decelerating ? timing.rampOut : timing.rampIn;
+    double boundary = decelerating ? timing.speedOut : timing.speedIn;
+
+    double res;
+    if(elapsed < blend){
+        res = transition(0, boundary, blend, elapsed);
+    }else if(elapsed < blend + ramp){
+        res = boundary * blend / 2 + transition(boundary, timing.speed, ramp, elapsed - blend);
+    }else{ // Constant speed
+        res = boundary * blend / 2 + (boundary + timing.speed) / 2 * ramp + timing.speed * (elapsed - blend - ramp);
+    }
+
+    return decelerating ? 1 - res : res;
+}
+
+double Trajectory::transition(double from, double to, double duration, double time) const{
+    double ratio = time / duration;
+
+    double res;
+    if(profile == sCurveProfile){
+        res = ratio * ratio / 2 - (1 - std::cos(2 * M_PI * ratio)) / (4 * M_PI * M_PI);
+    }else{
+        res = ratio * ratio / 2;
+    }
+
+    return from * time + (to - from) * duration * res;
+}
+
+double Trajectory::getSegmentDuration(int segment) const{
+    if(!isTimed()) throw TrajectoryError("Error : trajectory not timed, set the limits of the servomotors first");
+    if(segment < 0 || segment >= (int64_t) nbPoints - 1) throw std::out_of_range("Error : Value out of vector boundaries");
+    update();
+
+    return times[segment + 1] - times[segment];
+}
+
+double Trajectory::getDuration() const{
+    if(!isTimed()) throw TrajectoryError("Error : trajectory not timed, set the limits of the servomotors first");
+    if(nbPoints == 0) return 0;
+    update();
+
+    return times[nbPoints - 1] - times[0];
+}
+
+void Trajectory::sample(double time, std::vector<double>& setpoint, bool reverse) const{
+    if(!isTimed()) throw TrajectoryError("Error : trajectory not timed, set the limits of the servomotors first");
+    if(nbPoints == 0) throw TrajectoryError("Error : cannot sample an empty trajectory");
+
+    double duration = getDuration(); // Plans the trajectory if needed
+    if(reverse) time = duration - time; // Same timing in both directions
+    time = times[0] + std::min(std::max(time, 0.0), duration); // Recorded times not starting at 0
+
+    setpoint.resize(nbServos);
+    if(nbPoints == 1){
+        setpoint.assign(points, points + nbServos);
+        return;
+    }
+
+    int64_t segment = std::upper_bound(times, times + nbPoints, time) - times - 1;
+    segment = std::min<int64_t>(std::max<int64_t>(segment, 0), nbPoints - 2);
+
+    if(maxSpeeds.empty()){ // Constant speed between recorded points
+        const uint16_t* from = points + segment * nbServos;
+        const uint16_t* to = from + nbServos;
+
+        double length = times[segment + 1] - times[segment];
+        double ratio = length > 0 ? (time - times[segment]) / length : 1;
+
+        for(int i = 0; i < nbServos; i++) setpoint[i] = from[i] + ratio * ((double) to[i] - from[i]);
+        return;
+    }
+
+    // Segment between two corners, its points being merged, and segment before it, ending during the blend of its first corner
+    if(!corners.empty()) segment = std::upper_bound(corners.cbegin(), corners.cend(), (uint64_t) segment) - corners.cbegin() - 1;
+
+    uint64_t corner = corners.empty() ? segment : corners[segment];
+    setpoint.assign(points + corner * nbServos, points + (corner + 1) * nbServos);
+    for(int64_t s = std::max<int64_t>(segment - 1, 0); s <= segment; s++){
+        uint64_t first = corners.empty() ? s : corners[s], last = corners.empty() ? s + 1 : corners[s + 1];
+        double ratio = progress(timings[s], time - times[first]) - (s < segment ? 1 : 0);
+
+        for(int i = 0; i < nbServos; i++) setpoint[i] += ratio * ((double) points[last * nbServos + i] - points[first * nbServos + i]);
+    }
 }
 
 
 void Trajectory::init(bool reverse) const{
-    if(trajectories->size() == 0) return;
+    if(nbPoints == 0) return;
 
     if(reverse) 
-        move(**trajectories->rbegin());
+        move(pointAt(nbPoints - 1));
     else 
-        move(**trajectories->cbegin());
+        move(pointAt(0));
 }
 
 
 void Trajectory::executeTrajectory(bool reverse) const{
     if(reverse)
-        for(auto ptr = trajectories->rbegin(); ptr < trajectories->rend(); ptr++) move(**ptr);
+        for(int64_t i = nbPoints - 1; i >= 0; i--) move(pointAt(i));
     else
-        for(auto ptr = trajectories->cbegin(); ptr < trajectories->cend(); ptr++) move(**ptr);
+        for(uint64_t i = 0; i < nbPoints; i++) move(pointAt(i));
 }
 
 
 void Trajectory::printTrajectory() const{
     std::cout << "Trajectory:" << std::endl;
 
-    int i = 0;
-    for(auto ptr1=trajectories->cbegin(); ptr1 < trajectories->cend(); ptr1++){
+    for(uint64_t i = 0; i < nbPoints; i++){
         std::cout << i << ".\t";
-        i++;
 
-        for(auto ptr2=(*ptr1)->cbegin(); ptr2 < (*ptr1)->cend(); ptr2++){
-            std::cout << *ptr2 << "\t";
+        for(int j = 0; j < nbServos; j++){
+            std::cout << points[i * nbServos + j] << "\t";
         }
         std::cout << std::endl;
     }
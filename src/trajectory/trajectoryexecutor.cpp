@@ -0,0 +1,141 @@
+/**
+ * @copyright Copyright (c) 2019
+ */
+
+
+#include <cmath>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+
+#include "trajectoryexecutor.h"
+
+using namespace armlearn;
+
+
+TrajectoryExecutor::TrajectoryExecutor(communication::AbstractController* toDevice):device(toDevice), checker(nullptr), rate(EXECUTOR_RATE), maxDeviation(EXECUTOR_MAX_DEVIATION), feedForward(true){
+
+}
+
+TrajectoryExecutor::~TrajectoryExecutor(){
+
+}
+
+
+void TrajectoryExecutor::setRate(double frequency){
+    if(!(frequency > 0)) throw TrajectoryError("Error : the rate of the setpoints must be strictly positive");
+
+    rate = frequency;
+}
+
+void TrajectoryExecutor::setMaxDeviation(double deviation){
+    if(!(deviation > 0)) throw TrajectoryError("Error : the deviation allowed must be strictly positive");
+
+    maxDeviation = deviation;
+}
+
+void TrajectoryExecutor::setFeedForward(bool enable){
+    feedForward = enable;
+}
+
+void TrajectoryExecutor::setCollisionChecker(kinematics::CollisionChecker* collisionChecker){
+    checker = collisionChecker;
+}
+
+
+ExecutionSummary TrajectoryExecutor::execute(const Trajectory& trajectory, bool reverse){
+    double duration = trajectory.getDuration();
+    std::vector<uint8_t> ids = device->getMotorIds();
+
+    std::vector<double> current, next;
+    trajectory.sample(0, current, reverse);
+    if(current.size() != ids.size()){
+        std::stringstream errMsg;
+        errMsg << "Error : points of size " << current.size() << " do not match the " << ids.size() << " servomotors of the device";
+
+        throw TrajectoryError(errMsg.str());
+    }
+
+    // Speeds restored after the execution, modified by the feed-forward
+    std::vector<uint16_t> speeds;
+    for(auto id : ids) speeds.push_back(device->showServomotor(id)->getTargetSpeed());
+
+    ExecutionSummary summary = {0, 0, 0, 0};
+    std::vector<uint16_t> point(ids.size()), measured;
+    double period = 1 / rate;
+    int64_t nbPeriods = std::ceil(duration * rate);
+
+    std::string failure;
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    try{
+        for(int64_t k = 0; k <= nbPeriods; k++){
+            std::chrono::steady_clock::time_point deadline = startTime + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(k * period));
+            if(std::chrono::steady_clock::now() > deadline + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(period))){
+                summary.nbLate++;
+            }else{
+                std::this_thread::sleep_until(deadline);
+            }
+
+            // Tracking error, the device being expected at the setpoint sent at the previous period
+            device->updateInfos();
+            measured = device->getPosition();
+
+            double deviation = 0;
+            for(int i = 0; i < ids.size(); i++) deviation = std::max(deviation, std::abs(measured[i] - current[i]));
+            summary.maxDeviation = std::max(summary.maxDeviation, deviation);
+
+            if(deviation > maxDeviation){
+                device->setPosition(measured); // Holds the current position
+
+                std::stringstream errMsg;
+                errMsg << "Error : device deviated by " << deviation << " from the trajectory at " << std::min(k * period, duration) << " s";
+
+                throw TrajectoryError(errMsg.str());
+            }
+
+            if(k == nbPeriods) break; // Last setpoint reached
+
+
+            // Setpoint of the next period, sent with the speed reaching it in time
+            trajectory.sample(std::min((k + 1) * period, duration), next, reverse);
+            for(int i = 0; i < ids.size(); i++) point[i] = std::round(next[i]);
+
+            if(checker != nullptr && checker->collides(point)) throw TrajectoryError("Error : Setpoint makes the device collide");
+
+            if(feedForward){
+                for(int i = 0; i < ids.size(); i++){
+                    double speed = std::abs(next[i] - current[i]) / period / EXECUTOR_SPEED_SCALE;
+                    device->changeSpeed(ids[i], std::min<double>(SPEED_MAX - 1, std::max<double>(SPEED_MIN + 1, std::ceil(speed)))); // Speeds strictly within the range, 0 disabling the speed control
+                }
+            }
+
+            device->setPosition(point);
+            summary.nbSetpoints++;
+
+            current.swap(next);
+        }
+    }catch(TrajectoryError e){ // Speeds restored before throwing
+        failure = e.what();
+    }catch(ConnectionError e){
+        failure = e.what();
+    }catch(OutOfRangeError e){
+        failure = e.what();
+    }catch(IdError e){
+        failure = e.what();
+    }catch(ComputationError e){
+        failure = e.what();
+    }
+
+    if(feedForward){
+        for(int i = 0; i < ids.size(); i++){
+            if(device->showServomotor(ids[i])->validSpeed(speeds[i])) device->changeSpeed(ids[i], speeds[i]); // Speeds never set not sent back
+        }
+    }
+    if(!failure.empty()) throw TrajectoryError(failure);
+
+    device->waitFeedback();
+
+    summary.duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    return summary;
+}
@@ -0,0 +1,61 @@
+/**
+ * @copyright Copyright (c) 2019
+ */
+
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "mappedfile.h"
+
+using namespace armlearn;
+
+
+MappedFile::MappedFile(const std::string& fileName):descriptor(-1), data(nullptr), size(0){
+    descriptor = open(fileName.c_str(), O_RDONLY);
+    if(descriptor < 0){
+        std::stringstream errMsg;
+        errMsg << "Error while opening file " << fileName;
+
+        throw FileError(errMsg.str());
+    }
+
+    struct stat infos;
+    if(fstat(descriptor, &infos) < 0){
+        close(descriptor);
+
+        std::stringstream errMsg;
+        errMsg << "Error while reading the size of file " << fileName;
+
+        throw FileError(errMsg.str());
+    }
+    size = infos.st_size;
+
+    if(size > 0){ // Mapping an empty file is not allowed
+        data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if(data == MAP_FAILED){
+            close(descriptor);
+
+            std::stringstream errMsg;
+            errMsg << "Error while mapping file " << fileName << " in memory";
+
+            throw FileError(errMsg.str());
+        }
+    }
+}
+
+MappedFile::~MappedFile(){
+    if(data != nullptr) munmap(data, size);
+    close(descriptor);
+}
+
+
+const void* MappedFile::getData() const{
+    return data;
+}
+
+size_t MappedFile::getSize() const{
+    return size;
+}
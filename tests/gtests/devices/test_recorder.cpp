@@ -0,0 +1,154 @@
+/**
+ * @file test_recorder.cpp
+ * @author Gaël Gendron (gael.gendron@insa-rennes.fr)
+ * @brief Testing file of session recording and replay classes
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <cstdio>
+
+#include "nowaitarmsimulator.h"
+#include "recordingcontroller.h"
+#include "replaycontroller.h"
+#include "connectionerror.h"
+#include "outofrangeerror.h"
+#include "fileerror.h"
+
+
+#define LOG_FILE "test_session.armlog"
+
+
+class RecorderTest : public ::testing::Test {
+    protected:
+
+    RecorderTest() {
+        sim = new armlearn::communication::NoWaitArmSimulator(armlearn::communication::except);
+        sim->addMotor(1, "base", armlearn::communication::base);
+        sim->addMotor(2, "shoulder", armlearn::communication::shoulder);
+
+        recorder = new armlearn::communication::RecordingController(sim, LOG_FILE);
+    }
+
+    ~RecorderTest() override {
+        delete recorder;
+        delete sim;
+        std::remove(LOG_FILE);
+    }
+
+    void SetUp() override {
+        recorder->addMotor(3, "elbow", armlearn::communication::elbow);
+        recorder->connect();
+        recorder->changeSpeed(50);
+        recorder->setPosition({2000, 1700, 2900});
+        recorder->waitFeedback();
+        recorder->turnLED(2);
+        recorder->addPosition({10, -20, 30});
+        recorder->updateInfos();
+    }
+
+    void TearDown() override {
+    }
+
+    /**
+     * @brief Closes the log and opens it in a replay controller
+     *
+     */
+    armlearn::communication::ReplayController* replay() {
+        delete recorder;
+        recorder = nullptr;
+
+        return new armlearn::communication::ReplayController(LOG_FILE);
+    }
+
+    /**
+     * @brief Replays the commands of SetUp()
+     *
+     */
+    void replaySetUp(armlearn::communication::AbstractController* rep) {
+        rep->addMotor(3, "elbow", armlearn::communication::elbow);
+        rep->connect();
+        rep->changeSpeed(50);
+        rep->setPosition({2000, 1700, 2900});
+        rep->waitFeedback();
+        rep->turnLED(2);
+        rep->addPosition({10, -20, 30});
+        rep->updateInfos();
+    }
+
+    armlearn::communication::AbstractController* sim;
+    armlearn::communication::RecordingController* recorder;
+};
+
+
+// Tests that the recorder mirrors the wrapped controller
+TEST_F(RecorderTest, mirror) {
+    ASSERT_EQ(recorder->getMotorIds(), sim->getMotorIds());
+    ASSERT_EQ(recorder->getPosition(), sim->getPosition());
+    for(uint8_t id : sim->getMotorIds()){
+        ASSERT_EQ(recorder->showServomotor(id)->getStatus(), sim->showServomotor(id)->getStatus());
+        ASSERT_EQ(recorder->showServomotor(id)->getTargetPosition(), sim->showServomotor(id)->getTargetPosition());
+        ASSERT_EQ(recorder->showServomotor(id)->getLED(), sim->showServomotor(id)->getLED());
+    }
+}
+
+// Tests that the replay gives back the servomotors and the positions of the recorded session
+TEST_F(RecorderTest, replayPositions) {
+    std::vector<uint16_t> recorded = sim->getPosition();
+
+    armlearn::communication::ReplayController* rep = replay();
+    ASSERT_EQ(rep->getMotorIds().size(), 2);
+
+    replaySetUp(rep);
+    ASSERT_TRUE(rep->finished());
+    ASSERT_EQ(rep->getPosition(), recorded);
+    for(uint8_t id : sim->getMotorIds()){
+        ASSERT_EQ(rep->showServomotor(id)->getStatus(), sim->showServomotor(id)->getStatus());
+        ASSERT_EQ(rep->showServomotor(id)->getTargetPosition(), sim->showServomotor(id)->getTargetPosition());
+        ASSERT_EQ(rep->showServomotor(id)->getTargetSpeed(), sim->showServomotor(id)->getTargetSpeed());
+        ASSERT_EQ(rep->showServomotor(id)->getLED(), sim->showServomotor(id)->getLED());
+    }
+
+    delete rep;
+}
+
+// Tests that exceptions are recorded and thrown back
+TEST_F(RecorderTest, replayException) {
+    ASSERT_THROW(recorder->setPosition(1, 4097), armlearn::OutOfRangeError);
+
+    armlearn::communication::ReplayController* rep = replay();
+    replaySetUp(rep);
+    ASSERT_THROW(rep->setPosition(1, 4097), armlearn::OutOfRangeError);
+    ASSERT_TRUE(rep->finished());
+
+    delete rep;
+}
+
+// Tests that a command differing from the log is detected
+TEST_F(RecorderTest, exceptDivergence) {
+    armlearn::communication::ReplayController* rep = replay();
+    rep->addMotor(3, "elbow", armlearn::communication::elbow);
+    ASSERT_THROW(rep->changeSpeed(60), armlearn::ConnectionError);
+
+    delete rep;
+}
+
+// Tests exception when the log does not exist
+TEST_F(RecorderTest, exceptFile) {
+    ASSERT_THROW(armlearn::communication::ReplayController("missing.armlog"), armlearn::FileError);
+}
+
+// Tests exception when a state update does not carry READ_LENGTH bytes
+TEST_F(RecorderTest, exceptStateSize) {
+    armlearn::communication::SessionLogWriter writer("test_state.armlog");
+    armlearn::communication::SessionRecord record;
+    record.type = armlearn::communication::stateUpdate;
+    record.infos = std::vector<uint8_t>(READ_LENGTH - 1);
+    ASSERT_THROW(writer.write(record), armlearn::FileError);
+
+    std::remove("test_state.armlog");
+}
@@ -56,6 +56,16 @@ TEST_F(ServomotorTest, getType) {
     ASSERT_EQ(servo->getType(), type);
 }
 
+// Test position limits
+TEST_F(ServomotorTest, getLimits) {
+    ASSERT_EQ(servo->getMinPosition(), BASE_MIN);
+    ASSERT_EQ(servo->getMaxPosition(), BASE_MAX);
+
+    servo->setType(armlearn::communication::shoulder);
+    ASSERT_EQ(servo->getMinPosition(), SHOULDER_MIN);
+    ASSERT_EQ(servo->getMaxPosition(), SHOULDER_MAX);
+}
+
 // Test setName
 TEST_F(ServomotorTest, setName) {
     std::string newName = "newServo";
@@ -0,0 +1,103 @@
+/**
+ * @file test_collisionchecker.cpp
+ * @author Gaël Gendron (gael.gendron@insa-rennes.fr)
+ * @brief Testing file of CollisionChecker class
+ * @version 0.1
+ * @date 2026-10-19
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ */
+
+#include <gtest/gtest.h>
+
+#include "collisionchecker.h"
+#include "widowxbuilder.h"
+
+
+class CollisionCheckerTest : public ::testing::Test {
+    protected:
+
+    CollisionCheckerTest() {
+    }
+
+    ~CollisionCheckerTest() override {
+    }
+
+    void SetUp() override {
+        builder.buildCollisionChecker(checker);
+    }
+
+    void TearDown() override {
+    }
+
+    armlearn::WidowXBuilder builder;
+    armlearn::kinematics::CollisionChecker checker;
+};
+
+// Tests that the checker contains 6 servomotors
+TEST_F(CollisionCheckerTest, checkNbServos) {
+    ASSERT_EQ(checker.getNbServos(), 6);
+}
+
+// Tests that the checker can remove its servos
+TEST_F(CollisionCheckerTest, removeNbServos) {
+    checker.removeAllServos();
+    ASSERT_EQ(checker.getNbServos(), 0);
+}
+
+// Tests that the frames are the same as the ones computed by the converters
+TEST_F(CollisionCheckerTest, computeFrames) {
+    checker.computeFrames(BACKHOE_POSITION);
+    auto tip = checker.getFrame(5).pos;
+    auto rep = {0, 346, 267};
+
+    auto verifPtr = tip;
+    for(auto& v : rep) {
+        ASSERT_NEAR(v, *verifPtr, 1);
+        verifPtr++;
+    }
+}
+
+// Tests that the backhoe and sleep positions do not collide
+TEST_F(CollisionCheckerTest, restPositions) {
+    ASSERT_FALSE(checker.collides(BACKHOE_POSITION));
+    ASSERT_FALSE(checker.collides(SLEEP_POSITION));
+}
+
+// Tests that a forearm going through the table is detected
+TEST_F(CollisionCheckerTest, tableCollision) {
+    checker.computeFrames({2048, 2048, 1024, 2048, 512, 256});
+
+    ASSERT_TRUE(checker.workspaceCollision());
+    ASSERT_FALSE(checker.selfCollision());
+}
+
+// Tests that a forearm folded on the base is detected
+TEST_F(CollisionCheckerTest, selfCollision) {
+    checker.computeFrames({2048, 3072, 1024, 2048, 512, 256});
+
+    ASSERT_TRUE(checker.selfCollision());
+    ASSERT_FALSE(checker.workspaceCollision());
+}
+
+// Tests that the workspace box is taken into account
+TEST_F(CollisionCheckerTest, workspaceBox) {
+    checker.setWorkspace({-500, -500, -500}, {500, 300, 500});
+    ASSERT_TRUE(checker.collides(BACKHOE_POSITION));
+
+    checker.removeWorkspace();
+    ASSERT_FALSE(checker.collides(BACKHOE_POSITION));
+}
+
+// Tests that a raised table is taken into account
+TEST_F(CollisionCheckerTest, tableHeight) {
+    checker.setTableHeight(260);
+    ASSERT_TRUE(checker.collides(BACKHOE_POSITION));
+}
+
+// Tests exception throw when the number of positions does not match the number of servomotors
+TEST_F(CollisionCheckerTest, exceptSize) {
+    ASSERT_THROW(checker.collides({2048, 2048, 2048}), armlearn::ComputationError);
+    ASSERT_THROW(checker.setWorkspace({0, 0}, {1, 1, 1}), armlearn::ComputationError);
+}
@@ -15,6 +15,9 @@
 #include "optimcartesianconverter.h"
 #include "basiccartesianconverter.h"
 #include "cylindricalconverter.h"
+#include "analyticcartesianconverter.h"
+#include "widowxbuilder.h"
+#include "nowaitarmsimulator.h"
 #include "convertererror.h"
 
 class OptimCartesianConverterTest : public ::testing::Test {
@@ -64,6 +67,14 @@ TEST_F(OptimCartesianConverterTest, forwardKinematics) {
     }
 }
 
+// Tests that forward kinematics using precomputed tables gives the same results as KDL solvers
+TEST_F(OptimCartesianConverterTest, forwardKinematicsTable) {
+    auto rep = converterFilled.computeServoToCoord({1500, 2500, 1800})->getCoord();
+    auto pos = converterFilled.setForwardMode(armlearn::kinematics::tableComputation)->computeServoToCoord({1500, 2500, 1800})->getCoord();
+
+    for(int k = 0; k < 3; k++) ASSERT_NEAR(rep[k], pos[k], 1e-6);
+}
+
 // Tests that the converter can compute inverse kinematics
 TEST_F(OptimCartesianConverterTest, inverseKinematics) { // TODO: IK cannot be computed yet, make it work
     auto pos = converterFilled.computeCoordToServo({0, 197, 267})->getServo();
@@ -78,6 +89,60 @@ TEST_F(OptimCartesianConverterTest, inverseKinematics) { // TODO: IK cannot be c
     }
 }
 
+// Tests that inverse kinematics results are served from the cache, which is emptied when the device changes
+TEST_F(OptimCartesianConverterTest, inverseKinematicsCache) {
+    armlearn::kinematics::IKCache cache(16, 1);
+    converterFilled.setCache(&cache);
+    cache.insert({0, 191, 267}, {2048, 2048, 2048});
+
+    auto pos = converterFilled.computeCoordToServo({0.2, 191.4, 267.9})->getServo();
+    ASSERT_EQ(pos, std::vector<uint16_t>({2048, 2048, 2048}));
+    ASSERT_EQ(converterFilled.getCoord(), std::vector<double>({0.2, 191.4, 267.9}));
+    ASSERT_EQ(cache.getHits(), 1);
+
+    converterFilled.addServo("wrist", armlearn::kinematics::rotX, 0, 0, 50);
+    ASSERT_EQ(cache.size(), 0);
+}
+
+// Tests that results stored before a change of the servomotor limits are not served
+TEST_F(OptimCartesianConverterTest, inverseKinematicsCacheLimits) {
+    armlearn::kinematics::IKCache cache(16, 1);
+    converterFilled.setCache(&cache);
+    cache.insert({0, 191, 267}, {2048, 2048, 2048});
+
+    converterFilled.setServoLimits({0, 0, 0}, {4095, 4095, 4095});
+    std::vector<uint16_t> positions;
+    converterFilled.tryCoordToServo({0.2, 191.4, 267.9}, positions);
+    ASSERT_EQ(cache.getHits(), 0);
+}
+
+// Tests that the const queries do not serve results stored before a change of the converter
+TEST_F(OptimCartesianConverterTest, inverseKinematicsCacheConst) {
+    armlearn::kinematics::IKCache cache(16, 1);
+    converterFilled.setCache(&cache);
+
+    double coordinates[3] = {0.2, 191.4, 267.9};
+    uint16_t positions[3] = {2048, 2048, 2048};
+    converterFilled.coordToServo(coordinates, positions); // Clone of the calling thread made with the current configuration
+    cache.insert({0, 191, 267}, {111, 222, 333});
+
+    converterFilled.setServoLimits({0, 0, 0}, {4095, 4095, 4095});
+    converterFilled.coordToServo(coordinates, positions);
+    ASSERT_NE(std::vector<uint16_t>(positions, positions + 3), std::vector<uint16_t>({111, 222, 333}));
+}
+
+// Tests that a clone computes the same results, its inner converters being copied
+TEST_F(OptimCartesianConverterTest, clone) {
+    armlearn::kinematics::Converter* copy = converterFilled.clone();
+    ASSERT_EQ(copy->getNbServos(), 3);
+    ASSERT_EQ(copy->computeServoToCoord({1500, 2500, 1800})->getCoord(), converterFilled.computeServoToCoord({1500, 2500, 1800})->getCoord());
+
+    converterFilled.removeAllServos();
+    ASSERT_EQ(copy->computeServoToCoord({2048, 2048, 2048})->getCoord().size(), 3);
+
+    delete copy;
+}
+
 
 
 class BasicCartesianConverterTest : public ::testing::Test {
@@ -127,6 +192,344 @@ TEST_F(BasicCartesianConverterTest, forwardKinematics) {
     }
 }
 
+// Tests that the converter can compute forward kinematics after its device has been rebuilt
+TEST_F(BasicCartesianConverterTest, rebuildServos) {
+    converterFilled.computeServoToCoord({2048, 2048, 2048});
+    converterFilled.removeAllServos();
+    converterFilled.addServo("base", armlearn::kinematics::rotZ, 0, 0, 125, 0, 0, M_PI);
+    converterFilled.addServo("shoulder", armlearn::kinematics::rotX, 0, -49, 142, M_PI/2, 0, M_PI);
+
+    auto pos = converterFilled.computeServoToCoord({2048, 2048})->getCoord();
+    auto rep = {0, 49, 267};
+
+    ASSERT_EQ(pos.size(), 3);
+
+    auto verifPtr = pos.cbegin();
+    for(auto& v : rep) {
+        ASSERT_NEAR(v, *verifPtr, 1);
+        verifPtr++;
+    }
+}
+
+// Tests that batch forward kinematics gives the same results as single computations
+TEST_F(BasicCartesianConverterTest, forwardKinematicsBatch) {
+    armlearn::WidowXBuilder builder;
+    armlearn::kinematics::BasicCartesianConverter widowX;
+    builder.buildConverter(widowX);
+
+    std::vector<uint16_t> positions;
+    int nbConfigs = 11; // Not a multiple of the batch width
+    for(int i = 0; i < nbConfigs; i++) {
+        std::vector<uint16_t> p = {(uint16_t) (300 * i + 100), (uint16_t) (1100 + 170 * i), (uint16_t) (2900 - 150 * i), (uint16_t) (1500 + 100 * i), 512, 256};
+        positions.insert(positions.end(), p.begin(), p.end());
+    }
+
+    std::vector<double> coordinates(3 * nbConfigs);
+    widowX.computeServoToCoordBatch(positions.data(), nbConfigs, coordinates.data());
+
+    for(int i = 0; i < nbConfigs; i++) {
+        auto rep = widowX.computeServoToCoord(std::vector<uint16_t>(positions.begin() + 6 * i, positions.begin() + 6 * (i + 1)))->getCoord();
+        for(int k = 0; k < 3; k++) ASSERT_NEAR(rep[k], coordinates[3 * i + k], 1e-6);
+    }
+}
+
+// Tests that batch forward kinematics gives the orientation of the end of the arm
+TEST_F(BasicCartesianConverterTest, forwardKinematicsBatchOrientation) {
+    std::vector<uint16_t> positions = {2048, 2048, 2048, 2048, 1024, 2048};
+    std::vector<double> coordinates(14);
+    converterFilled.computeServoToCoordBatch(positions.data(), 2, coordinates.data(), true);
+
+    std::vector<std::vector<double>> rep = {{0, 191, 267, -0.7071, 0, 0, 0.7071}, {0, -142, 316, 0, 0, 0, 1}}; // Quaternions [X, Y, Z, W] of the rotations at the tip of the arm
+
+    for(int i = 0; i < 2; i++) {
+        double sign = coordinates[7 * i + 3] * rep[i][3] + coordinates[7 * i + 4] * rep[i][4] + coordinates[7 * i + 5] * rep[i][5] + coordinates[7 * i + 6] * rep[i][6] < 0 ? -1 : 1; // q and -q are the same rotation
+        for(int k = 0; k < 3; k++) ASSERT_NEAR(rep[i][k], coordinates[7 * i + k], 1);
+        for(int k = 3; k < 7; k++) ASSERT_NEAR(rep[i][k], sign * coordinates[7 * i + k], 1e-3);
+    }
+}
+
+// Tests that the non-throwing API reports the result of the computation without changing the last computation
+TEST_F(BasicCartesianConverterTest, tryForwardKinematics) {
+    converterFilled.computeServoToCoord({1500, 2500, 1800});
+
+    std::vector<double> coordinates;
+    ASSERT_EQ(converterFilled.tryServoToCoord({2048, 2048, 2048}, coordinates), armlearn::kinematics::computationSucceeded);
+    ASSERT_EQ(coordinates.size(), 3);
+    ASSERT_NEAR(coordinates[1], 191, 1);
+    ASSERT_EQ(converterFilled.tryServoToCoord({2048, 2048}, coordinates), armlearn::kinematics::invalidInputSize);
+    std::vector<uint16_t> positions = converterFilled.getServo();
+    ASSERT_EQ(converterFilled.tryCoordToServo({0, 191}, positions), armlearn::kinematics::invalidInputSize);
+
+    ASSERT_EQ(converterFilled.getServo(), std::vector<uint16_t>({1500, 2500, 1800}));
+}
+
+// Tests that a clone computes the same results and does not share its device with the original converter
+TEST_F(BasicCartesianConverterTest, clone) {
+    armlearn::kinematics::BasicCartesianConverter* copy = converterFilled.clone();
+    ASSERT_EQ(copy->getNbServos(), 3);
+    ASSERT_EQ(copy->computeServoToCoord({1500, 2500, 1800})->getCoord(), converterFilled.computeServoToCoord({1500, 2500, 1800})->getCoord());
+
+    copy->addServo("wrist", armlearn::kinematics::rotX, 0, 0, 50);
+    ASSERT_EQ(copy->getNbServos(), 4);
+    ASSERT_EQ(converterFilled.getNbServos(), 3);
+    ASSERT_EQ(converterFilled.computeServoToCoord({1500, 2500, 1800})->getCoord().size(), 3);
+
+    delete copy;
+}
+
+// Tests that the const queries can be run concurrently on a shared converter and follow its modifications
+TEST_F(BasicCartesianConverterTest, reentrantQueries) {
+    const int nbConfigs = 200;
+    std::vector<double> rep(nbConfigs * 3), res(nbConfigs * 3);
+    for(int i = 0; i < nbConfigs; i++) {
+        converterFilled.tryServoToCoord({(uint16_t) (1024 + 10 * i), (uint16_t) (2600 - 7 * i), (uint16_t) (1200 + 9 * i)}, rep);
+        std::copy(rep.cbegin(), rep.cbegin() + 3, res.begin() + 3 * i);
+    }
+    rep.swap(res);
+
+    const armlearn::kinematics::Converter& shared = converterFilled;
+    int nbErrors = 0;
+
+    #pragma omp parallel for reduction(+:nbErrors)
+    for(int i = 0; i < nbConfigs; i++) {
+        uint16_t positions[3] = {(uint16_t) (1024 + 10 * i), (uint16_t) (2600 - 7 * i), (uint16_t) (1200 + 9 * i)};
+        if(shared.servoToCoord(positions, &res[3 * i]) != armlearn::kinematics::computationSucceeded) nbErrors++;
+    }
+
+    ASSERT_EQ(nbErrors, 0);
+    for(int k = 0; k < nbConfigs * 3; k++) ASSERT_EQ(rep[k], res[k]);
+
+    converterFilled.addServo("wrist", armlearn::kinematics::rotX, 0, 0, 50);
+    uint16_t positions[4] = {1500, 2500, 1800, 2048};
+    double coordinates[3];
+    ASSERT_EQ(shared.servoToCoord(positions, coordinates), armlearn::kinematics::computationSucceeded);
+
+    std::vector<double> longer;
+    converterFilled.tryServoToCoord({1500, 2500, 1800, 2048}, longer);
+    for(int k = 0; k < 3; k++) ASSERT_EQ(coordinates[k], longer[k]);
+}
+
+// Tests the computations writing into buffers of the caller, without changing the results of the last computation
+TEST_F(BasicCartesianConverterTest, bufferKinematics) {
+    auto last = converterFilled.computeServoToCoord({1500, 2500, 1800})->getCoord();
+
+    uint16_t positions[3] = {1700, 2300, 2100};
+    double coordinates[3];
+    ASSERT_EQ(converterFilled.servoToCoord(positions, coordinates), armlearn::kinematics::computationSucceeded);
+
+    std::vector<double> rep;
+    converterFilled.tryServoToCoord({1700, 2300, 2100}, rep);
+    for(int k = 0; k < 3; k++) ASSERT_EQ(coordinates[k], rep[k]);
+
+    double target[3] = {0, 0, 5000};
+    uint16_t seed[3] = {2048, 2048, 2048};
+    ASSERT_EQ(converterFilled.coordToServo(target, seed), armlearn::kinematics::noSolutionFound);
+    for(int j = 0; j < 3; j++) ASSERT_EQ(seed[j], 2048);
+
+    ASSERT_EQ(converterFilled.getCoord(), last);
+    ASSERT_EQ(converterFilled.getServo(), std::vector<uint16_t>({1500, 2500, 1800}));
+}
+
+// Tests that the jacobian matches the finite differences of the forward kinematics
+TEST_F(BasicCartesianConverterTest, jacobian) {
+    std::vector<uint16_t> positions = {1500, 2500, 1800};
+    std::vector<double> jacobian;
+    ASSERT_EQ(converterFilled.tryJacobian(positions, jacobian), armlearn::kinematics::computationSucceeded);
+    ASSERT_EQ(jacobian.size(), 18);
+
+    for(int j = 0; j < 3; j++){
+        std::vector<uint16_t> before(positions), after(positions);
+        before[j]--;
+        after[j]++;
+
+        auto low = converterFilled.computeServoToCoord(before)->getCoord();
+        auto high = converterFilled.computeServoToCoord(after)->getCoord();
+        for(int k = 0; k < 3; k++) ASSERT_NEAR(jacobian[3 * k + j], (high[k] - low[k]) / 2, 1e-3);
+    }
+
+    ASSERT_NEAR(jacobian[9], 0, 1e-9); // Base rotating along Z axis
+    ASSERT_NEAR(jacobian[15], 2 * M_PI / 4096, 1e-9);
+    ASSERT_EQ(converterFilled.tryJacobian({2048}, jacobian), armlearn::kinematics::invalidInputSize);
+}
+
+// Tests that the gradient of the coordinates matches finite differences, for single and batch computations
+TEST_F(BasicCartesianConverterTest, gradient) {
+    std::vector<uint16_t> positions = {1500, 2500, 1800, 2048, 1024, 3000};
+    double coordinates[6], gradients[18];
+    ASSERT_EQ(converterFilled.tryServoToCoordGradient(positions.data(), coordinates, gradients), armlearn::kinematics::computationSucceeded);
+
+    auto rep = converterFilled.computeServoToCoord({1500, 2500, 1800})->getCoord();
+    for(int k = 0; k < 3; k++) ASSERT_NEAR(coordinates[k], rep[k], 1e-9);
+
+    for(int j = 0; j < 3; j++){
+        std::vector<uint16_t> before(positions.cbegin(), positions.cbegin() + 3), after(before);
+        before[j]--;
+        after[j]++;
+
+        auto low = converterFilled.computeServoToCoord(before)->getCoord();
+        auto high = converterFilled.computeServoToCoord(after)->getCoord();
+        for(int k = 0; k < 3; k++) ASSERT_NEAR(gradients[3 * k + j], (high[k] - low[k]) / 2, 1e-3);
+    }
+
+    converterFilled.computeServoToCoordGradientBatch(positions.data(), 2, coordinates, gradients);
+    for(int c = 0; c < 2; c++){
+        std::vector<uint16_t> config(positions.cbegin() + 3 * c, positions.cbegin() + 3 * (c + 1));
+        std::vector<double> jacobian;
+        converterFilled.tryJacobian(config, jacobian);
+
+        for(int k = 0; k < 9; k++) ASSERT_NEAR(gradients[9 * c + k], jacobian[k], 1e-12);
+    }
+
+    armlearn::kinematics::BasicCartesianConverter converterEmpty;
+    ASSERT_EQ(converterEmpty.tryServoToCoordGradient(positions.data(), coordinates, gradients), armlearn::kinematics::undefinedDevice);
+}
+
+// Tests that velocity steps follow a cartesian displacement and stop the servomotors at their limits
+TEST_F(BasicCartesianConverterTest, velocityStep) {
+    armlearn::WidowXBuilder builder;
+    armlearn::communication::NoWaitArmSimulator sim(armlearn::communication::none);
+    armlearn::kinematics::BasicCartesianConverter widowX;
+    builder.buildController(sim);
+    builder.buildConverter(widowX);
+    widowX.setServoLimits(sim);
+
+    std::vector<uint16_t> positions = {2048, 2300, 1700, 2200, 512, 256};
+    auto start = widowX.computeServoToCoord(positions)->getCoord();
+    std::vector<double> target = {start[0] + 20, start[1] - 15, start[2] + 10};
+
+    std::vector<double> current(positions.cbegin(), positions.cend());
+    std::vector<double> motion;
+    for(int step = 0; step < 20; step++){
+        auto coord = widowX.computeServoToCoord(positions)->getCoord();
+        std::vector<double> displacement = {(target[0] - coord[0]) / 4, (target[1] - coord[1]) / 4, (target[2] - coord[2]) / 4};
+        ASSERT_EQ(widowX.tryVelocityStep(positions, displacement, motion), armlearn::kinematics::computationSucceeded);
+
+        for(int j = 0; j < 6; j++){
+            current[j] += motion[j];
+            positions[j] = std::round(current[j]);
+        }
+    }
+
+    auto res = widowX.computeServoToCoord(positions)->getCoord();
+    for(int k = 0; k < 3; k++) ASSERT_NEAR(res[k], target[k], 1);
+
+    positions[1] = SHOULDER_MIN;
+    ASSERT_EQ(widowX.tryVelocityStep(positions, {0, 0, -5}, motion), armlearn::kinematics::computationSucceeded);
+    ASSERT_EQ(motion[1], 0);
+    ASSERT_EQ(widowX.tryVelocityStep(positions, {0, 0, 5}, motion), armlearn::kinematics::computationSucceeded);
+    ASSERT_GT(motion[1], 0); // Moving away from the limit is allowed
+    ASSERT_EQ(widowX.tryVelocityStep(positions, {0, 0}, motion), armlearn::kinematics::invalidInputSize);
+}
+
+// Tests that tracking inverse kinematics follows nearby targets in a bounded number of iterations, keeping the branch of the previous solution
+TEST_F(BasicCartesianConverterTest, trackingInverseKinematics) {
+    armlearn::WidowXBuilder builder;
+    armlearn::communication::NoWaitArmSimulator sim(armlearn::communication::none);
+    armlearn::kinematics::BasicCartesianConverter widowX;
+    builder.buildController(sim);
+    builder.buildConverter(widowX);
+    widowX.setServoLimits(sim);
+    widowX.setTrackingLimits(4, 1);
+
+    auto start = widowX.computeServoToCoord({2048, 2300, 1700, 2200, 512, 256})->getCoord();
+    for(int step = 1; step <= 20; step++){
+        std::vector<double> target = {start[0] + step, start[1] - 0.75 * step, start[2] + 0.5 * step};
+        auto previous = widowX.getServo();
+        auto servo = widowX.computeTrackCoord(target)->getServo();
+        auto report = widowX.getTrackingReport();
+
+        ASSERT_TRUE(report.converged);
+        ASSERT_LE(report.iterations, 4);
+        ASSERT_EQ(widowX.getCoord(), target);
+        for(int j = 0; j < 6; j++) ASSERT_NEAR(servo[j], previous[j], 50);
+
+        auto reached = widowX.computeServoToCoord(servo)->getCoord();
+        double error = std::sqrt(std::pow(reached[0] - target[0], 2) + std::pow(reached[1] - target[1], 2) + std::pow(reached[2] - target[2], 2));
+        ASSERT_NEAR(report.error, error, 1e-6);
+    }
+
+    // Distant target, the positions being given after the allowed iterations with the remaining error
+    armlearn::kinematics::TrackingReport report;
+    std::vector<uint16_t> positions = widowX.getServo();
+    widowX.setTrackingLimits(1, 1);
+    ASSERT_EQ(widowX.tryTrackCoord({start[0] + 80, start[1], start[2] - 60}, positions, report), armlearn::kinematics::computationSucceeded);
+    ASSERT_EQ(report.iterations, 1);
+    ASSERT_FALSE(report.converged);
+    ASSERT_GT(report.error, 1);
+    ASSERT_TRUE(widowX.validPosition(positions.data()));
+
+    ASSERT_EQ(widowX.tryTrackCoord({0, 0}, positions, report), armlearn::kinematics::invalidInputSize);
+    ASSERT_THROW(widowX.setTrackingLimits(0, 1), armlearn::ComputationError);
+    ASSERT_THROW(widowX.setTrackingLimits(4, -1), armlearn::ComputationError);
+}
+
+// Tests exception when the servomotors of the controller do not match the converter
+TEST_F(BasicCartesianConverterTest, controllerLimitsExcept) {
+    armlearn::WidowXBuilder builder;
+    armlearn::communication::NoWaitArmSimulator sim(armlearn::communication::none);
+    builder.buildController(sim);
+
+    ASSERT_THROW(converterFilled.setServoLimits(sim), armlearn::ComputationError);
+}
+
+// Tests that forward kinematics using precomputed tables gives the same results as KDL solvers
+TEST_F(BasicCartesianConverterTest, forwardKinematicsTable) {
+    armlearn::WidowXBuilder builder;
+    armlearn::kinematics::BasicCartesianConverter solverConverter;
+    armlearn::kinematics::BasicCartesianConverter tableConverter;
+    builder.buildConverter(solverConverter);
+    builder.buildConverter(tableConverter);
+    tableConverter.setForwardMode(armlearn::kinematics::tableComputation);
+
+    for(int i = 0; i < 50; i++) {
+        std::vector<uint16_t> p = {(uint16_t) (81 * i), (uint16_t) (1100 + 37 * i), (uint16_t) (2950 - 35 * i), (uint16_t) (1100 + 19 * i), (uint16_t) (20 * i), (uint16_t) (10 * i)};
+
+        auto rep = solverConverter.computeServoToCoord(p)->getCoord();
+        auto pos = tableConverter.computeServoToCoord(p)->getCoord();
+
+        ASSERT_EQ(pos.size(), 3);
+        for(int k = 0; k < 3; k++) ASSERT_NEAR(rep[k], pos[k], 1e-9);
+    }
+}
+
+// Tests that single precision forward kinematics stays close to the double precision results, for single and batch computations
+TEST_F(BasicCartesianConverterTest, forwardKinematicsSinglePrecision) {
+    armlearn::WidowXBuilder builder;
+    armlearn::kinematics::BasicCartesianConverter solverConverter;
+    armlearn::kinematics::BasicCartesianConverter singleConverter;
+    builder.buildConverter(solverConverter);
+    builder.buildConverter(singleConverter);
+    singleConverter.setForwardMode(armlearn::kinematics::singlePrecisionComputation);
+
+    int nbConfigs = 37; // Not a multiple of the number of lanes
+    std::vector<uint16_t> positions;
+    std::vector<double> rep;
+    for(int i = 0; i < nbConfigs; i++) {
+        std::vector<uint16_t> p = {(uint16_t) (81 * i), (uint16_t) (1100 + 37 * i), (uint16_t) (2950 - 35 * i), (uint16_t) (1100 + 19 * i), (uint16_t) (20 * i), (uint16_t) (10 * i)};
+        positions.insert(positions.end(), p.cbegin(), p.cend());
+
+        auto res = solverConverter.computeServoToCoord(p)->getCoord();
+        auto pos = singleConverter.computeServoToCoord(p)->getCoord();
+        rep.insert(rep.end(), res.cbegin(), res.cend());
+
+        ASSERT_EQ(pos.size(), 3);
+        for(int k = 0; k < 3; k++) ASSERT_NEAR(res[k], pos[k], 1e-3);
+    }
+
+    std::vector<float> single(nbConfigs * 3);
+    std::vector<double> batch(nbConfigs * 3);
+    singleConverter.computeServoToCoordBatch(positions.data(), nbConfigs, single.data());
+    singleConverter.computeServoToCoordBatch(positions.data(), nbConfigs, batch.data());
+    for(int i = 0; i < nbConfigs * 3; i++) {
+        ASSERT_NEAR(rep[i], single[i], 1e-3);
+        ASSERT_EQ(batch[i], single[i]);
+    }
+
+    // Conversion of the double precision results in the other modes
+    solverConverter.computeServoToCoordBatch(positions.data(), nbConfigs, single.data());
+    for(int i = 0; i < nbConfigs * 3; i++) ASSERT_FLOAT_EQ(rep[i], single[i]);
+}
+
 // Tests that the converter can compute inverse kinematics
 TEST_F(BasicCartesianConverterTest, inverseKinematics) { // TODO: IK cannot be computed yet, make it work
     auto pos = converterFilled.computeCoordToServo({0, 197, 267})->getServo();
@@ -142,6 +545,56 @@ TEST_F(BasicCartesianConverterTest, inverseKinematics) { // TODO: IK cannot be c
 }
 
 
+// Tests that the Levenberg-Marquardt solver reaches targets of the WidowX arm while keeping the servomotors within their limits
+TEST_F(BasicCartesianConverterTest, inverseKinematicsLevenbergMarquardt) {
+    armlearn::WidowXBuilder builder;
+    armlearn::communication::NoWaitArmSimulator sim(armlearn::communication::none);
+    armlearn::kinematics::BasicCartesianConverter widowX;
+    builder.buildController(sim);
+    builder.buildConverter(widowX);
+    widowX.setServoLimits(sim);
+    widowX.setSolver(armlearn::kinematics::levenbergMarquardtSolver, 200, 1e-3);
+    ASSERT_EQ(widowX.getSolver(), armlearn::kinematics::levenbergMarquardtSolver);
+
+    std::vector<std::vector<uint16_t>> configs = {{1500, 2300, 1700, 2200, 512, 256}, {2600, 1800, 2400, 1600, 512, 256}, {2048, 2600, 1400, 2048, 512, 256}};
+    for(auto& config : configs){
+        auto target = widowX.computeServoToCoord(config)->getCoord();
+
+        std::vector<uint16_t> positions = {2048, 2048, 2048, 2048, 512, 256};
+        ASSERT_EQ(widowX.tryCoordToServo(target, positions), armlearn::kinematics::computationSucceeded);
+
+        ASSERT_TRUE(sim.validPosition(positions));
+
+        auto res = widowX.computeServoToCoord(positions)->getCoord();
+        for(int k = 0; k < 3; k++) ASSERT_NEAR(res[k], target[k], 1);
+    }
+
+    std::vector<uint16_t> positions = {2048, 2048, 2048, 2048, 512, 256};
+    ASSERT_EQ(widowX.tryCoordToServo({0, 0, 2000}, positions), armlearn::kinematics::noSolutionFound);
+    ASSERT_THROW(widowX.setSolver(armlearn::kinematics::newtonRaphsonSolver, 0), armlearn::ConverterError);
+}
+
+// Tests that the Levenberg-Marquardt solver still works after tracking inverse kinematics ran on the same converter
+TEST_F(BasicCartesianConverterTest, inverseKinematicsAfterTracking) {
+    armlearn::WidowXBuilder builder;
+    armlearn::communication::NoWaitArmSimulator sim(armlearn::communication::none);
+    armlearn::kinematics::BasicCartesianConverter widowX;
+    builder.buildController(sim);
+    builder.buildConverter(widowX);
+    widowX.setServoLimits(sim);
+    widowX.setSolver(armlearn::kinematics::levenbergMarquardtSolver, 200, 1e-3);
+
+    auto start = widowX.computeServoToCoord({2048, 2300, 1700, 2200, 512, 256})->getCoord();
+    widowX.computeTrackCoord({start[0] + 1, start[1], start[2]});
+
+    auto target = widowX.computeServoToCoord({1500, 2300, 1700, 2200, 512, 256})->getCoord();
+    std::vector<uint16_t> positions = {2048, 2048, 2048, 2048, 512, 256};
+    ASSERT_EQ(widowX.tryCoordToServo(target, positions), armlearn::kinematics::computationSucceeded);
+
+    auto res = widowX.computeServoToCoord(positions)->getCoord();
+    for(int k = 0; k < 3; k++) ASSERT_NEAR(res[k], target[k], 1);
+}
+
 
 class CylindricalConverterTest : public ::testing::Test {
     protected:
@@ -205,12 +658,327 @@ TEST_F(CylindricalConverterTest, inverseKinematics) { // TODO: IK cannot be comp
     }
 }
 
+// Tests that batch forward kinematics gives cylindrical coordinates, without changing the last computation
+TEST_F(CylindricalConverterTest, forwardKinematicsBatch) {
+    converterFilled.computeServoToCoord({2048, 2048, 2048});
+
+    std::vector<uint16_t> positions = {2048, 2048, 2048, 3072, 2048, 2048};
+    std::vector<double> coordinates(6);
+    converterFilled.computeServoToCoordBatch(positions.data(), 2, coordinates.data());
+
+    ASSERT_NEAR(coordinates[0], 191, 1);
+    ASSERT_NEAR(coordinates[1], M_PI/2, 1e-3);
+    ASSERT_NEAR(coordinates[4], M_PI, 1e-3);
+    ASSERT_NEAR(converterFilled.getCoord()[1], M_PI/2, 1e-3);
+    ASSERT_THROW(converterFilled.computeServoToCoordBatch(positions.data(), 2, coordinates.data(), true), armlearn::ComputationError);
+}
+
+// Tests that forward kinematics using precomputed tables gives the same results as KDL solvers
+TEST_F(CylindricalConverterTest, forwardKinematicsTable) {
+    auto rep = converterFilled.computeServoToCoord({1500, 2500, 1800})->getCoord();
+    auto pos = converterFilled.setForwardMode(armlearn::kinematics::tableComputation)->computeServoToCoord({1500, 2500, 1800})->getCoord();
+
+    ASSERT_EQ(converterFilled.getForwardMode(), armlearn::kinematics::tableComputation);
+    for(int k = 0; k < 3; k++) ASSERT_NEAR(rep[k], pos[k], 1e-9);
+}
+
 // Tests exception throw when arm does not have a cylindrical base
 TEST_F(CylindricalConverterTest, noBaseExcept) {
     ASSERT_THROW(converterEmpty.addServo("notPossibleMotor", armlearn::kinematics::transX, 0, 0, 71), armlearn::ConverterError);
 }
 
+// Tests that computations on a device without base fail, with a status or an exception
+TEST_F(CylindricalConverterTest, undefinedDevice) {
+    std::vector<double> coordinates;
+    ASSERT_EQ(converterEmpty.tryServoToCoord({2048}, coordinates), armlearn::kinematics::undefinedDevice);
+    ASSERT_THROW(converterEmpty.computeServoToCoord({2048}), armlearn::ConverterError);
+}
+
+// Tests that inverse kinematics keeps the solution of lowest cost among the orientations of the base
+TEST_F(CylindricalConverterTest, inverseKinematicsSeeds) {
+    armlearn::kinematics::CylindricalConverter planar; // Moving part only made of translations, every orientation of the base leads to a solution
+    armlearn::kinematics::BasicCartesianConverter reference;
+    for(armlearn::kinematics::Converter* conv : std::initializer_list<armlearn::kinematics::Converter*>{&planar, &reference}){
+        conv->addServo("base", armlearn::kinematics::rotZ);
+        conv->addServo("x", armlearn::kinematics::transX);
+        conv->addServo("y", armlearn::kinematics::transY);
+        conv->addServo("z", armlearn::kinematics::transZ);
+    }
+
+    std::vector<uint16_t> current = {2048, 2548, 2348, 2148};
+    auto target = planar.computeServoToCoord(current)->getCoord();
+    auto goal = reference.computeServoToCoord(current)->getCoord();
+
+    auto pos = planar.computeCoordToServo(target)->getServo();
+    auto res = reference.computeServoToCoord(pos)->getCoord();
+    for(int k = 0; k < 3; k++) ASSERT_NEAR(goal[k], res[k], 1e-2);
+    ASSERT_NEAR(pos[0], current[0], 4096 / CYLINDRICAL_NB_SEEDS);
+
+    planar.setSeedCost([](const std::vector<uint16_t>& candidate, const std::vector<uint16_t>& current){ return -candidate[0]; });
+    auto highest = planar.computeServoToCoord(current)->computeCoordToServo(target)->getServo();
+    res = reference.computeServoToCoord(highest)->getCoord();
+    for(int k = 0; k < 3; k++) ASSERT_NEAR(goal[k], res[k], 1e-2);
+    ASSERT_GT(highest[0], pos[0]);
+}
+
+// Tests that the base is given the nearest valid position, an angle of PI being the same position as -PI
+TEST_F(CylindricalConverterTest, inverseKinematicsBaseRange) {
+    armlearn::kinematics::CylindricalConverter planar;
+    planar.addServo("base", armlearn::kinematics::rotZ);
+    planar.addServo("x", armlearn::kinematics::transX);
+    planar.addServo("y", armlearn::kinematics::transY);
+    planar.addServo("z", armlearn::kinematics::transZ);
+
+    auto target = planar.computeServoToCoord({2048, 2548, 2348, 2148})->getCoord();
+    target[1] = M_PI;
+
+    std::vector<uint16_t> positions; // First orientation of the base tried being 0, the base is turned by PI
+    ASSERT_EQ(planar.tryCoordToServo(target, positions), armlearn::kinematics::computationSucceeded);
+    ASSERT_EQ(positions[0], 0);
+}
+
+// Tests that tracking inverse kinematics turns the base toward nearby targets, without sweeping its orientations
+TEST_F(CylindricalConverterTest, trackingInverseKinematics) {
+    armlearn::kinematics::BasicCartesianConverter reference;
+    reference.addServo("base", armlearn::kinematics::rotZ, 0, 0, 125, 0, 0, M_PI);
+    reference.addServo("shoulder", armlearn::kinematics::rotX, 0, -49, 142, M_PI/2, 0, M_PI);
+    reference.addServo("elbow", armlearn::kinematics::fixed, 0, 0, 71);
+    reference.addServo("elbow", armlearn::kinematics::rotX, 0, 0, 71);
+
+    std::vector<uint16_t> current = {2048, 2300, 1800};
+    auto cartesian = reference.computeServoToCoord(current)->getCoord();
+    std::vector<double> start = {std::hypot(cartesian[0], cartesian[1]), std::atan2(cartesian[1], cartesian[0]), cartesian[2]};
+
+    converterFilled.setTrackingLimits(4, 0.5);
+    converterFilled.computeServoToCoord(current);
+    for(int step = 1; step <= 10; step++){
+        std::vector<double> target = {start[0] + step, start[1] + 0.01 * step, start[2] - step};
+        auto previous = converterFilled.getServo();
+        auto servo = converterFilled.computeTrackCoord(target)->getServo();
+        auto report = converterFilled.getTrackingReport();
+
+        ASSERT_TRUE(report.converged);
+        ASSERT_LE(report.iterations, 4);
+        for(int j = 0; j < 3; j++) ASSERT_NEAR(servo[j], previous[j], 50);
+
+        auto reached = reference.computeServoToCoord(servo)->getCoord();
+        ASSERT_NEAR(reached[0], target[0] * std::cos(target[1]), 0.5);
+        ASSERT_NEAR(reached[1], target[0] * std::sin(target[1]), 0.5);
+        ASSERT_NEAR(reached[2], target[2], 0.5);
+    }
+
+    std::vector<uint16_t> positions = {2048};
+    armlearn::kinematics::TrackingReport report;
+    ASSERT_EQ(converterEmpty.tryTrackCoord(start, positions, report), armlearn::kinematics::undefinedDevice);
+}
+
+// Tests that a clone computes the same results, its inner converters being copied
+TEST_F(CylindricalConverterTest, clone) {
+    armlearn::kinematics::Converter* copy = converterFilled.clone();
+    ASSERT_EQ(copy->getNbServos(), 3);
+    ASSERT_EQ(copy->computeServoToCoord({1500, 2500, 1800})->getCoord(), converterFilled.computeServoToCoord({1500, 2500, 1800})->getCoord());
+
+    converterFilled.removeAllServos();
+    ASSERT_EQ(copy->computeServoToCoord({2048, 2048, 2048})->getCoord().size(), 3);
+
+    delete copy;
+}
+
+
+
+
+
+
+
+
+class AnalyticCartesianConverterTest : public ::testing::Test {
+    protected:
+
+    AnalyticCartesianConverterTest() {
+    }
+
+    ~AnalyticCartesianConverterTest() override {
+    }
+
+    void SetUp() override {
+        converterFilled.addServo("base", armlearn::kinematics::rotZ, 0, 0, 125, 0, 0, M_PI);
+        converterFilled.addServo("shoulder", armlearn::kinematics::rotX, 0, -49, 142, M_PI/2, 0, M_PI);
+        converterFilled.addServo("elbow", armlearn::kinematics::fixed, 0, 0, 71);
+        converterFilled.addServo("elbow", armlearn::kinematics::rotX, 0, 0, 71);
+
+        builder.buildConverter(widowX);
+    }
+
+    void TearDown() override {
+    }
+
+    armlearn::WidowXBuilder builder;
+    armlearn::kinematics::AnalyticCartesianConverter converterFilled;
+    armlearn::kinematics::AnalyticCartesianConverter converterEmpty;
+    armlearn::kinematics::AnalyticCartesianConverter widowX;
+};
+
+// Tests that the converter contains 3 servomotors
+TEST_F(AnalyticCartesianConverterTest, checkNbServos) {
+    ASSERT_EQ(converterFilled.getNbServos(), 3);
+}
+
+// Tests that the converter can remove its servos
+TEST_F(AnalyticCartesianConverterTest, removeNbServos) {
+    converterFilled.removeAllServos();
+    ASSERT_EQ(converterFilled.getNbServos(), 0);
+}
+
+// Tests that the converter can compute forward kinematics
+TEST_F(AnalyticCartesianConverterTest, forwardKinematics) {
+    auto pos = converterFilled.computeServoToCoord({2048, 2048, 2048})->getCoord();
+    auto rep = {0, 191, 267};
+
+    ASSERT_EQ(pos.size(), 3);
+
+    auto verifPtr = pos.cbegin();
+    for(auto& v : rep) {
+        ASSERT_NEAR(v, *verifPtr, 1);
+        verifPtr++;
+    }
+}
+
+// Tests that the converter can compute inverse kinematics
+TEST_F(AnalyticCartesianConverterTest, inverseKinematics) {
+    auto pos = converterFilled.computeCoordToServo({0, 191, 267})->getServo();
+    auto rep = {2048, 2048, 2048};
+
+    ASSERT_EQ(pos.size(), 3);
+
+    auto verifPtr = pos.cbegin();
+    for(auto& v : rep) {
+        ASSERT_NEAR(v, *verifPtr, 1);
+        verifPtr++;
+    }
+}
+
+// Tests that positions computed by inverse kinematics of the WidowX arm lead back to the coordinates, within the servomotor limits
+TEST_F(AnalyticCartesianConverterTest, roundTrip) {
+    std::vector<std::vector<uint16_t>> positions = {{2048, 2048, 2048, 2048, 512, 256}, {1000, 1500, 2500, 1800, 512, 256}, {3000, 2600, 1300, 2300, 100, 50}, {2048, 1025, 1025, 1830, 512, 256}};
+
+    for(auto& p : positions) {
+        auto coord = widowX.computeServoToCoord(p)->getCoord();
+        auto servo = widowX.computeCoordToServo(coord)->getServo();
+        auto res = widowX.computeServoToCoord(servo)->getCoord();
+
+        ASSERT_EQ(servo.size(), 6);
+        ASSERT_TRUE(servo[1] > SHOULDER_MIN && servo[1] < SHOULDER_MAX);
+        ASSERT_TRUE(servo[2] > ELBOW_MIN && servo[2] < ELBOW_MAX);
+        ASSERT_TRUE(servo[3] > WRISTANGLE_MIN && servo[3] < WRISTANGLE_MAX);
+        for(int i = 0; i < 3; i++) ASSERT_NEAR(coord[i], res[i], 2);
+    }
+}
+
+// Tests that inverse kinematics in single precision gives the double precision positions, up to one unit at rounding boundaries
+TEST_F(AnalyticCartesianConverterTest, singlePrecision) {
+    armlearn::kinematics::AnalyticCartesianConverter single;
+    builder.buildConverter(single);
+    single.setForwardMode(armlearn::kinematics::singlePrecisionComputation);
+
+    std::vector<std::vector<uint16_t>> positions = {{2048, 2048, 2048, 2048, 512, 256}, {1000, 1500, 2500, 1800, 512, 256}, {3000, 2600, 1300, 2300, 100, 50}, {2048, 1025, 1025, 1830, 512, 256}};
+
+    for(auto& p : positions) {
+        auto coord = widowX.computeServoToCoord(p)->getCoord();
+        auto rep = widowX.computeCoordToServo(coord)->getServo();
+        single.computeServoToCoord(p); // Same starting position
+        auto servo = single.computeCoordToServo(coord)->getServo();
+        auto res = single.computeServoToCoord(servo)->getCoord();
+
+        ASSERT_EQ(servo.size(), 6);
+        for(int i = 0; i < 6; i++) ASSERT_NEAR(servo[i], rep[i], 1);
+        for(int i = 0; i < 3; i++) ASSERT_NEAR(coord[i], res[i], 2);
+    }
+}
+
+// Tests that the pose inverse kinematics returns every branch reaching the position and approach vector of the WidowX arm
+TEST_F(AnalyticCartesianConverterTest, poseInverseKinematics) {
+    std::vector<std::vector<uint16_t>> positions = {{2048, 2048, 2048, 2048, 512, 256}, {1000, 1500, 2500, 1800, 512, 256}, {3000, 2600, 1300, 2300, 100, 50}, {2048, 1400, 2200, 2600, 700, 256}};
+
+    for(auto& p : positions) {
+        std::vector<double> pose;
+        ASSERT_EQ(widowX.tryServoToPose(p, pose), armlearn::kinematics::computationSucceeded);
+        ASSERT_EQ(pose.size(), 6);
+
+        std::vector<std::vector<uint16_t>> solutions;
+        ASSERT_EQ(widowX.tryPoseToServo(pose, p, solutions), armlearn::kinematics::computationSucceeded);
+        ASSERT_GE(solutions.size(), 1);
+        ASSERT_LE(solutions.size(), 4);
+        for(int i = 0; i < 6; i++) ASSERT_NEAR(solutions[0][i], p[i], 2); // Closest branch first
+
+        for(auto& servo : solutions) {
+            std::vector<double> res;
+            ASSERT_EQ(widowX.tryServoToPose(servo, res), armlearn::kinematics::computationSucceeded);
+
+            for(int i = 0; i < 3; i++) ASSERT_NEAR(pose[i], res[i], 2);
+            ASSERT_GT(pose[3] * res[3] + pose[4] * res[4] + pose[5] * res[5], 0.999);
+            ASSERT_EQ(servo[4], p[4]); // Roll kept
+        }
+    }
+
+    // Same position with the approach vector tilted within the vertical plane of the arm
+    std::vector<double> pose;
+    widowX.computeServoToCoord({1000, 1500, 2500, 1800, 512, 256});
+    widowX.tryServoToPose({1000, 1500, 2500, 1800, 512, 256}, pose);
+
+    double direction = std::atan2(pose[1], pose[0]);
+    double normal[3] = {-std::sin(direction), std::cos(direction), 0};
+    double c = std::cos(0.2), s = std::sin(0.2);
+    double cross[3] = {normal[1] * pose[5] - normal[2] * pose[4], normal[2] * pose[3] - normal[0] * pose[5], normal[0] * pose[4] - normal[1] * pose[3]};
+    std::vector<double> tilted = {pose[0], pose[1], pose[2], c * pose[3] + s * cross[0], c * pose[4] + s * cross[1], c * pose[5] + s * cross[2]};
+
+    auto servo = widowX.computePoseToServo(tilted)->getServo();
+    std::vector<double> res;
+    widowX.tryServoToPose(servo, res);
+    for(int i = 0; i < 3; i++) ASSERT_NEAR(tilted[i], res[i], 2);
+    ASSERT_GT(tilted[3] * res[3] + tilted[4] * res[4] + tilted[5] * res[5], 0.999);
+    ASSERT_EQ(widowX.getCoord(), std::vector<double>(tilted.cbegin(), tilted.cbegin() + 3));
+}
+
+// Tests that the poses the device cannot reach are rejected
+TEST_F(AnalyticCartesianConverterTest, poseInverseKinematicsExcept) {
+    std::vector<double> pose;
+    widowX.tryServoToPose({1000, 1500, 2500, 1800, 512, 256}, pose);
+
+    // Approach vector out of the vertical plane of the arm
+    double c = std::cos(0.3), s = std::sin(0.3);
+    std::vector<double> turned = {pose[0], pose[1], pose[2], c * pose[3] - s * pose[4], s * pose[3] + c * pose[4], pose[5]};
+    std::vector<std::vector<uint16_t>> solutions;
+    ASSERT_EQ(widowX.tryPoseToServo(turned, {}, solutions), armlearn::kinematics::noSolutionFound);
+    ASSERT_TRUE(solutions.empty());
+
+    ASSERT_THROW(widowX.computePoseToServo({0, 0, 1000, 0, 0, 1}), armlearn::ComputationError);
+    ASSERT_THROW(widowX.computePoseToServo({0, 0, 1000}), armlearn::ComputationError);
+    ASSERT_THROW(converterFilled.computePoseToServo({0, 191, 267, 0, 1, 0}), armlearn::ConverterError); // No wrist
+}
+
+// Tests that the closest solution to the last position is kept
+TEST_F(AnalyticCartesianConverterTest, closestSolution) {
+    std::vector<uint16_t> p = {1000, 1500, 2500, 1800, 512, 256};
+    auto coord = widowX.computeServoToCoord(p)->getCoord();
+    auto servo = widowX.computeCoordToServo(coord)->getServo();
 
+    for(int i = 0; i < 6; i++) ASSERT_NEAR(servo[i], p[i], 2);
+}
 
+// Tests exception throw when coordinates are out of reach
+TEST_F(AnalyticCartesianConverterTest, unreachableExcept) {
+    ASSERT_THROW(widowX.computeCoordToServo({0, 0, 1000}), armlearn::ComputationError);
 
+    std::vector<uint16_t> positions;
+    ASSERT_EQ(widowX.tryCoordToServo({0, 0, 1000}, positions), armlearn::kinematics::noSolutionFound);
+}
 
+// Tests exception throw when arm does not have a base rotating along Z axis
+TEST_F(AnalyticCartesianConverterTest, noBaseExcept) {
+    ASSERT_THROW(converterEmpty.addServo("notPossibleMotor", armlearn::kinematics::rotX, 0, 0, 71), armlearn::ConverterError);
+}
+
+// Tests exception throw when limits do not match the number of servomotors
+TEST_F(AnalyticCartesianConverterTest, limitsExcept) {
+    ASSERT_THROW(converterFilled.setServoLimits({0, 0}, {4095, 4095}), armlearn::ComputationError);
+}
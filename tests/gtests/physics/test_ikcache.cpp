@@ -0,0 +1,102 @@
+/**
+ * @file test_ikcache.cpp
+ * @author Gaël Gendron (gael.gendron@insa-rennes.fr)
+ * @brief Testing file of the IKCache class
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <thread>
+
+#include "ikcache.h"
+
+
+class IKCacheTest : public ::testing::Test {
+    protected:
+
+    IKCacheTest():cache(3, 1.0) {
+    }
+
+    ~IKCacheTest() override {
+    }
+
+    void SetUp() override {
+        cache.insert({5, 50, 300}, {2048, 1500, 2500});
+        cache.insert({0, 191, 267}, {2048, 2048, 2048});
+    }
+
+    void TearDown() override {
+    }
+
+    armlearn::kinematics::IKCache cache;
+};
+
+
+// Tests that coordinates within the same cell give back the stored result
+TEST_F(IKCacheTest, find) {
+    std::vector<uint16_t> pos;
+    ASSERT_TRUE(cache.find({5.3, 50.9, 300.1}, pos));
+    ASSERT_EQ(pos, std::vector<uint16_t>({2048, 1500, 2500}));
+
+    ASSERT_FALSE(cache.find({4.9, 50, 300}, pos));
+    ASSERT_EQ(pos, std::vector<uint16_t>({2048, 1500, 2500}));
+
+    ASSERT_EQ(cache.getHits(), 1);
+    ASSERT_EQ(cache.getMisses(), 1);
+}
+
+// Tests that the least recently used result is dropped when the cache is full
+TEST_F(IKCacheTest, evict) {
+    std::vector<uint16_t> pos;
+    ASSERT_TRUE(cache.find({5, 50, 300}, pos));
+
+    cache.insert({10, 10, 10}, {1, 2, 3});
+    cache.insert({20, 20, 20}, {4, 5, 6});
+
+    ASSERT_EQ(cache.size(), 3);
+    ASSERT_TRUE(cache.find({5, 50, 300}, pos));
+    ASSERT_FALSE(cache.find({0, 191, 267}, pos));
+}
+
+// Tests that a result can be replaced
+TEST_F(IKCacheTest, replace) {
+    cache.insert({5, 50, 300}, {1, 2, 3});
+
+    std::vector<uint16_t> pos;
+    ASSERT_EQ(cache.size(), 2);
+    ASSERT_TRUE(cache.find({5, 50, 300}, pos));
+    ASSERT_EQ(pos, std::vector<uint16_t>({1, 2, 3}));
+}
+
+// Tests that the cache can be emptied
+TEST_F(IKCacheTest, clear) {
+    cache.clear();
+
+    std::vector<uint16_t> pos;
+    ASSERT_EQ(cache.size(), 0);
+    ASSERT_FALSE(cache.find({5, 50, 300}, pos));
+}
+
+// Tests that the cache can be used by several threads at once
+TEST_F(IKCacheTest, concurrency) {
+    armlearn::kinematics::IKCache shared(64, 1.0);
+
+    std::vector<std::thread> threads;
+    for(int t = 0; t < 4; t++){
+        threads.emplace_back([&shared, t](){
+            std::vector<uint16_t> pos;
+            for(int i = 0; i < 1000; i++){
+                std::vector<double> target = {(double) (i % 100), (double) t, 0};
+                if(!shared.find(target, pos)) shared.insert(target, {(uint16_t) i, (uint16_t) t, 0});
+            }
+        });
+    }
+    for(auto& thread : threads) thread.join();
+
+    ASSERT_EQ(shared.size(), 64);
+    ASSERT_EQ(shared.getHits() + shared.getMisses(), 4000);
+}
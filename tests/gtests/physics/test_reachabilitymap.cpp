@@ -0,0 +1,127 @@
+/**
+ * @file test_reachabilitymap.cpp
+ * @author Gaël Gendron (gael.gendron@insa-rennes.fr)
+ * @brief Testing file of the ReachabilityMap class
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <random>
+
+#include "reachabilitymap.h"
+#include "basiccartesianconverter.h"
+#include "analyticcartesianconverter.h"
+#include "optimcartesianconverter.h"
+
+
+class ReachabilityMapTest : public ::testing::Test {
+    protected:
+
+    ReachabilityMapTest() {
+        converter.addServo("base", armlearn::kinematics::rotZ, 0, 0, 125, 0, 0, M_PI);
+        converter.addServo("shoulder", armlearn::kinematics::rotX, 0, -49, 142, M_PI/2, 0, M_PI);
+        converter.addServo("elbow", armlearn::kinematics::fixed, 0, 0, 71);
+        converter.addServo("elbow", armlearn::kinematics::rotX, 0, 0, 71);
+
+        map.build(converter, {1024, 1024, 1024}, {3072, 3072, 3072}, {17, 17, 17}, {0, 0, 125}, 10);
+    }
+
+    ~ReachabilityMapTest() override {
+    }
+
+    void SetUp() override {
+    }
+
+    void TearDown() override {
+    }
+
+    armlearn::kinematics::BasicCartesianConverter converter;
+    armlearn::kinematics::ReachabilityMap map;
+};
+
+
+// Tests that an empty map rejects nothing
+TEST_F(ReachabilityMapTest, emptyMap) {
+    armlearn::kinematics::ReachabilityMap empty;
+    double far[3] = {1e6, 0, 0};
+
+    ASSERT_TRUE(empty.reachable(far));
+    ASSERT_FALSE(empty.hasBitmap());
+    ASSERT_TRUE(map.hasBitmap());
+    ASSERT_GT(map.getMargin(), 0);
+}
+
+// Tests that no configuration within the sampled bounds is rejected
+TEST_F(ReachabilityMapTest, conservative) {
+    std::mt19937 generator(0);
+    std::uniform_int_distribution<int> distribution(1024, 3072);
+
+    for(int i = 0; i < 2000; i++) {
+        std::vector<uint16_t> positions = {(uint16_t) distribution(generator), (uint16_t) distribution(generator), (uint16_t) distribution(generator)};
+        auto coord = converter.computeServoToCoord(positions)->getCoord();
+
+        ASSERT_TRUE(map.reachable(coord.data()));
+    }
+}
+
+// Tests that coordinates out of the shell or of the bitmap are rejected
+TEST_F(ReachabilityMapTest, rejection) {
+    double far[3] = {0, 0, 1000};
+    double center[3] = {0, 0, 125};
+    double below[3] = {0, 0, -1000};
+    ASSERT_FALSE(map.reachable(far));
+    ASSERT_FALSE(map.reachable(center));
+    ASSERT_FALSE(map.reachable(below));
+
+    // Point within the shell but in a cell left empty by the limited range of the shoulder
+    armlearn::kinematics::ReachabilityMap shell;
+    shell.build(converter, {1024, 1024, 1024}, {3072, 3072, 3072}, {17, 17, 17}, {0, 0, 125});
+
+    double behind[3] = {0, 0, 125 - shell.getMaxRadius() + 5};
+    ASSERT_TRUE(shell.reachable(behind));
+    ASSERT_FALSE(map.reachable(behind));
+}
+
+// Tests that the inverse kinematics of the converters stops with a distinct status on rejected coordinates
+TEST_F(ReachabilityMapTest, converterRejection) {
+    armlearn::kinematics::AnalyticCartesianConverter analytic;
+    armlearn::kinematics::OptimCartesianConverter optim;
+    analytic.addServo("base", armlearn::kinematics::rotZ, 0, 0, 125, 0, 0, M_PI);
+    analytic.addServo("shoulder", armlearn::kinematics::rotX, 0, -49, 142, M_PI/2, 0, M_PI);
+    analytic.addServo("elbow", armlearn::kinematics::fixed, 0, 0, 71);
+    analytic.addServo("elbow", armlearn::kinematics::rotX, 0, 0, 71);
+    optim.addServo("base", armlearn::kinematics::rotZ, 0, 0, 125, 0, 0, M_PI);
+    optim.addServo("shoulder", armlearn::kinematics::rotX, 0, -49, 142, M_PI/2, 0, M_PI);
+    optim.addServo("elbow", armlearn::kinematics::fixed, 0, 0, 71);
+    optim.addServo("elbow", armlearn::kinematics::rotX, 0, 0, 71);
+
+    std::vector<armlearn::kinematics::CartesianConverter*> converters = {&converter, &analytic, &optim};
+    for(auto conv : converters) {
+        conv->setReachabilityMap(&map);
+
+        std::vector<uint16_t> positions = {2048, 2048, 2048};
+        ASSERT_EQ(conv->tryCoordToServo({0, 0, 1000}, positions), armlearn::kinematics::unreachableTarget);
+        ASSERT_THROW(conv->computeCoordToServo({0, 0, 1000}), armlearn::ComputationError);
+
+        // Reachable coordinates are still solved
+        auto coord = converter.computeServoToCoord({2048, 2048, 2048})->getCoord();
+        ASSERT_NE(conv->tryCoordToServo(coord, positions), armlearn::kinematics::unreachableTarget);
+
+        conv->setReachabilityMap(nullptr);
+        ASSERT_NE(conv->tryCoordToServo({0, 0, 1000}, positions), armlearn::kinematics::unreachableTarget);
+    }
+}
+
+// Tests exception throw when the parameters do not match the converter
+TEST_F(ReachabilityMapTest, invalidParameters) {
+    armlearn::kinematics::ReachabilityMap other;
+
+    ASSERT_THROW(other.build(converter, {1024, 1024}, {3072, 3072}, {17, 17}), armlearn::ComputationError);
+    ASSERT_THROW(other.build(converter, {1024, 1024, 1024}, {3072, 3072, 3072}, {17, 0, 17}), armlearn::ComputationError);
+    ASSERT_THROW(other.build(converter, {1024, 1024, 1024}, {3072, 3072, 3072}, {17, 17, 17}, {0, 0}), armlearn::ComputationError);
+    ASSERT_THROW(other.build(converter, {1024, 1024, 1024}, {3072, 3072, 3072}, {17, 17, 17}, {0, 0, 0}, -1), armlearn::ComputationError);
+}
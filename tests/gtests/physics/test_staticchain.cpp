@@ -0,0 +1,181 @@
+/**
+ * @file test_staticchain.cpp
+ * @author Gaël Gendron (gael.gendron@insa-rennes.fr)
+ * @brief Testing file of the StaticChain and StaticCartesianConverter templates
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "staticchain.h"
+#include "widowxbuilder.h"
+#include "nowaitarmsimulator.h"
+
+
+STATIC_SEGMENT(SlideX, "slideX", armlearn::kinematics::transX, 10, 0, 0, 0, 0, 0);
+STATIC_SEGMENT(Offset, "offset", armlearn::kinematics::fixed, 0, 20, 5, 0, M_PI/2, 0);
+STATIC_SEGMENT(TurnY, "turnY", armlearn::kinematics::rotY, 0, 0, 30, M_PI/4, 0, 0);
+
+
+class StaticChainTest : public ::testing::Test {
+    protected:
+
+    StaticChainTest() {
+        armlearn::WidowXBuilder builder;
+        builder.buildConverter(generic);
+
+        for(int i = 0; i < 50; i++) {
+            configs.push_back({(uint16_t) (81 * i), (uint16_t) (1100 + 37 * i), (uint16_t) (2950 - 35 * i), (uint16_t) (1100 + 19 * i), (uint16_t) (20 * i), (uint16_t) (10 * i)});
+        }
+    }
+
+    ~StaticChainTest() override {
+    }
+
+    void SetUp() override {
+    }
+
+    void TearDown() override {
+    }
+
+    armlearn::kinematics::BasicCartesianConverter generic;
+    armlearn::kinematics::WidowXConverter widowX;
+    std::vector<std::vector<uint16_t>> configs;
+};
+
+
+// Tests that the static converter describes the same device as the builder
+TEST_F(StaticChainTest, structure) {
+    ASSERT_EQ(armlearn::kinematics::WidowXChain::nbSegments, 6);
+    ASSERT_EQ(armlearn::kinematics::WidowXChain::nbJoints, 6);
+    ASSERT_EQ(widowX.getNbServos(), generic.getNbServos());
+
+    typedef armlearn::kinematics::StaticChain<SlideX, Offset, TurnY> MixedChain;
+    ASSERT_EQ(MixedChain::nbSegments, 3);
+    ASSERT_EQ(MixedChain::nbJoints, 2);
+}
+
+// Tests that the forward kinematics gives the same results as the generic converter
+TEST_F(StaticChainTest, forwardKinematics) {
+    for(auto& config : configs) {
+        auto rep = generic.computeServoToCoord(config)->getCoord();
+        auto pos = widowX.computeServoToCoord(config)->getCoord();
+
+        ASSERT_EQ(pos.size(), 3);
+        for(int k = 0; k < 3; k++) ASSERT_NEAR(rep[k], pos[k], 1e-9);
+    }
+}
+
+// Tests that the unrolled chain matches the generic chain with every kind of joint and fixed rotations
+TEST_F(StaticChainTest, mixedChain) {
+    armlearn::kinematics::KinematicChain chain;
+    chain.addSegment("slideX", armlearn::kinematics::transX, 10, 0, 0);
+    chain.addSegment("offset", armlearn::kinematics::fixed, 0, 20, 5, 0, M_PI/2, 0);
+    chain.addSegment("turnY", armlearn::kinematics::rotY, 0, 0, 30, M_PI/4, 0, 0);
+
+    typedef armlearn::kinematics::StaticChain<SlideX, Offset, TurnY> MixedChain;
+
+    double values[2] = {12.5, 0.7};
+    armlearn::kinematics::Frame rep, pos;
+    chain.computeTip(values, rep);
+    MixedChain::computeTip(values, pos);
+
+    for(int k = 0; k < 9; k++) ASSERT_NEAR(rep.rot[k], pos.rot[k], 1e-12);
+    for(int k = 0; k < 3; k++) ASSERT_NEAR(rep.pos[k], pos.pos[k], 1e-12);
+
+    double repJacobian[12], jacobian[12];
+    chain.computeJacobian(values, repJacobian);
+    MixedChain::computeJacobian(values, jacobian);
+
+    for(int k = 0; k < 12; k++) ASSERT_NEAR(repJacobian[k], jacobian[k], 1e-12);
+}
+
+// Tests that the jacobian gives the same results as the generic converter
+TEST_F(StaticChainTest, jacobian) {
+    std::vector<double> rep, jac;
+    for(auto& config : configs) {
+        ASSERT_EQ(generic.tryJacobian(config, rep), armlearn::kinematics::computationSucceeded);
+        ASSERT_EQ(widowX.tryJacobian(config, jac), armlearn::kinematics::computationSucceeded);
+
+        ASSERT_EQ(jac.size(), rep.size());
+        for(int k = 0; k < rep.size(); k++) ASSERT_NEAR(rep[k], jac[k], 1e-9);
+    }
+}
+
+// Tests that the gradient gives the positional rows of the jacobian of the generic converter, including a chain with a translation
+TEST_F(StaticChainTest, gradient) {
+    std::vector<uint16_t> positions;
+    for(auto& config : configs) positions.insert(positions.end(), config.cbegin(), config.cend());
+
+    std::vector<double> repCoord(configs.size() * 3), coord(configs.size() * 3);
+    std::vector<double> repGrad(configs.size() * 18), grad(configs.size() * 18);
+    generic.computeServoToCoordGradientBatch(positions.data(), configs.size(), repCoord.data(), repGrad.data());
+    widowX.computeServoToCoordGradientBatch(positions.data(), configs.size(), coord.data(), grad.data());
+
+    for(int k = 0; k < repCoord.size(); k++) ASSERT_NEAR(repCoord[k], coord[k], 1e-9);
+    for(int k = 0; k < repGrad.size(); k++) ASSERT_NEAR(repGrad[k], grad[k], 1e-9);
+
+    armlearn::kinematics::KinematicChain chain;
+    chain.addSegment("slideX", armlearn::kinematics::transX, 10, 0, 0);
+    chain.addSegment("offset", armlearn::kinematics::fixed, 0, 20, 5, 0, M_PI/2, 0);
+    chain.addSegment("turnY", armlearn::kinematics::rotY, 0, 0, 30, M_PI/4, 0, 0);
+
+    double values[2] = {12.5, 0.7};
+    double jacobian[12], repPosition[3], position[3], repGradient[6], gradient[6];
+    chain.computeJacobian(values, jacobian);
+    chain.computePositionGradient(values, repPosition, repGradient);
+    armlearn::kinematics::StaticChain<SlideX, Offset, TurnY>::computePositionGradient(values, position, gradient);
+
+    for(int k = 0; k < 6; k++) {
+        ASSERT_NEAR(jacobian[k], repGradient[k], 1e-12);
+        ASSERT_NEAR(repGradient[k], gradient[k], 1e-12);
+    }
+    for(int k = 0; k < 3; k++) ASSERT_NEAR(repPosition[k], position[k], 1e-12);
+}
+
+// Tests the batch forward kinematics, with and without orientation
+TEST_F(StaticChainTest, forwardKinematicsBatch) {
+    std::vector<uint16_t> positions;
+    for(auto& config : configs) positions.insert(positions.end(), config.cbegin(), config.cend());
+
+    std::vector<double> rep(configs.size() * 7), pos(configs.size() * 7);
+    generic.computeServoToCoordBatch(positions.data(), configs.size(), rep.data());
+    widowX.computeServoToCoordBatch(positions.data(), configs.size(), pos.data());
+    for(int k = 0; k < configs.size() * 3; k++) ASSERT_NEAR(rep[k], pos[k], 1e-9);
+
+    generic.computeServoToCoordBatch(positions.data(), configs.size(), rep.data(), true);
+    widowX.computeServoToCoordBatch(positions.data(), configs.size(), pos.data(), true);
+    for(int k = 0; k < configs.size() * 7; k++) ASSERT_NEAR(rep[k], pos[k], 1e-9);
+}
+
+// Tests that the static converter can be used as any converter, inverse kinematics included
+TEST_F(StaticChainTest, asConverter) {
+    armlearn::communication::NoWaitArmSimulator sim(armlearn::communication::none);
+    armlearn::WidowXBuilder builder;
+    builder.buildController(sim);
+    widowX.setServoLimits(sim);
+    widowX.setSolver(armlearn::kinematics::levenbergMarquardtSolver, 200, 1e-3);
+
+    armlearn::kinematics::Converter* converter = &widowX;
+    std::vector<uint16_t> config = {1500, 2300, 1700, 2200, 512, 256};
+    auto target = converter->computeServoToCoord(config)->getCoord();
+
+    converter->computeServoToCoord({2048, 2048, 2048, 2048, 512, 256});
+    auto positions = converter->computeCoordToServo(target)->getServo();
+    ASSERT_TRUE(sim.validPosition(positions));
+
+    auto res = generic.computeServoToCoord(positions)->getCoord();
+    for(int k = 0; k < 3; k++) ASSERT_NEAR(res[k], target[k], 1);
+}
+
+// Tests exceptions when the device is modified or the input does not match it
+TEST_F(StaticChainTest, fixedDeviceExcept) {
+    ASSERT_THROW(widowX.addServo("extra", armlearn::kinematics::rotX, 0, 0, 10), armlearn::ConverterError);
+    ASSERT_THROW(widowX.removeAllServos(), armlearn::ConverterError);
+    ASSERT_THROW(widowX.computeServoToCoord({2048, 2048, 2048}), armlearn::ComputationError);
+    ASSERT_EQ(widowX.getNbServos(), 6);
+}
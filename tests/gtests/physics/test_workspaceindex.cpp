@@ -0,0 +1,152 @@
+/**
+ * @file test_workspaceindex.cpp
+ * @author Gaël Gendron (gael.gendron@insa-rennes.fr)
+ * @brief Testing file of the WorkspaceIndex class
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+
+#include "workspaceindex.h"
+#include "basiccartesianconverter.h"
+#include "fileerror.h"
+
+
+#define INDEX_FILE "test_workspace.armwsi"
+
+
+class WorkspaceIndexTest : public ::testing::Test {
+    protected:
+
+    WorkspaceIndexTest() {
+        converter.addServo("base", armlearn::kinematics::rotZ, 0, 0, 125, 0, 0, M_PI);
+        converter.addServo("shoulder", armlearn::kinematics::rotX, 0, -49, 142, M_PI/2, 0, M_PI);
+        converter.addServo("elbow", armlearn::kinematics::fixed, 0, 0, 71);
+        converter.addServo("elbow", armlearn::kinematics::rotX, 0, 0, 71);
+
+        index.build(converter, {1024, 1024, 1024}, {3072, 3072, 3072}, {17, 17, 17}, 20);
+    }
+
+    ~WorkspaceIndexTest() override {
+        std::remove(INDEX_FILE);
+    }
+
+    void SetUp() override {
+    }
+
+    void TearDown() override {
+    }
+
+    /**
+     * @brief Computes the distance to the closest sample by going through all of them
+     *
+     */
+    double bruteForce(const std::vector<double>& target) {
+        double best = INFINITY;
+        for(int i = 0; i < 17; i++){
+            for(int j = 0; j < 17; j++){
+                for(int k = 0; k < 17; k++){
+                    auto pos = converter.computeServoToCoord({(uint16_t) (1024 + 128 * i), (uint16_t) (1024 + 128 * j), (uint16_t) (1024 + 128 * k)})->getCoord();
+                    best = std::min(best, std::sqrt(std::pow(pos[0] - target[0], 2) + std::pow(pos[1] - target[1], 2) + std::pow(pos[2] - target[2], 2)));
+                }
+            }
+        }
+
+        return best;
+    }
+
+    armlearn::kinematics::BasicCartesianConverter converter;
+    armlearn::kinematics::WorkspaceIndex index;
+};
+
+
+// Tests that every sampled configuration is indexed
+TEST_F(WorkspaceIndexTest, build) {
+    ASSERT_FALSE(index.empty());
+    ASSERT_EQ(index.getNbServos(), 3);
+    ASSERT_EQ(index.getNbEntries(), 17 * 17 * 17);
+}
+
+// Tests that a sampled configuration is found back from its coordinates
+TEST_F(WorkspaceIndexTest, nearestSample) {
+    auto target = converter.computeServoToCoord({1408, 2560, 1920})->getCoord();
+    auto pos = converter.computeServoToCoord(index.nearest(target))->getCoord();
+
+    for(int k = 0; k < 3; k++) ASSERT_NEAR(target[k], pos[k], 1e-3);
+}
+
+// Tests that the closest sample is found, inside and outside of the sampled workspace
+TEST_F(WorkspaceIndexTest, nearestDistance) {
+    std::vector<std::vector<double>> targets = {{0, 191, 267}, {-80, 20, 150}, {100, -100, 400}, {1000, 1000, -1000}};
+    std::vector<uint16_t> positions(3);
+
+    for(auto& target : targets){
+        double distance = index.nearest(target.data(), positions.data());
+        auto pos = converter.computeServoToCoord(positions)->getCoord();
+
+        ASSERT_NEAR(distance, std::sqrt(std::pow(pos[0] - target[0], 2) + std::pow(pos[1] - target[1], 2) + std::pow(pos[2] - target[2], 2)), 1e-3);
+        ASSERT_NEAR(distance, bruteForce(target), 1e-3);
+    }
+}
+
+// Tests that a saved index gives the same results once loaded
+TEST_F(WorkspaceIndexTest, saveLoad) {
+    index.save(INDEX_FILE);
+    armlearn::kinematics::WorkspaceIndex loaded(INDEX_FILE);
+
+    ASSERT_EQ(loaded.getNbServos(), index.getNbServos());
+    ASSERT_EQ(loaded.getNbEntries(), index.getNbEntries());
+
+    std::vector<std::vector<double>> targets = {{0, 191, 267}, {-80, 20, 150}, {100, -100, 400}};
+    for(auto& target : targets) ASSERT_EQ(loaded.nearest(target), index.nearest(target));
+}
+
+// Tests that the inverse kinematics starts from the closest sample when an index is set
+TEST_F(WorkspaceIndexTest, converterSeed) {
+    armlearn::kinematics::BasicCartesianConverter planar; // Tip orientation only depends on the sum of the angles, the target below is reached with its orientation
+    planar.addServo("base", armlearn::kinematics::rotZ, 100, 0, 0);
+    planar.addServo("elbow", armlearn::kinematics::rotZ, 100, 0, 0);
+
+    armlearn::kinematics::WorkspaceIndex planarIndex;
+    planarIndex.build(planar, {0, 0}, {4095, 4095}, {65, 65}, 5);
+
+    auto target = planar.computeServoToCoord({2348, 1748})->getCoord();
+    planar.computeServoToCoord({0, 0});
+
+    auto pos = dynamic_cast<armlearn::kinematics::BasicCartesianConverter*>(planar.setWorkspaceIndex(&planarIndex))->computeCoordToServo(target)->getServo();
+    auto rep = {2348, 1748};
+
+    auto verifPtr = pos.cbegin();
+    for(auto& v : rep) {
+        ASSERT_NEAR(v, *verifPtr, 1);
+        verifPtr++;
+    }
+}
+
+// Tests exception when the index is empty
+TEST_F(WorkspaceIndexTest, emptyExcept) {
+    armlearn::kinematics::WorkspaceIndex empty;
+    ASSERT_THROW(empty.nearest({0, 0, 0}), armlearn::ComputationError);
+}
+
+// Tests exception when the sampling does not match the converter
+TEST_F(WorkspaceIndexTest, buildExcept) {
+    ASSERT_THROW(index.build(converter, {1024, 1024}, {3072, 3072}, {17, 17}), armlearn::ComputationError);
+}
+
+// Tests exception when the file is missing or is not an index
+TEST_F(WorkspaceIndexTest, loadExcept) {
+    ASSERT_THROW(index.load("missing.armwsi"), armlearn::FileError);
+
+    std::ofstream file(INDEX_FILE);
+    file << "not an index";
+    file.close();
+    ASSERT_THROW(index.load(INDEX_FILE), armlearn::FileError);
+    ASSERT_TRUE(index.empty());
+}
@@ -0,0 +1,110 @@
+/**
+ * @file test_workspacesampler.cpp
+ * @author Gaël Gendron (gael.gendron@insa-rennes.fr)
+ * @brief Testing file of the WorkspaceSampler class
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+
+#include "workspacesampler.h"
+#include "basiccartesianconverter.h"
+#include "fileerror.h"
+
+
+#define SAMPLES_FILE "test_workspace.armwss"
+
+
+class WorkspaceSamplerTest : public ::testing::Test {
+    protected:
+
+    WorkspaceSamplerTest() {
+        converter.addServo("base", armlearn::kinematics::rotZ, 0, 0, 125, 0, 0, M_PI);
+        converter.addServo("shoulder", armlearn::kinematics::rotX, 0, -49, 142, M_PI/2, 0, M_PI);
+        converter.addServo("elbow", armlearn::kinematics::fixed, 0, 0, 71);
+        converter.addServo("elbow", armlearn::kinematics::rotX, 0, 0, 71);
+        converter.setServoLimits({1024, 1024, 1024}, {3072, 3072, 3072});
+        converter.setSolver(armlearn::kinematics::levenbergMarquardtSolver);
+    }
+
+    ~WorkspaceSamplerTest() override {
+        std::remove(SAMPLES_FILE);
+    }
+
+    void SetUp() override {
+    }
+
+    void TearDown() override {
+    }
+
+    armlearn::kinematics::BasicCartesianConverter converter;
+};
+
+
+TEST_F(WorkspaceSamplerTest, sampleGrid){
+    armlearn::kinematics::WorkspaceSampler sampler(converter);
+    auto summary = sampler.sample({1024, 1024, 1024}, {3072, 3072, 3072}, {256, 512, 300}, SAMPLES_FILE);
+
+    // 9 x 5 x 7 samples, the last position of the third servomotor is not on the grid
+    ASSERT_EQ(summary.nbSamples, 315);
+    ASSERT_EQ(summary.nbForward, 315);
+    ASSERT_LE(summary.nbValid, summary.nbInverse);
+    ASSERT_GT(summary.nbInverse, 0);
+    ASSERT_LE(summary.meanError, summary.maxError);
+
+    auto samples = armlearn::kinematics::WorkspaceSampler::load(SAMPLES_FILE);
+    ASSERT_EQ(samples.size(), 315);
+
+    // Order of the grid, the last servomotor changing first
+    ASSERT_EQ(samples[0].positions, std::vector<uint16_t>({1024, 1024, 1024}));
+    ASSERT_EQ(samples[1].positions, std::vector<uint16_t>({1024, 1024, 1324}));
+    ASSERT_EQ(samples[7].positions, std::vector<uint16_t>({1024, 1536, 1024}));
+    ASSERT_EQ(samples[314].positions, std::vector<uint16_t>({3072, 3072, 2824}));
+
+    uint64_t nbInverse = 0, nbValid = 0;
+    for(auto&& sample : samples){
+        ASSERT_TRUE(sample.flags & armlearn::kinematics::forwardSucceeded);
+
+        auto expected = converter.computeServoToCoord(sample.positions)->getCoord();
+        for(int i = 0; i < 3; i++) ASSERT_NEAR(sample.coordinates[i], expected[i], 1e-3);
+
+        if(sample.flags & armlearn::kinematics::inverseSucceeded){
+            nbInverse++;
+            ASSERT_GE(sample.error, 0);
+
+            auto reached = converter.computeServoToCoord(sample.inversePositions)->getCoord();
+            double error = std::sqrt(std::pow(reached[0] - expected[0], 2) + std::pow(reached[1] - expected[1], 2) + std::pow(reached[2] - expected[2], 2));
+            ASSERT_NEAR(sample.error, error, 1e-3);
+
+            if(sample.flags & armlearn::kinematics::inverseValid){
+                nbValid++;
+                ASSERT_TRUE(converter.validPosition(sample.inversePositions.data()));
+            }
+        }else{
+            ASSERT_FALSE(sample.flags & armlearn::kinematics::inverseValid);
+            ASSERT_EQ(sample.error, -1);
+        }
+    }
+    ASSERT_EQ(nbInverse, summary.nbInverse);
+    ASSERT_EQ(nbValid, summary.nbValid);
+}
+
+TEST_F(WorkspaceSamplerTest, invalidParameters){
+    armlearn::kinematics::WorkspaceSampler sampler(converter);
+
+    ASSERT_THROW(sampler.setSeed({2048, 2048}), armlearn::ComputationError);
+    ASSERT_THROW(sampler.sample({1024, 1024}, {3072, 3072}, {256, 256}, SAMPLES_FILE), armlearn::ComputationError);
+    ASSERT_THROW(sampler.sample({1024, 1024, 1024}, {3072, 3072, 3072}, {256, 0, 256}, SAMPLES_FILE), armlearn::ComputationError);
+    ASSERT_THROW(sampler.sample({1024, 1024, 1024}, {3072, 3072, 3072}, {256, 256, 256}, "missing/directory/samples.armwss"), armlearn::FileError);
+
+    std::ofstream file(SAMPLES_FILE, std::ios::out | std::ios::binary);
+    file << "not a sample file";
+    file.close();
+    ASSERT_THROW(armlearn::kinematics::WorkspaceSampler::load(SAMPLES_FILE), armlearn::FileError);
+}
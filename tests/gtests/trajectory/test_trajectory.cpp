@@ -10,11 +10,17 @@
  */
 
 #include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <algorithm>
 
 #include "trajectory.h"
 #include "nowaitarmsimulator.h"
 
 
+#define TRAJECTORY_FILE "test_trajectory.armtrj"
+
+
 class TrajectoryTest : public ::testing::Test {
     protected:
 
@@ -27,6 +33,7 @@ class TrajectoryTest : public ::testing::Test {
     }
 
     ~TrajectoryTest() override {
+        std::remove(TRAJECTORY_FILE);
     }
 
     void SetUp() override {
@@ -190,6 +197,334 @@ TEST_F(TrajectoryTest, exceptEmptyRemove) {
     ASSERT_THROW(pathEmpty->removePoint(),std::out_of_range);
 }
 
+// Tests that a point making the device collide is not sent when a collision checker is set
+TEST_F(TrajectoryTest, exceptCollision) {
+    armlearn::kinematics::CollisionChecker checker;
+    checker.addServo("base", armlearn::kinematics::rotZ, 0, 0, 125, 0, 0, M_PI);
+    checker.addServo("shoulder", armlearn::kinematics::rotX, 0, -49, 142, M_PI/2, 0, M_PI);
+    checker.addServo("elbow", armlearn::kinematics::rotX, 0, 0, 142);
+
+    pathFilled->setCollisionChecker(&checker);
+    ASSERT_FALSE(pathFilled->pointCollides(0));
+
+    pathFilled->addPoint({2048, 3000, 2048}); // Forearm going through the table
+    ASSERT_TRUE(pathFilled->pointCollides(5));
+
+    pathFilled->init();
+    ASSERT_THROW(pathFilled->executeTrajectory(), armlearn::TrajectoryError);
+}
+
+// Tests that a timed trajectory goes through its points, at the times given by the limits of the servomotors
+TEST_F(TrajectoryTest, timedPath) {
+    ASSERT_FALSE(pathFilled->isTimed());
+    ASSERT_THROW(pathFilled->getDuration(), armlearn::TrajectoryError);
+
+    pathFilled->setTimeLimits({1000, 1000, 1000}, {2000, 2000, 2000});
+    ASSERT_TRUE(pathFilled->isTimed());
+
+    // Base moving the most, reaching its speed after 0.25 s
+    ASSERT_NEAR(pathFilled->getSegmentDuration(0), 1028.0 / 1000 + 1000.0 / 2000, 1e-9);
+
+    std::vector<double> setpoint;
+    double time = 0;
+    std::vector<std::vector<uint16_t>> points = {initPoint, middlePoint, {2046, 1027, 2027}, {1041, 2001, 3009}, lastPoint};
+    for(int p = 0; p < points.size(); p++){
+        pathFilled->sample(time, setpoint);
+        for(int i = 0; i < 3; i++) ASSERT_NEAR(setpoint[i], points[p][i], 1e-6);
+
+        if(p < points.size() - 1) time += pathFilled->getSegmentDuration(p);
+    }
+    ASSERT_NEAR(time, pathFilled->getDuration(), 1e-9);
+
+    // Symmetric profile, halfway through the first segment at half its duration
+    pathFilled->sample(pathFilled->getSegmentDuration(0) / 2, setpoint);
+    for(int i = 0; i < 3; i++) ASSERT_NEAR(setpoint[i], (initPoint[i] + middlePoint[i]) / 2.0, 1e-6);
+
+    std::vector<double> reversed;
+    pathFilled->sample(1.2, setpoint);
+    pathFilled->sample(pathFilled->getDuration() - 1.2, reversed, true);
+    for(int i = 0; i < 3; i++) ASSERT_NEAR(setpoint[i], reversed[i], 1e-6);
+
+    // Timing kept up to date with the points
+    pathFilled->removePoint(2);
+    pathFilled->addPoint({1500, 1500, 1500}, 1);
+    armlearn::Trajectory other(sim);
+    other.setTimeLimits({1000, 1000, 1000}, {2000, 2000, 2000});
+    for(auto&& point : std::vector<std::vector<uint16_t>>({initPoint, {1500, 1500, 1500}, middlePoint, {1041, 2001, 3009}, lastPoint})) other.addPoint(point);
+    ASSERT_NEAR(pathFilled->getDuration(), other.getDuration(), 1e-9);
+}
+
+// Tests that the sampled setpoints respect the speed and acceleration limits with both profiles
+TEST_F(TrajectoryTest, timedProfiles) {
+    std::vector<double> speeds = {800, 400, 1000}, accelerations = {1500, 3000, 500};
+    double trapezoidalDuration = 0;
+
+    for(auto profile : {armlearn::trapezoidalProfile, armlearn::sCurveProfile}){
+        pathFilled->setTimeLimits(speeds, accelerations, profile);
+
+        double step = 1e-3;
+        std::vector<double> previous, current, next;
+        for(double time = step; time < pathFilled->getDuration() - step; time += step){
+            pathFilled->sample(time - step, previous);
+            pathFilled->sample(time, current);
+            pathFilled->sample(time + step, next);
+
+            for(int i = 0; i < 3; i++){
+                ASSERT_LE(std::abs(next[i] - previous[i]) / (2 * step), speeds[i] * (1 + 1e-6));
+                ASSERT_LE(std::abs(next[i] - 2 * current[i] + previous[i]) / (step * step), accelerations[i] * (1 + 1e-2));
+            }
+        }
+
+        if(profile == armlearn::trapezoidalProfile) trapezoidalDuration = pathFilled->getDuration();
+    }
+
+    // Same peak acceleration reached progressively, the S-curve profile takes longer
+    ASSERT_GT(pathFilled->getDuration(), trapezoidalDuration);
+
+    std::vector<double> start, end;
+    pathFilled->sample(1e-3, start);
+    pathFilled->sample(0, end);
+    for(int i = 0; i < 3; i++) ASSERT_NEAR(start[i], end[i], 1e-2); // No acceleration step at the start
+}
+
+// Tests that invalid limits or points throw exceptions, the trajectory keeping its timing
+TEST_F(TrajectoryTest, exceptTimed) {
+    std::vector<double> setpoint;
+    ASSERT_THROW(pathFilled->sample(0, setpoint), armlearn::TrajectoryError);
+    ASSERT_THROW(pathFilled->setTimeLimits({1000, 1000}, {2000, 2000, 2000}), armlearn::TrajectoryError);
+    ASSERT_THROW(pathFilled->setTimeLimits({1000, 0, 1000}, {2000, 2000, 2000}), armlearn::TrajectoryError);
+    ASSERT_THROW(pathFilled->setTimeLimits({1000, 1000}, {2000, 2000}), armlearn::TrajectoryError);
+    ASSERT_FALSE(pathFilled->isTimed());
+
+    pathFilled->setTimeLimits({1000, 1000, 1000}, {2000, 2000, 2000});
+    double duration = pathFilled->getDuration();
+    ASSERT_THROW(pathFilled->setTimeLimits({1000, 1000}, {2000, 2000}), armlearn::TrajectoryError);
+    ASSERT_THROW(pathFilled->addPoint({2048, 2048}), armlearn::TrajectoryError);
+    ASSERT_NEAR(pathFilled->getDuration(), duration, 1e-9);
+    ASSERT_THROW(pathFilled->getSegmentDuration(4), std::out_of_range);
+
+    pathEmpty->setTimeLimits({1000, 1000, 1000}, {2000, 2000, 2000});
+    ASSERT_EQ(pathEmpty->getDuration(), 0);
+    ASSERT_THROW(pathEmpty->sample(0, setpoint), armlearn::TrajectoryError);
+}
+
+// Tests that a recorded trajectory goes through its points at their time, at constant speed in between
+TEST_F(TrajectoryTest, recordedPath) {
+    pathEmpty->addTimedPoint(initPoint, 10);
+    pathEmpty->addTimedPoint(middlePoint, 10.5);
+    pathEmpty->addTimedPoint(middlePoint, 10.5); // Repeated sample
+    pathEmpty->addTimedPoint(lastPoint, 12.5);
+    ASSERT_TRUE(pathEmpty->isTimed());
+    ASSERT_EQ(pathEmpty->getNbPoints(), 4);
+    ASSERT_NEAR(pathEmpty->getDuration(), 2.5, 1e-9);
+    ASSERT_NEAR(pathEmpty->getSegmentDuration(2), 2, 1e-9);
+
+    std::vector<double> setpoint;
+    pathEmpty->sample(0.25, setpoint);
+    for(int i = 0; i < 3; i++) ASSERT_NEAR(setpoint[i], (initPoint[i] + middlePoint[i]) / 2.0, 1e-6);
+    pathEmpty->sample(0.5, setpoint);
+    for(int i = 0; i < 3; i++) ASSERT_NEAR(setpoint[i], middlePoint[i], 1e-6);
+    pathEmpty->sample(0.5, setpoint, true);
+    for(int i = 0; i < 3; i++) ASSERT_NEAR(setpoint[i], middlePoint[i] + 0.75 * ((double) lastPoint[i] - middlePoint[i]), 1e-6);
+
+    ASSERT_THROW(pathEmpty->addTimedPoint(lastPoint, 12), armlearn::TrajectoryError);
+    ASSERT_THROW(pathEmpty->addTimedPoint({2048, 2048}, 13), armlearn::TrajectoryError);
+    ASSERT_THROW(pathEmpty->addPoint(lastPoint), armlearn::TrajectoryError);
+    ASSERT_THROW(pathFilled->addTimedPoint(lastPoint, 0), armlearn::TrajectoryError);
+    ASSERT_THROW(pathFilled->addPoint({2048, 2048}), armlearn::TrajectoryError);
+
+    // Recorded times replaced by the limits of the servomotors
+    pathEmpty->setTimeLimits({1000, 1000, 1000}, {2000, 2000, 2000});
+    ASSERT_EQ(pathEmpty->getSegmentDuration(1), 0);
+    ASSERT_THROW(pathEmpty->addTimedPoint(lastPoint, 20), armlearn::TrajectoryError);
+}
+
+// Tests that a saved trajectory has the same points and timing once loaded, and can still be modified
+TEST_F(TrajectoryTest, saveLoad) {
+    for(int p = 0; p < 1000; p++) pathEmpty->addTimedPoint({(uint16_t) (1000 + p), (uint16_t) (3000 - p), 2048}, 0.01 * p);
+    pathEmpty->save(TRAJECTORY_FILE);
+
+    armlearn::Trajectory recorded(sim, TRAJECTORY_FILE);
+    ASSERT_EQ(recorded.getNbPoints(), 1000);
+    ASSERT_EQ(recorded.getNbServos(), 3);
+    ASSERT_NEAR(recorded.getDuration(), pathEmpty->getDuration(), 1e-9);
+    for(int p = 0; p < 1000; p += 111) ASSERT_EQ(std::vector<uint16_t>(recorded.getPoint(p), recorded.getPoint(p) + 3), std::vector<uint16_t>({(uint16_t) (1000 + p), (uint16_t) (3000 - p), 2048}));
+
+    std::vector<double> expected, setpoint;
+    pathEmpty->sample(3.456, expected);
+    recorded.sample(3.456, setpoint);
+    ASSERT_EQ(setpoint, expected);
+
+    recorded.removePoint(0);
+    recorded.addTimedPoint(lastPoint, 10.5);
+    ASSERT_NEAR(recorded.getDuration(), 10.49, 1e-9);
+
+    // Trajectory timed by limits
+    pathFilled->setTimeLimits({800, 400, 1000}, {1500, 3000, 500}, armlearn::sCurveProfile);
+    pathFilled->save(TRAJECTORY_FILE);
+    pathEmpty->load(TRAJECTORY_FILE);
+    ASSERT_EQ(pathEmpty->getNbPoints(), 5);
+    ASSERT_NEAR(pathEmpty->getDuration(), pathFilled->getDuration(), 1e-9);
+
+    pathEmpty->addPoint({2048, 2048, 2048});
+    pathFilled->addPoint({2048, 2048, 2048});
+    ASSERT_NEAR(pathEmpty->getDuration(), pathFilled->getDuration(), 1e-9);
+    pathEmpty->init();
+    pathEmpty->executeTrajectory();
+    ASSERT_EQ(sim->getPosition(), std::vector<uint16_t>({2048, 2048, 2048}));
+}
+
+// Tests that a loaded trajectory can be saved to the file it is mapped from
+TEST_F(TrajectoryTest, saveMapped) {
+    for(int p = 0; p < 100; p++) pathEmpty->addTimedPoint({(uint16_t) (1000 + p), (uint16_t) (3000 - p), 2048}, 0.01 * p);
+    pathEmpty->save(TRAJECTORY_FILE);
+
+    armlearn::Trajectory recorded(sim, TRAJECTORY_FILE);
+    recorded.save(TRAJECTORY_FILE);
+    ASSERT_EQ(std::vector<uint16_t>(recorded.getPoint(99), recorded.getPoint(99) + 3), std::vector<uint16_t>({1099, 2901, 2048}));
+
+    armlearn::Trajectory saved(sim, TRAJECTORY_FILE);
+    ASSERT_EQ(saved.getNbPoints(), 100);
+    ASSERT_NEAR(saved.getDuration(), pathEmpty->getDuration(), 1e-9);
+    for(int p = 0; p < 100; p += 11) ASSERT_EQ(std::vector<uint16_t>(saved.getPoint(p), saved.getPoint(p) + 3), std::vector<uint16_t>({(uint16_t) (1000 + p), (uint16_t) (3000 - p), 2048}));
+}
 
+// Tests exception when the file is missing or is not a trajectory
+TEST_F(TrajectoryTest, loadExcept) {
+    ASSERT_THROW(pathFilled->load("missing.armtrj"), armlearn::FileError);
+    ASSERT_EQ(pathFilled->getNbPoints(), 0);
+
+    std::ofstream file(TRAJECTORY_FILE);
+    file << "not a trajectory";
+    file.close();
+    ASSERT_THROW(pathErr->load(TRAJECTORY_FILE), armlearn::FileError);
+    ASSERT_EQ(pathErr->getNbPoints(), 0);
+
+    // Truncated file
+    pathEmpty->addTimedPoint(initPoint, 0);
+    pathEmpty->addTimedPoint(lastPoint, 1);
+    pathEmpty->save(TRAJECTORY_FILE);
+
+    std::ifstream saved(TRAJECTORY_FILE, std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(saved)), std::istreambuf_iterator<char>());
+    saved.close();
+
+    std::ofstream truncated(TRAJECTORY_FILE, std::ios::binary | std::ios::trunc);
+    truncated.write(content.data(), content.size() - 1);
+    truncated.close();
+    ASSERT_THROW(pathEmpty->load(TRAJECTORY_FILE), armlearn::FileError);
+    ASSERT_FALSE(pathEmpty->isTimed());
+}
+
+// Tests that a blended point is passed without stopping, within its tolerance and the limits of the servomotors
+TEST_F(TrajectoryTest, blendedPath) {
+    std::vector<uint16_t> corner = {3000, 2000, 2048};
+    pathEmpty->addPoint({1000, 2000, 2048});
+    pathEmpty->addPoint(corner);
+    pathEmpty->addPoint({3000, 3000, 2048});
+
+    std::vector<double> speeds = {1000, 1000, 1000}, accelerations = {2000, 2000, 2000};
+    for(auto profile : {armlearn::trapezoidalProfile, armlearn::sCurveProfile}){
+        pathEmpty->setBlendTolerance(0);
+        pathEmpty->setTimeLimits(speeds, accelerations, profile);
+        double stopped = pathEmpty->getDuration();
+
+        pathEmpty->setBlendTolerance(1, 20);
+        ASSERT_EQ(pathEmpty->getBlendTolerance(1), 20);
+        ASSERT_LT(pathEmpty->getDuration(), stopped);
+
+        double step = 1e-3, closest = 1e9;
+        std::vector<double> previous, current, next;
+        for(double time = step; time < pathEmpty->getDuration() - step; time += step){
+            pathEmpty->sample(time - step, previous);
+            pathEmpty->sample(time, current);
+            pathEmpty->sample(time + step, next);
+
+            double distance = 0;
+            for(int i = 0; i < 3; i++){
+                ASSERT_LE(std::abs(next[i] - previous[i]) / (2 * step), speeds[i] * (1 + 1e-6));
+                ASSERT_LE(std::abs(next[i] - 2 * current[i] + previous[i]) / (step * step), accelerations[i] * (1 + 1e-2));
+                distance = std::max(distance, std::abs(current[i] - corner[i]));
+            }
+            closest = std::min(closest, distance);
+        }
+        ASSERT_LE(closest, 20 + 1);
+        ASSERT_GT(closest, 1); // Corner rounded
+
+        // Device at rest at both ends
+        pathEmpty->sample(0, current);
+        ASSERT_EQ(current, std::vector<double>({1000, 2000, 2048}));
+        pathEmpty->sample(pathEmpty->getDuration(), current);
+        ASSERT_EQ(current, std::vector<double>({3000, 3000, 2048}));
+    }
+
+    // Tolerances kept with the points
+    pathEmpty->addPoint({2000, 2000, 2048}, 1);
+    ASSERT_EQ(pathEmpty->getBlendTolerance(1), 0);
+    ASSERT_EQ(pathEmpty->getBlendTolerance(2), 20);
+    pathEmpty->save(TRAJECTORY_FILE);
+
+    armlearn::Trajectory loaded(sim, TRAJECTORY_FILE);
+    ASSERT_EQ(loaded.getBlendTolerance(2), 20);
+    ASSERT_NEAR(loaded.getDuration(), pathEmpty->getDuration(), 1e-9);
+
+    ASSERT_THROW(pathEmpty->setBlendTolerance(1, -1), armlearn::TrajectoryError);
+    ASSERT_THROW(pathEmpty->setBlendTolerance(4, 1), std::out_of_range);
+    ASSERT_THROW(pathEmpty->getBlendTolerance(-1), std::out_of_range);
+}
 
+// Tests that dense points close to a line are passed at the speed of the line, each of them within its tolerance
+TEST_F(TrajectoryTest, blendedDensePath) {
+    for(int p = 0; p <= 200; p++) pathEmpty->addPoint({(uint16_t) std::round(1000 + 7.3 * p), (uint16_t) std::round(2000 + 3.1 * p), (uint16_t) std::round(2048 - 1.7 * p)});
+    pathEmpty->setTimeLimits({1000, 1000, 1000}, {2000, 2000, 2000});
+    double stopped = pathEmpty->getDuration();
 
+    pathEmpty->setBlendTolerance(3);
+
+    armlearn::Trajectory line(sim); // Single segment through the whole line
+    line.addPoint(std::vector<uint16_t>(pathEmpty->getPoint(0), pathEmpty->getPoint(0) + 3));
+    line.addPoint(std::vector<uint16_t>(pathEmpty->getPoint(200), pathEmpty->getPoint(200) + 3));
+    line.setTimeLimits({1000, 1000, 1000}, {2000, 2000, 2000});
+
+    ASSERT_LT(pathEmpty->getDuration(), stopped / 10);
+    ASSERT_LT(pathEmpty->getDuration(), line.getDuration() * 1.1);
+
+    double step = 1e-4;
+    std::vector<std::vector<double>> setpoints;
+    for(double time = 0; time <= pathEmpty->getDuration(); time += step){
+        setpoints.emplace_back();
+        pathEmpty->sample(time, setpoints.back());
+    }
+
+    for(int p = 0; p <= 200; p++){
+        const uint16_t* point = pathEmpty->getPoint(p);
+        double closest = 1e9;
+        for(auto& setpoint : setpoints) closest = std::min(closest, std::max({std::abs(setpoint[0] - point[0]), std::abs(setpoint[1] - point[1]), std::abs(setpoint[2] - point[2])}));
+
+        ASSERT_LE(closest, 3 + 0.1);
+    }
+
+    // Stopping at every point again
+    pathEmpty->setBlendTolerance(0);
+    ASSERT_NEAR(pathEmpty->getDuration(), stopped, 1e-9);
+}
+
+// Tests that tolerances set point by point are planned once, with the same timing as a tolerance set for every point
+TEST_F(TrajectoryTest, blendedPointTolerances) {
+    armlearn::Trajectory global(sim);
+    for(int p = 0; p < 5000; p++){
+        std::vector<uint16_t> point = {(uint16_t) std::round(2048 + 1000 * std::cos(0.01 * p)), (uint16_t) std::round(2048 + 1000 * std::sin(0.01 * p)), 2048};
+        pathEmpty->addPoint(point);
+        global.addPoint(point);
+    }
+    pathEmpty->setTimeLimits({1000, 1000, 1000}, {2000, 2000, 2000});
+    global.setTimeLimits({1000, 1000, 1000}, {2000, 2000, 2000});
+
+    for(int p = 0; p < 5000; p++) pathEmpty->setBlendTolerance(p, 5);
+    global.setBlendTolerance(5);
+    ASSERT_NEAR(pathEmpty->getDuration(), global.getDuration(), 1e-9);
+
+    pathEmpty->removePoint(2500);
+    global.removePoint(2500);
+    ASSERT_NEAR(pathEmpty->getDuration(), global.getDuration(), 1e-9);
+}
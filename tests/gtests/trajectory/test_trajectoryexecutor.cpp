@@ -0,0 +1,133 @@
+/**
+ * @file test_trajectoryexecutor.cpp
+ * @author Gaël Gendron (gael.gendron@insa-rennes.fr)
+ * @brief Testing file of TrajectoryExecutor class
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <algorithm>
+
+#include "trajectoryexecutor.h"
+#include "nowaitarmsimulator.h"
+
+
+/**
+ * @brief Simulator recording the speeds it receives, one of its servomotors being possibly stuck
+ *
+ */
+class MonitoredArmSimulator : public armlearn::communication::NoWaitArmSimulator {
+    public:
+
+    MonitoredArmSimulator():NoWaitArmSimulator(armlearn::communication::except), stuckId(0), maxSpeed(0){
+    }
+
+    using AbstractController::setPosition;
+    bool setPosition(uint8_t id, uint16_t newPosition) override {
+        if(id == stuckId) return true;
+
+        return NoWaitArmSimulator::setPosition(id, newPosition);
+    }
+
+    using AbstractController::changeSpeed;
+    bool changeSpeed(uint8_t id, uint16_t newSpeed) override {
+        maxSpeed = std::max(maxSpeed, newSpeed);
+
+        return NoWaitArmSimulator::changeSpeed(id, newSpeed);
+    }
+
+    uint8_t stuckId;
+    uint16_t maxSpeed;
+};
+
+
+class TrajectoryExecutorTest : public ::testing::Test {
+    protected:
+
+    TrajectoryExecutorTest():path(&sim), executor(&sim) {
+        sim.addMotor(1, "base", armlearn::communication::base);
+        sim.addMotor(2, "shoulder", armlearn::communication::shoulder);
+        sim.addMotor(3, "elbow", armlearn::communication::elbow);
+
+        lastPoint = {1800, 2400, 1900};
+        path.addPoint({2048, 2048, 2048});
+        path.addPoint({2500, 1800, 2300});
+        path.addPoint(lastPoint);
+        path.setTimeLimits({4000, 4000, 4000}, {20000, 20000, 20000});
+
+        sim.changeSpeed(100);
+        executor.setRate(200);
+    }
+
+    ~TrajectoryExecutorTest() override {
+    }
+
+    void SetUp() override {
+    }
+
+    void TearDown() override {
+    }
+
+    MonitoredArmSimulator sim;
+    armlearn::Trajectory path;
+    armlearn::TrajectoryExecutor executor;
+
+    std::vector<uint16_t> lastPoint;
+};
+
+
+// Tests that the setpoints are streamed at the rate of the executor until the last point
+TEST_F(TrajectoryExecutorTest, execute) {
+    path.init();
+    uint16_t speed = sim.showServomotor(1)->getTargetSpeed();
+
+    auto summary = executor.execute(path);
+
+    ASSERT_EQ(sim.getPosition(), lastPoint);
+    ASSERT_EQ(summary.nbSetpoints, (uint64_t) std::ceil(path.getDuration() * 200));
+    ASSERT_LE(summary.maxDeviation, 0.5); // Rounding of the setpoints
+    ASSERT_GE(summary.duration, path.getDuration());
+
+    // Speeds following the profile, then restored
+    ASSERT_GT(sim.maxSpeed, 100);
+    ASSERT_LE(sim.maxSpeed, std::ceil(4000 / EXECUTOR_SPEED_SCALE));
+    ASSERT_EQ(sim.showServomotor(1)->getTargetSpeed(), speed);
+
+    executor.execute(path, true);
+    ASSERT_EQ(sim.getPosition(), std::vector<uint16_t>({2048, 2048, 2048}));
+}
+
+// Tests that the execution is aborted when the device does not follow the setpoints
+TEST_F(TrajectoryExecutorTest, exceptDeviation) {
+    path.init();
+    sim.stuckId = 2;
+    uint16_t speed = sim.showServomotor(1)->getTargetSpeed();
+
+    executor.setMaxDeviation(50);
+    ASSERT_THROW(executor.execute(path), armlearn::TrajectoryError);
+    ASSERT_EQ(sim.showServomotor(1)->getTargetSpeed(), speed);
+    ASSERT_NE(sim.getPosition(), lastPoint);
+
+    // Device away from the first point
+    sim.stuckId = 0;
+    ASSERT_THROW(executor.execute(path), armlearn::TrajectoryError);
+}
+
+// Tests exception throw on invalid settings or trajectories
+TEST_F(TrajectoryExecutorTest, exceptSettings) {
+    ASSERT_THROW(executor.setRate(0), armlearn::TrajectoryError);
+    ASSERT_THROW(executor.setMaxDeviation(-1), armlearn::TrajectoryError);
+
+    armlearn::Trajectory untimed(&sim);
+    untimed.addPoint({2048, 2048, 2048});
+    ASSERT_THROW(executor.execute(untimed), armlearn::TrajectoryError);
+
+    armlearn::Trajectory smaller(&sim);
+    smaller.addPoint({2048, 2048});
+    smaller.setTimeLimits({4000, 4000}, {20000, 20000});
+    ASSERT_THROW(executor.execute(smaller), armlearn::TrajectoryError);
+}